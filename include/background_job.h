@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#else
+#include <thread>
+#endif
+
+// ===== One-shot background job =====
+// Runs a function in its own task while the caller carries on, and lets
+// the caller wait for it later:
+//
+//   job.start("panel", preparePanel, &prep);
+//   connectWiFi();          // overlaps with preparePanel
+//   job.join();             // before touching what preparePanel owns
+//
+// On the device this is a FreeRTOS task at the caller's priority; the C6
+// has one core, so the overlap comes from the caller blocking on the
+// radio. Off-target builds use std::thread, so the same boot sequence can
+// be timed on a host with stand-ins for the radio and the panel.
+class BackgroundJob {
+public:
+  typedef void (*Fn)(void* arg);
+
+  // Falls back to running fn inline (and returns false) if no task can be created
+  bool start(const char* name, Fn fn, void* arg, uint32_t stackBytes = 6144);
+  void join();                                  // no-op when not started or already joined
+  uint32_t runMs() const { return _runMs; }     // time fn itself took
+
+private:
+  static void run(void* self);
+
+  Fn _fn = nullptr;
+  void* _arg = nullptr;
+  bool _started = false;
+  volatile uint32_t _runMs = 0;
+#ifdef ARDUINO
+  SemaphoreHandle_t _done = nullptr;
+  StaticSemaphore_t _doneBuf;
+#else
+  std::thread _thread;
+#endif
+};
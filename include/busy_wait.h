@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+
+// ===== Interrupt-driven BUSY wait =====
+// GxEPD2 polls the panel's BUSY line for the whole refresh, seconds for a
+// full one, with the CPU spinning on delay(1). Registered as its busy
+// callback, this sleeps until the line drops instead:
+//
+//   busyWaitBegin(PIN_BUSY, HIGH);          // from the task that refreshes
+//   epd.setBusyCallback(busyWaitCallback);
+//
+// That task light-sleeps with a GPIO wakeup on BUSY while the radio is
+// off. Light sleep would stop WiFi and every other task with it, so with
+// the radio on, or from another task (the boot-time panel job), the task
+// blocks on a BUSY edge interrupt instead and leaves the CPU to the rest.
+// Either wait ends after BUSY_WAIT_GUARD_MS at the latest; GxEPD2 then
+// checks the line and its own busy timeout, and calls back again if the
+// panel is still busy.
+//
+// No Arduino here: the line and the chip sit behind BusyLine, so the
+// choice between the two waits and their accounting can be driven by a
+// simulated panel on the host.
+
+static const uint32_t BUSY_WAIT_GUARD_MS = 1000;
+
+class BusyLine {
+public:
+  virtual ~BusyLine() {}
+  // The calling task is the one busyWaitBegin() ran on
+  virtual bool ownerTask() = 0;
+  virtual bool radioOff() = 0;
+  // Both return when BUSY drops or after guardMs: the first with the whole
+  // chip stopped, the second with this task blocked and the CPU free
+  virtual void lightSleep(uint32_t guardMs) = 0;
+  virtual void block(uint32_t guardMs) = 0;
+  virtual uint32_t millis() = 0;
+};
+
+// One busy callback's worth of waiting on `line`
+void busyWaitOn(BusyLine& line);
+
+// `busyLevel`: level of the line while the controller works
+void busyWaitBegin(int pin, int busyLevel);
+void busyWaitCallback(const void* = nullptr);
+
+// Time spent in busyWaitOn() since boot: in light sleep, with the chip
+// stopped, and blocked on the edge interrupt, with the CPU free for other
+// tasks (WiFi, the DNS refresh), so still drawing active current. Either
+// task may be waiting; the counters are atomic.
+uint32_t busyWaitSleptMs();
+uint32_t busyWaitBlockedMs();
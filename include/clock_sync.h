@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Arduino.h>
+#include <time.h>
+
+// ===== Wall clock across deep sleep =====
+// The system clock runs on the RTC timer through deep sleep, so a warm
+// wake already knows the time, give or take the RC oscillator's drift.
+// That drift is trimmed from the Date header of the OpenWeather responses
+// fetched anyway; blocking NTP is left for cold boots, a clock nobody has
+// checked in days, or a Date header disagreeing by more than a plausible
+// drift.
+
+bool clockNeedsNtp();
+
+// Clock was set by NTP just now
+void clockNtpSynced();
+
+// Compare with a server's idea of now (HttpSession::serverTime()); steps
+// the clock when it is off by more than a couple of seconds. Returns the
+// measured offset in seconds (server - local), 0 when nothing was known.
+int32_t clockCorrect(time_t serverNow);
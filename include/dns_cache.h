@@ -0,0 +1,33 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ===== DNS cache across deep sleep =====
+// A few A records in RTC memory, each kept for the TTL the resolver gave
+// it, so a warm wake can open its sockets without waiting for DNS. Misses
+// are looked up with our own UDP query to the resolver of the DHCP lease
+// (lwIP's resolver does not report TTLs). Addresses are only served while
+// their TTL lasts.
+//
+//   IPAddress ip;
+//   bool cached;
+//   if (dnsResolve(host, ip, &cached) && !connect(ip) && cached) {
+//     dnsForget(host);                       // moved? look it up again
+//     if (dnsResolve(host, ip)) connect(ip);
+//   }
+//
+// Not thread-safe: one caller at a time (a background dnsRefresh() is
+// joined before anything else resolves).
+
+static const int DNS_CACHE_SIZE = 4;
+static const size_t DNS_MAX_HOST = 48;   // longer names are resolved but not cached
+
+// Cached address while its TTL lasts, else a fresh lookup (then cached).
+// An IP literal is returned as is. False when the lookup fails.
+bool dnsResolve(const char* host, IPAddress& ip, bool* fromCache = nullptr);
+// Drop `host`, e.g. after a failed connect to its cached address
+void dnsForget(const char* host);
+// Look up again every entry that expires within `horizonSec`, so the next
+// wake still finds it valid; meant to run after the fetch. Entries whose
+// TTL is shorter than `horizonSec` are skipped: no lookup could cover it.
+void dnsRefresh(uint32_t horizonSec);
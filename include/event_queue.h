@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+
+// ===== Timer queue for the always-on mode =====
+// A handful of jobs due at a millisecond time, once or repeating. The
+// caller owns the clock: loop() passes millis() and idles for
+// nextDueIn(), so the same queue runs against a simulated clock off the
+// device. Times wrap with millis() (differences are taken as signed).
+//
+// Pure logic (no Arduino), like frame_diff.
+class EventQueue {
+public:
+  typedef void (*Job)(void* ctx);
+
+  static const int MAX_TIMERS = 8;
+  static const uint32_t NEVER = UINT32_MAX;
+
+  // Handle for reschedule()/cancel(), or -1 when all timers are taken.
+  // `periodMs` 0 runs the job once.
+  int schedule(uint32_t nowMs, uint32_t delayMs, Job job, void* ctx = nullptr, uint32_t periodMs = 0);
+  void reschedule(int id, uint32_t nowMs, uint32_t delayMs);
+  void cancel(int id);
+
+  // Milliseconds until the earliest job is due: 0 when one already is,
+  // NEVER when nothing is scheduled
+  uint32_t nextDueIn(uint32_t nowMs) const;
+
+  // Runs the jobs due at `nowMs`, earliest first; each at most once per
+  // call, so a job rescheduling itself for "now" can't starve the loop.
+  // Repeating jobs keep their phase and skip periods they missed.
+  // Returns how many ran.
+  int runDue(uint32_t nowMs);
+
+private:
+  struct Timer {
+    Job job;
+    void* ctx;
+    uint32_t dueMs;
+    uint32_t periodMs;
+    bool active;
+  };
+
+  Timer _timers[MAX_TIMERS] = {};
+};
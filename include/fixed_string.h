@@ -0,0 +1,74 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// ===== Fixed-capacity strings =====
+// Text on the fetch/render path (URLs, request headers, record fields,
+// formatted temperatures) lives in buffers sized at compile time instead
+// of Arduino String, so a wake does not fragment the heap. Appends that
+// don't fit are cut at capacity and flagged, never reallocated.
+//
+// StrBuf does the work on caller-owned storage; FixedString<N> brings the
+// storage along. Functions take StrBuf& so they work with any capacity.
+class StrBuf {
+public:
+  StrBuf(const StrBuf&) = delete;
+  StrBuf& operator=(const StrBuf&) = delete;
+
+  const char* c_str() const { return _buf; }
+  size_t length() const { return _len; }
+  size_t capacity() const { return _cap - 1; }
+  bool empty() const { return _len == 0; }
+  bool overflowed() const { return _overflow; }
+
+  void clear();
+  StrBuf& append(const char* s);
+  StrBuf& append(const char* s, size_t n);
+  StrBuf& append(char c);
+  StrBuf& appendInt(long v);
+  // Fixed point without printf: newlib's float formatting mallocs
+  StrBuf& appendFixed(float v, uint8_t decimals);
+  // printf-style; keep to integer and string conversions (see above)
+  StrBuf& appendf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+  // RFC 3986: unreserved characters as is, every other byte as %XX
+  StrBuf& appendUrlEncoded(const char* s);
+
+  StrBuf& operator=(const char* s) { clear(); return append(s); }
+  StrBuf& operator+=(const char* s) { return append(s); }
+  StrBuf& operator+=(char c) { return append(c); }
+  bool operator==(const char* s) const { return strcmp(_buf, s ? s : "") == 0; }
+  bool operator!=(const char* s) const { return !(*this == s); }
+  bool startsWith(const char* prefix) const { return strncmp(_buf, prefix, strlen(prefix)) == 0; }
+
+  // Strips leading/trailing whitespace in place
+  void trim();
+
+protected:
+  StrBuf(char* buf, size_t cap) : _buf(buf), _cap(cap) { _buf[0] = '\0'; }
+
+private:
+  char* _buf;
+  size_t _cap;          // bytes including the terminator
+  size_t _len = 0;
+  bool _overflow = false;
+};
+
+template <size_t N>
+class FixedString : public StrBuf {
+  static_assert(N >= 2, "FixedString needs room for at least one character");
+
+public:
+  FixedString() : StrBuf(_storage, N) {}
+  FixedString(const char* s) : StrBuf(_storage, N) { append(s); }
+  FixedString(const FixedString& o) : StrBuf(_storage, N) { append(o.c_str()); }
+  FixedString& operator=(const FixedString& o) {
+    if (this != &o) { clear(); append(o.c_str()); }
+    return *this;
+  }
+  FixedString& operator=(const char* s) { clear(); append(s); return *this; }
+
+private:
+  char _storage[N];
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ===== FNV-1a (32-bit) =====
+// Fingerprints kept next to RTC state (city query, TLS host, session
+// secret), so a wake notices when what it saved no longer matches.
+// Cheap and good enough to spot a change; not a cryptographic hash.
+inline uint32_t fnv1a(const uint8_t* p, size_t len) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    h ^= p[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+// Same hash over a C string, without the terminator
+inline uint32_t fnv1a(const char* s) {
+  uint32_t h = 2166136261u;
+  for (; *s; s++) {
+    h ^= (uint8_t)*s;
+    h *= 16777619u;
+  }
+  return h;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+// ===== Dirty-rectangle diff between two 1bpp frames =====
+// Frames are packed MSB-first, (width + 7) / 8 bytes per row, in native
+// panel orientation. Rectangles are in native pixels with x/w on byte
+// boundaries (the controller can only address RAM in whole bytes along x);
+// a rectangle touching the last byte of a row ends at the padded row
+// width, (width + 7) / 8 * 8, not at `width`.
+struct DirtyRect {
+  int16_t x;
+  int16_t y;
+  int16_t w;
+  int16_t h;
+};
+
+// Rows with no change between two dirty rows are folded into the same
+// rectangle while the gap stays at or below this many rows.
+static const int16_t FRAME_DIFF_ROW_GAP = 8;
+
+// Fills `out` with at most `maxRects` rectangles covering every changed
+// pixel and returns how many were written (0 = frames are identical).
+// When more bands are found than fit, the pair whose union adds the least
+// untouched area is merged until they do.
+int computeDirtyRects(const uint8_t* prev, const uint8_t* next,
+                      int16_t width, int16_t height,
+                      DirtyRect* out, int maxRects);
+
+uint32_t dirtyArea(const DirtyRect* rects, int count);
+DirtyRect dirtyBounds(const DirtyRect* rects, int count);
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Adafruit_GFX.h>
+
+// ===== 1bpp frame for the 2.13" BN panel =====
+// Same memory layout GxEPD2 sends to the controller: native orientation
+// (122 x 250), MSB-first, bit set = white. Drawing goes through the usual
+// Adafruit GFX API with rotation applied, and the raw bytes can be diffed
+// against the previous frame and pushed to the panel directly.
+static const int16_t FRAME_WIDTH  = 122;
+static const int16_t FRAME_HEIGHT = 250;
+static const int16_t FRAME_STRIDE = (FRAME_WIDTH + 7) / 8;
+static const uint32_t FRAME_BYTES = (uint32_t)FRAME_STRIDE * FRAME_HEIGHT;
+
+// 1bpp ink mask pre-rotated for setRotation(1) (see icon_sprites.h): one
+// row per landscape column, bits along native x, MSB first, set = ink.
+struct Sprite {
+  int8_t ox, oy;          // top-left of the ink box relative to the draw origin
+  uint8_t w, h;           // ink box size in landscape pixels
+  uint8_t stride;         // bytes per row, (h + 7) / 8
+  const uint8_t* bits;    // w rows
+};
+
+// Glyphs of one GFX font as sprites, with the font's metrics (ox/oy are
+// the glyph offsets from the cursor on the baseline). Generated at build
+// time by tools/gen_glyph_atlas.py into glyph_atlas.h.
+struct AtlasGlyph {
+  Sprite sprite;
+  uint8_t xAdvance;       // 0: character not in the atlas
+};
+
+struct GlyphAtlas {
+  uint8_t first;          // code points covered: [first, last]
+  uint8_t last;
+  const AtlasGlyph* glyphs;
+};
+
+class FrameBuffer : public Adafruit_GFX {
+public:
+  FrameBuffer() : Adafruit_GFX(FRAME_WIDTH, FRAME_HEIGHT) {}
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  void fillScreen(uint16_t color) override;
+
+  // Rectangles and straight lines are mapped to native rows once and
+  // filled as spans (32 bits per store), instead of pixel by pixel.
+  // fillCircle, fillTriangle and fillRoundRect land here too.
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+
+  // Stamps the sprite's ink pixels in `color`, leaves the rest untouched
+  void drawSprite(const Sprite& s, int16_t x, int16_t y, uint16_t color);
+
+  // Text in a font with an atlas is blitted glyph by glyph instead of
+  // rasterized bit by bit; anything the atlas lacks (or scaled text) goes
+  // through Adafruit GFX as before. Same pixels either way.
+  static const int MAX_ATLASES = 4;
+  void addGlyphAtlas(const GFXfont* font, const GlyphAtlas* atlas);
+  using Adafruit_GFX::write;
+  size_t write(uint8_t c) override;
+  // getTextBounds() from the atlas metrics when it covers all of `s`
+  void measureText(const char* s, int16_t x, int16_t y,
+                   int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h);
+
+  uint8_t* getBuffer() { return _buffer; }
+  const uint8_t* getBuffer() const { return _buffer; }
+
+private:
+  void fillNative(int16_t x, int16_t y, int16_t w, int16_t h, bool white);
+  const AtlasGlyph* atlasGlyph(uint8_t c);
+
+  const GFXfont* _atlasFonts[MAX_ATLASES] = {};
+  const GlyphAtlas* _atlases[MAX_ATLASES] = {};
+  int _atlasCount = 0;
+
+  alignas(4) uint8_t _buffer[FRAME_BYTES];
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ===== Streaming gzip decoder =====
+// Inflates a gzip body (RFC 1952) as it is read, so a parser can take the
+// decompressed JSON from it like from any Stream. Uses the tinfl inflater
+// in the chip's ROM; its 32 KB history window (the largest back-reference
+// deflate allows) and decompressor state are allocated once, on the first
+// reserve(), and kept.
+//
+//   if (gz.reserve()) ... advertise "Accept-Encoding: gzip" ...
+//   gz.begin(&body);
+//   deserializeJson(doc, gz);
+class GzipStream : public Stream {
+public:
+  ~GzipStream();
+
+  bool reserve();                 // false when the buffers can't be allocated
+  void begin(Stream* in);         // after reserve(); reads the gzip header lazily
+
+  bool finished() const { return _done; }
+  bool complete() const { return _complete; }   // trailer read, CRC and size matched
+  uint32_t produced() const { return _produced; }
+  uint32_t inflateMs() const { return _inflateUs / 1000; }  // time inside the inflater
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t) override { return 0; }
+
+private:
+  int nextIn();
+  bool readHeader();
+  bool readTrailer();
+  bool inflateMore();
+  void fail(const char* why);
+
+  Stream* _in = nullptr;
+  void* _decomp = nullptr;        // tinfl_decompressor
+  uint8_t* _window = nullptr;     // TINFL_LZ_DICT_SIZE, circular
+  uint8_t _inBuf[256];
+  size_t _inPos = 0;
+  size_t _inLen = 0;
+  bool _inEnd = true;
+
+  size_t _windowPos = 0;          // where the inflater writes next
+  size_t _outPos = 0;             // unread output: [_outPos, _outEnd) of the window
+  size_t _outEnd = 0;
+  bool _headerRead = false;
+  bool _done = true;
+  bool _complete = false;
+  uint32_t _crc = 0;
+  uint32_t _produced = 0;
+  uint32_t _inflateUs = 0;
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <Arduino.h>
+#include <time.h>
+
+#include "fixed_string.h"
+#include "gzip_stream.h"
+#include "tls_client.h"
+
+// ===== Keep-alive HTTPS session =====
+// One TLS connection to a single host, reused for every request of a wake.
+// Requests are written as soon as they are queued (HTTP/1.1 pipelining),
+// responses are read back in the same order:
+//
+//   HttpSession ow(OW_HOST);
+//   ow.send(pathA); ow.send(pathB);        // one handshake, both GETs out
+//   if (ow.receive() == 200) parse(ow.body());
+//   if (ow.receive() == 200) parse(ow.body());
+//
+// If the server drops the connection before answering everything, the
+// unanswered requests are re-sent once on a fresh connection.
+//
+// Requests ask for gzip; a gzip response is inflated on the fly, so body()
+// yields the plain JSON either way. skipBody() reads a gzip body to its
+// trailer and reports whether it checked out.
+//
+// The connection is verified TLS (see TlsClient); its session is kept
+// across wakes, so usually only the first wake pays a full handshake.
+
+// Longest request path (with query) and extra header block kept per request
+static const size_t HTTP_MAX_PATH = 320;
+static const size_t HTTP_MAX_HEADERS = 160;
+
+// Per-request latency, logged after each response body is consumed
+struct HttpStats {
+  uint32_t connectMs = 0;   // TLS handshake paid by this request (0 if reused)
+  uint32_t ttfbMs = 0;      // request written -> response headers parsed
+  uint32_t bodyMs = 0;      // headers parsed -> body fully consumed
+  uint32_t waitMs = 0;      // part of bodyMs spent waiting for bytes to arrive
+  uint32_t bodyBytes = 0;   // as received: compressed when gzip
+  uint32_t plainBytes = 0;  // after inflating (= bodyBytes when not compressed)
+  uint32_t inflateMs = 0;   // part of bodyMs spent in the inflater
+};
+
+// Body of the current response, bounded by Content-Length or de-chunked,
+// so parsers can read it like any Arduino Stream and stop at its end.
+class HttpBodyStream : public Stream {
+public:
+  void begin(Client* in, int32_t length, bool chunked, uint32_t timeoutMs);
+  bool finished() const { return _done; }
+  bool complete() const { return _complete; }   // ended on its framing, not on an error
+  uint32_t consumed() const { return _consumed; }
+  uint32_t waitMs() const { return _waitMs; }
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  size_t write(uint8_t) override { return 0; }
+
+private:
+  int readRaw();
+  bool nextChunk();
+
+  Client* _in = nullptr;
+  int32_t _remaining = 0;   // bytes left in body / current chunk, -1 = until close
+  bool _chunked = false;
+  bool _chunkOpen = false;  // a chunk's data was read, its CRLF is still due
+  bool _done = true;
+  bool _complete = true;
+  int _peeked = -1;
+  uint32_t _consumed = 0;
+  uint32_t _waitMs = 0;
+  uint32_t _timeoutMs = 5000;
+};
+
+class HttpSession {
+public:
+  static const int MAX_PENDING = 4;
+
+  explicit HttpSession(const char* host, uint16_t port = 443);
+  ~HttpSession() { close(); }
+
+  // Queue + write a GET; `headers` are extra "Name: value\r\n" lines.
+  // Both are copied, so callers may pass stack buffers.
+  bool send(const char* path, const char* headers = "");
+  int receive();                     // HTTP status of the oldest pending request, <0 on error
+  Stream& body();                    // body of the response returned by receive()
+  // Drains what the parser left so the next response lines up. False if
+  // the body didn't arrive whole: cut short, or a gzip body whose CRC or
+  // length doesn't match; the caller must not keep what it parsed.
+  bool skipBody();
+  void close();
+
+  const HttpStats& lastStats() const { return _stats; }
+  const HttpStats& totals() const { return _totals; }   // summed over every response so far
+  void resetTotals() { _totals = HttpStats(); }
+
+  // Cache validators of the last response ("" when absent)
+  const char* etag() const { return _etag; }
+  const char* lastModified() const { return _lastModified; }
+
+  // Server clock from the newest Date header, advanced by the time since
+  // it was read (UTC, 1 s resolution); 0 when no response carried one
+  time_t serverTime() const;
+
+private:
+  bool connect();
+  bool writeRequest(const char* path, const char* headers);
+  bool resendPending();
+  void popPending();
+  bool readLine(char* buf, size_t len);
+  int readHeaders();
+  bool finishResponse();
+
+  const char* _host;
+  uint16_t _port;
+  TlsClient _client;
+  HttpBodyStream _body;
+  GzipStream _gzip;
+  bool _gzipBody = false;   // current response is Content-Encoding: gzip
+
+  FixedString<HTTP_MAX_PATH> _pending[MAX_PENDING];
+  FixedString<HTTP_MAX_HEADERS> _pendingHeaders[MAX_PENDING];
+  uint32_t _sentAt[MAX_PENDING];
+  int _pendingCount = 0;
+  FixedString<HTTP_MAX_PATH> _current;   // request whose response is being read
+
+  bool _reusable = true;    // false after "Connection: close" / body without length
+  bool _inBody = false;
+  uint32_t _handshakeMs = 0;
+  uint32_t _headersAt = 0;
+  HttpStats _stats;
+  HttpStats _totals;
+  char _etag[64] = "";
+  char _lastModified[40] = "";
+  time_t _date = 0;
+  uint32_t _dateAt = 0;
+};
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "framebuffer.h"
+
+// ===== Weather icons, rasterized at compile time =====
+// The shapes below are the primitives drawWeatherIcon() used to draw at
+// runtime, run through constexpr ports of Adafruit GFX's rasterizers
+// (midpoint circles, Bresenham lines, scanline triangles), so the baked
+// sprites are pixel-identical to the old output. Runtime cost is one
+// shifted byte copy per sprite byte (FrameBuffer::drawSprite).
+//
+// Sprites are stored pre-rotated for setRotation(1): one row per
+// landscape column, bits along the panel's native x (MSB first).
+// The icons are drawn at the same size in the detailed and split views,
+// so one sprite per shape covers both.
+
+namespace icon_gen {
+
+// Landscape scratch canvas, with a margin for shapes that poke out of
+// their origin (the cloud's middle puff starts at y - 2)
+static constexpr int CW = 80;
+static constexpr int CH = 80;
+static constexpr int CX = 4;
+static constexpr int CY = 4;
+
+struct Canvas {
+  bool px[CH][CW] = {};
+
+  constexpr void pixel(int x, int y) {
+    x += CX;
+    y += CY;
+    if (x >= 0 && y >= 0 && x < CW && y < CH) px[y][x] = true;
+  }
+  constexpr void hline(int x, int y, int w) {
+    for (int i = 0; i < w; i++) pixel(x + i, y);
+  }
+  constexpr void vline(int x, int y, int h) {
+    for (int i = 0; i < h; i++) pixel(x, y + i);
+  }
+
+  // Adafruit_GFX::writeLine
+  constexpr void line(int x0, int y0, int x1, int y1) {
+    bool steep = (y1 > y0 ? y1 - y0 : y0 - y1) > (x1 > x0 ? x1 - x0 : x0 - x1);
+    if (steep) { int t = x0; x0 = y0; y0 = t; t = x1; x1 = y1; y1 = t; }
+    if (x0 > x1) { int t = x0; x0 = x1; x1 = t; t = y0; y0 = y1; y1 = t; }
+    int dx = x1 - x0;
+    int dy = y1 > y0 ? y1 - y0 : y0 - y1;
+    int err = dx / 2;
+    int ystep = (y0 < y1) ? 1 : -1;
+    for (; x0 <= x1; x0++) {
+      if (steep) pixel(y0, x0);
+      else       pixel(x0, y0);
+      err -= dy;
+      if (err < 0) { y0 += ystep; err += dx; }
+    }
+  }
+
+  // Adafruit_GFX::drawCircle
+  constexpr void circle(int x0, int y0, int r) {
+    int f = 1 - r, ddF_x = 1, ddF_y = -2 * r, x = 0, y = r;
+    pixel(x0, y0 + r);
+    pixel(x0, y0 - r);
+    pixel(x0 + r, y0);
+    pixel(x0 - r, y0);
+    while (x < y) {
+      if (f >= 0) { y--; ddF_y += 2; f += ddF_y; }
+      x++;
+      ddF_x += 2;
+      f += ddF_x;
+      pixel(x0 + x, y0 + y); pixel(x0 - x, y0 + y);
+      pixel(x0 + x, y0 - y); pixel(x0 - x, y0 - y);
+      pixel(x0 + y, y0 + x); pixel(x0 - y, y0 + x);
+      pixel(x0 + y, y0 - x); pixel(x0 - y, y0 - x);
+    }
+  }
+
+  // Adafruit_GFX::fillCircle + fillCircleHelper(corners = 3, delta = 0)
+  constexpr void fillCircle(int x0, int y0, int r) {
+    vline(x0, y0 - r, 2 * r + 1);
+    int f = 1 - r, ddF_x = 1, ddF_y = -2 * r, x = 0, y = r;
+    int px = x, py = y;
+    const int delta = 1;
+    while (x < y) {
+      if (f >= 0) { y--; ddF_y += 2; f += ddF_y; }
+      x++;
+      ddF_x += 2;
+      f += ddF_x;
+      if (x < (y + 1)) {
+        vline(x0 + x, y0 - y, 2 * y + delta);
+        vline(x0 - x, y0 - y, 2 * y + delta);
+      }
+      if (y != py) {
+        vline(x0 + py, y0 - px, 2 * px + delta);
+        vline(x0 - py, y0 - px, 2 * px + delta);
+        py = y;
+      }
+      px = x;
+    }
+  }
+
+  constexpr void fillRect(int x, int y, int w, int h) {
+    for (int j = 0; j < h; j++) hline(x, y + j, w);
+  }
+
+  // Adafruit_GFX::fillTriangle
+  constexpr void fillTriangle(int x0, int y0, int x1, int y1, int x2, int y2) {
+    int t = 0;
+    if (y0 > y1) { t = y0; y0 = y1; y1 = t; t = x0; x0 = x1; x1 = t; }
+    if (y1 > y2) { t = y2; y2 = y1; y1 = t; t = x2; x2 = x1; x1 = t; }
+    if (y0 > y1) { t = y0; y0 = y1; y1 = t; t = x0; x0 = x1; x1 = t; }
+
+    if (y0 == y2) {
+      int a = x0, b = x0;
+      if (x1 < a) a = x1; else if (x1 > b) b = x1;
+      if (x2 < a) a = x2; else if (x2 > b) b = x2;
+      hline(a, y0, b - a + 1);
+      return;
+    }
+
+    int dx01 = x1 - x0, dy01 = y1 - y0, dx02 = x2 - x0, dy02 = y2 - y0,
+        dx12 = x2 - x1, dy12 = y2 - y1;
+    int32_t sa = 0, sb = 0;
+    int last = (y1 == y2) ? y1 : y1 - 1;
+    int y = y0;
+    for (; y <= last; y++) {
+      int a = x0 + sa / dy01;
+      int b = x0 + sb / dy02;
+      sa += dx01;
+      sb += dx02;
+      if (a > b) { t = a; a = b; b = t; }
+      hline(a, y, b - a + 1);
+    }
+    sa = (int32_t)dx12 * (y - y1);
+    sb = (int32_t)dx02 * (y - y0);
+    for (; y <= y2; y++) {
+      int a = x1 + sa / dy12;
+      int b = x0 + sb / dy02;
+      sa += dx12;
+      sb += dx02;
+      if (a > b) { t = a; a = b; b = t; }
+      hline(a, y, b - a + 1);
+    }
+  }
+};
+
+// ---------------- Shapes (icon origin at 0,0) ----------------
+// Sun ray end points: (int)(cos/sin(a) * 16) and * 24 for a = 0, 30, .. 330
+// degrees, as the float math in the old drawSun() produced them.
+static constexpr int8_t SUN_RAYS[12][4] = {
+  {  16,   0,  24,   0 }, {  13,   8,  20,  12 }, {   7,  13,  11,  20 },
+  {   0,  16,   0,  24 }, {  -8,  13, -12,  20 }, { -13,   8, -20,  12 },
+  { -16,   0, -24,   0 }, { -13,  -7, -20, -11 }, {  -7, -13, -11, -20 },
+  {   0, -16,   0, -24 }, {   7, -13,  11, -20 }, {  13,  -8,  20, -12 },
+};
+
+constexpr void sun(Canvas& c, int cx, int cy) {
+  c.circle(cx, cy, 12);
+  for (int i = 0; i < 12; i++) {
+    c.line(cx + SUN_RAYS[i][0], cy + SUN_RAYS[i][1], cx + SUN_RAYS[i][2], cy + SUN_RAYS[i][3]);
+  }
+}
+
+constexpr void cloud(Canvas& c, int x, int y) {
+  c.fillCircle(x + 16, y + 18, 12);
+  c.fillCircle(x + 34, y + 14, 16);
+  c.fillCircle(x + 52, y + 18, 12);
+  c.fillRect  (x + 16, y + 18, 36, 18);
+}
+
+constexpr void rain(Canvas& c, int x, int y) {
+  cloud(c, x, y);
+  for (int i = 0; i < 3; i++) {
+    int rx = x + 22 + i * 14;
+    c.line(rx, y + 42, rx - 4, y + 54);
+  }
+}
+
+constexpr void storm(Canvas& c, int x, int y) {
+  cloud(c, x, y);
+  // lightning bolt
+  c.fillTriangle(x + 34, y + 36, x + 24, y + 56, x + 38, y + 56);
+  c.fillTriangle(x + 38, y + 56, x + 30, y + 72, x + 48, y + 52);
+}
+
+constexpr void snow(Canvas& c, int x, int y) {
+  cloud(c, x, y);
+  for (int i = 0; i < 3; i++) {
+    int sx = x + 22 + i * 14;
+    int sy = y + 48;
+    c.line(sx - 4, sy, sx + 4, sy);
+    c.line(sx, sy - 4, sx, sy + 4);
+    c.line(sx - 3, sy - 3, sx + 3, sy + 3);
+    c.line(sx - 3, sy + 3, sx + 3, sy - 3);
+  }
+}
+
+constexpr void mist(Canvas& c, int x, int y) {
+  // simple fog lines
+  c.line(x, y + 18, x + 70, y + 18);
+  c.line(x + 8, y + 30, x + 62, y + 30);
+  c.line(x, y + 42, x + 70, y + 42);
+}
+
+// ---------------- Baking ----------------
+struct Box {
+  int x0, y0, w, h;   // canvas coordinates (margin included)
+};
+
+template <typename Shape>
+constexpr Box inkBox(Shape shape) {
+  Canvas c{};
+  shape(c);
+  int minX = CW, minY = CH, maxX = -1, maxY = -1;
+  for (int y = 0; y < CH; y++) {
+    for (int x = 0; x < CW; x++) {
+      if (!c.px[y][x]) continue;
+      if (x < minX) minX = x;
+      if (x > maxX) maxX = x;
+      if (y < minY) minY = y;
+      if (y > maxY) maxY = y;
+    }
+  }
+  return Box{ minX, minY, maxX - minX + 1, maxY - minY + 1 };
+}
+
+template <int W, int H>
+struct Bits {
+  static constexpr int STRIDE = (H + 7) / 8;
+  uint8_t data[W * STRIDE];
+};
+
+// Landscape (x, y) -> sprite row x, bit (H - 1 - y): the rotation 1 mapping
+template <int W, int H, typename Shape>
+constexpr Bits<W, H> bake(Shape shape, Box b) {
+  Canvas c{};
+  shape(c);
+  Bits<W, H> out{};
+  for (int i = 0; i < W; i++) {
+    for (int j = 0; j < H; j++) {
+      if (!c.px[b.y0 + j][b.x0 + i]) continue;
+      int k = H - 1 - j;
+      out.data[i * Bits<W, H>::STRIDE + k / 8] |= (uint8_t)(0x80 >> (k % 8));
+    }
+  }
+  return out;
+}
+
+constexpr auto SHAPE_SUN   = [](Canvas& c) { sun(c, 36, 28); };
+constexpr auto SHAPE_CLOUD = [](Canvas& c) { cloud(c, 0, 0); };
+constexpr auto SHAPE_RAIN  = [](Canvas& c) { rain(c, 0, 0); };
+constexpr auto SHAPE_STORM = [](Canvas& c) { storm(c, 0, 0); };
+constexpr auto SHAPE_SNOW  = [](Canvas& c) { snow(c, 0, 0); };
+constexpr auto SHAPE_MIST  = [](Canvas& c) { mist(c, 0, 0); };
+
+constexpr Box BOX_SUN   = inkBox(SHAPE_SUN);
+constexpr Box BOX_CLOUD = inkBox(SHAPE_CLOUD);
+constexpr Box BOX_RAIN  = inkBox(SHAPE_RAIN);
+constexpr Box BOX_STORM = inkBox(SHAPE_STORM);
+constexpr Box BOX_SNOW  = inkBox(SHAPE_SNOW);
+constexpr Box BOX_MIST  = inkBox(SHAPE_MIST);
+
+constexpr auto BITS_SUN   = bake<BOX_SUN.w,   BOX_SUN.h>  (SHAPE_SUN,   BOX_SUN);
+constexpr auto BITS_CLOUD = bake<BOX_CLOUD.w, BOX_CLOUD.h>(SHAPE_CLOUD, BOX_CLOUD);
+constexpr auto BITS_RAIN  = bake<BOX_RAIN.w,  BOX_RAIN.h> (SHAPE_RAIN,  BOX_RAIN);
+constexpr auto BITS_STORM = bake<BOX_STORM.w, BOX_STORM.h>(SHAPE_STORM, BOX_STORM);
+constexpr auto BITS_SNOW  = bake<BOX_SNOW.w,  BOX_SNOW.h> (SHAPE_SNOW,  BOX_SNOW);
+constexpr auto BITS_MIST  = bake<BOX_MIST.w,  BOX_MIST.h> (SHAPE_MIST,  BOX_MIST);
+
+template <typename B>
+constexpr Sprite sprite(const Box& box, const B& bits) {
+  return Sprite{ (int8_t)(box.x0 - CX), (int8_t)(box.y0 - CY),
+                 (uint8_t)box.w, (uint8_t)box.h, (uint8_t)B::STRIDE, bits.data };
+}
+
+} // namespace icon_gen
+
+static constexpr Sprite SPRITE_SUN   = icon_gen::sprite(icon_gen::BOX_SUN,   icon_gen::BITS_SUN);
+static constexpr Sprite SPRITE_CLOUD = icon_gen::sprite(icon_gen::BOX_CLOUD, icon_gen::BITS_CLOUD);
+static constexpr Sprite SPRITE_RAIN  = icon_gen::sprite(icon_gen::BOX_RAIN,  icon_gen::BITS_RAIN);
+static constexpr Sprite SPRITE_STORM = icon_gen::sprite(icon_gen::BOX_STORM, icon_gen::BITS_STORM);
+static constexpr Sprite SPRITE_SNOW  = icon_gen::sprite(icon_gen::BOX_SNOW,  icon_gen::BITS_SNOW);
+static constexpr Sprite SPRITE_MIST  = icon_gen::sprite(icon_gen::BOX_MIST,  icon_gen::BITS_MIST);
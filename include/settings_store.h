@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ===== Settings blob =====
+// Every user setting in one struct, stored in NVS as a single versioned,
+// CRC-checked blob instead of a key per value, and mirrored in RTC memory
+// so a wake from deep sleep doesn't open NVS at all.
+//
+// Layout rule: new fields go at the end, with SETTINGS_VERSION bumped. An
+// older (shorter) blob then loads over the defaults, so the new fields
+// start from theirs.
+static const uint16_t SETTINGS_VERSION = 1;
+
+struct Settings {
+  char apiKey[65];
+  char city[65];              // e.g. "Beer Sheva,IL"
+  char cityIds[200];          // extra locations, OpenWeather city IDs
+  uint32_t intervalHours;     // longest sleep in stable weather
+  uint8_t nightStartHour;
+  uint8_t nightEndHour;
+  int16_t tzOffsetHours;
+  bool deepSleep;
+  uint8_t partialMax;         // partial refreshes before a full one
+  uint16_t weatherTtlMin;
+  uint16_t forecastTtlMin;
+  bool wifiStaticIp;
+  uint16_t minIntervalMin;    // shortest sleep in fast-changing weather
+  float refreshDeltaC;
+  uint16_t rotateMin;         // multi-location page time
+};
+
+// Where settingsLoad() got them from
+enum SettingsSource : uint8_t {
+  SETTINGS_RTC,         // warm wake, NVS untouched
+  SETTINGS_NVS,         // the blob
+  SETTINGS_MIGRATED,    // per-value keys of older firmware, now saved as a blob
+  SETTINGS_DEFAULTS,    // nothing stored yet
+};
+
+void settingsDefaults(Settings& s);
+SettingsSource settingsLoad(Settings& out);
+bool settingsSave(const Settings& s);   // NVS blob + RTC mirror
+// Drops the RTC mirror as a power-on reset does: the next load reads NVS
+void settingsForgetMirror();
+const char* settingsSourceName(SettingsSource src);
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <Arduino.h>
+#ifdef ARDUINO
+#include <WiFiClient.h>
+#include <mbedtls/ssl.h>
+#endif
+
+// ===== TLS client with session resumption =====
+// HTTPS transport for HttpSession: mbedtls over a plain WiFiClient socket.
+// The server certificate is checked against the ESP-IDF root bundle, and
+// optionally against a pinned public key (TLS_PIN_SHA256 in
+// tls_client.cpp), looked for in the peer chain after a full handshake.
+// Validity dates need a set clock; one handshake per cold boot may skip
+// them so the HTTP Date header can set it (see TLS_CLOCK_VALID_AFTER
+// there). After each handshake the session is saved in RTC memory. The
+// next connection, after deep sleep too, offers it, and the server can
+// resume with an abbreviated handshake: no certificate chain, no key
+// exchange. A session the server no longer knows costs a normal
+// full handshake. If the handshake fails while a session is offered, the
+// session is dropped and the connection retried once without it.
+//
+// Off-target builds (the native test env) get a plain TCP client with the
+// same interface instead (tls_client_host.cpp), so HttpSession can be run
+// against a local stand-in server. There is no mbedtls on the host, so
+// handshake time and bytes are only measured on the device (the `tls`
+// wake phase and the per-connection log line).
+
+// Serialized session (ticket/ID, keys, peer certificate) kept in RTC
+// memory. Sessions that don't fit are logged and not saved; raise it with
+// build_flags = -DTLS_SESSION_MAX=...
+#ifndef TLS_SESSION_MAX
+#define TLS_SESSION_MAX 2048
+#endif
+
+// What the last connect() cost; bytes are TLS records on the wire
+struct TlsHandshakeStats {
+  uint32_t ms = 0;          // TCP connect + handshake
+  uint32_t bytesOut = 0;
+  uint32_t bytesIn = 0;
+  bool resumed = false;     // abbreviated handshake from the saved session
+};
+
+class TlsClient : public Client {
+public:
+  ~TlsClient() { stop(); }
+
+  int connect(IPAddress ip, uint16_t port) override;   // no host name to verify: always fails
+  int connect(const char* host, uint16_t port) override;
+  // To an address resolved beforehand; `host` is still what gets verified
+  int connect(const char* host, IPAddress ip, uint16_t port);
+
+  using Print::write;
+  size_t write(uint8_t b) override { return write(&b, 1); }
+  size_t write(const uint8_t* buf, size_t size) override;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t size) override;
+  int peek() override;
+  void flush() override {}
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override { return connected(); }
+
+  const TlsHandshakeStats& handshakeStats() const { return _hs; }
+
+  // Forget the saved session (the next handshake is a full one)
+  static void dropSession();
+
+private:
+#ifdef ARDUINO
+  bool open(const char* host, const IPAddress* ip, uint16_t port, bool offerSession);
+  bool loadSession(const char* host);
+  void saveSession(const char* host);
+  void fail(const char* what, int ret);
+
+  static int bioSend(void* ctx, const unsigned char* buf, size_t len);
+  static int bioRecv(void* ctx, unsigned char* buf, size_t len);
+  static void exportKeys(void* ctx, mbedtls_ssl_key_export_type type, const unsigned char* secret, size_t len,
+                         const unsigned char* clientRandom, const unsigned char* serverRandom,
+                         mbedtls_tls_prf_types prf);
+
+  WiFiClient _tcp;
+  mbedtls_ssl_context _ssl;
+  mbedtls_ssl_config _conf;
+  bool _open = false;        // _ssl/_conf set up, to be freed
+  bool _connected = false;   // handshake done, no error or close since
+  int _peeked = -1;
+
+  uint32_t _secretHash = 0;  // master secret of the current handshake
+  bool _retryFull = false;   // failed with a session offered, not on the certificate
+
+  bool _counting = false;    // handshake in progress: count bytes into _hs
+#else
+  int _fd = -1;
+  int _peeked = -1;
+#endif
+  TlsHandshakeStats _hs;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+
+// ===== Adaptive wake scheduling =====
+// Picks the next sleep from how fast the weather is changing, instead of a
+// fixed interval: the configured update interval when things are stable,
+// down to a minimum when the forecast or the last readings move quickly.
+// Wakes are also pulled in to just after a night-mode boundary so the
+// view switches on time. A separate check tells whether a new reading
+// differs enough from what the panel shows to be worth a refresh.
+//
+// Pure logic (no Arduino), like frame_diff.
+
+struct ScheduleConfig {
+  uint32_t minSec;          // shortest sleep, fast-changing weather
+  uint32_t maxSec;          // longest sleep, stable weather
+  uint8_t nightStartHour;   // local hours; equal = no night mode
+  uint8_t nightEndHour;
+};
+
+struct WeatherTrend {
+  bool haveForecast = false;
+  float forecastStepC = 0;         // largest change between consecutive forecast slots ahead
+  bool forecastConditionChange = false;  // e.g. clear -> rain within the forecast horizon
+  bool haveObserved = false;
+  float observedRateCPerHour = 0;  // current reading vs the previous one
+};
+
+// Temperature changes treated as "fast" (volatility 1.0)
+static const float TREND_FAST_STEP_C = 4.0f;          // per 3 h forecast slot
+static const float TREND_FAST_RATE_C_PER_H = 2.0f;
+static const float TREND_CONDITION_CHANGE = 0.75f;    // volatility of a condition change alone
+
+// Past a night boundary by this much before waking, so the local-time
+// check on the new wake is clearly on the other side
+static const uint32_t SCHEDULE_BOUNDARY_SLACK_S = 60;
+
+// 0 (stable) .. 1 (fast changing)
+float trendVolatility(const WeatherTrend& trend);
+
+// Seconds to sleep from `secOfDay` (local seconds since midnight, or
+// UINT32_MAX when the clock is unknown)
+uint32_t nextWakeSeconds(const ScheduleConfig& cfg, const WeatherTrend& trend, uint32_t secOfDay);
+
+// Retries after a failed fetch: the first one after about a minute,
+// doubling per consecutive failure up to the normal longest sleep, with
+// +/-25 % jitter so units behind the same outage don't retry in step
+static const uint32_t RETRY_FIRST_S = 60;
+static const uint8_t RETRY_JITTER_PERCENT = 25;
+
+// `failures` >= 1; `random` is any 32-bit random value (esp_random())
+uint32_t retryBackoffSeconds(uint8_t failures, uint32_t maxSec, uint32_t random);
+
+// The values a refresh decision looks at; NaN = not shown
+struct ShownReading {
+  uint8_t view;
+  uint8_t page;             // multi-location: 0 = home city
+  uint16_t localDay;        // the detail view shows the date
+  int16_t weatherId;
+  float temp;
+  float tempMin;
+  float tempMax;
+  int16_t forecastId;
+  float forecastMin;
+  float forecastMax;
+  bool stale;               // last-good data shown after a failed fetch
+};
+
+// True when `next` would render differently from `prev` by more than
+// `deltaC` on any temperature, or differs in view, page, day, condition
+// or staleness
+bool readingChanged(const ShownReading& prev, const ShownReading& next, float deltaC);
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ===== Wake-cycle instrumentation =====
+// Every wake fills one record of per-phase milliseconds. Records are kept
+// in an RTC ring across deep sleep and written to serial as hex lines
+// ("#WT1 ...") while a host is listening; tools/wake_report.py turns a
+// capture of many wakes into p50/p95/max per phase.
+//
+//   { PhaseTimer t(PHASE_SETTINGS); loadSettings(); }
+//   ...
+//   traceCommit();   // right before esp_deep_sleep_start()
+//
+// Without deep sleep every update cycle of loop() is traced as a wake of
+// its own: traceBegin() at its start, traceCommit() at its end.
+
+enum WakePhase : uint8_t {
+  PHASE_DISPLAY_INIT = 0,  // runs in the background, overlapping WiFi and the fetch
+  PHASE_SETTINGS,
+  PHASE_WIFI,          // connectWiFi(): fast reconnect or WiFiManager
+  PHASE_TIME_SYNC,
+  PHASE_TLS,           // handshakes
+  PHASE_HTTP_WAIT,     // request written -> headers, plus stalls on body bytes
+  PHASE_JSON,          // body read time that wasn't spent waiting: parsing
+  PHASE_RENDER,        // drawing into the frame buffer
+  PHASE_PANEL,         // diff, controller writes, BUSY wait, hibernate
+  PHASE_SLEEP_ENTRY,   // radio off, trace dump, up to esp_deep_sleep_start()
+  PHASE_PANEL_BUSY,    // part of PHASE_PANEL in light sleep on BUSY, chip not running
+  PHASE_COUNT
+};
+
+// Record flags
+static const uint8_t WAKE_COLD         = 0x01;  // power-on / reset, RTC memory was lost
+static const uint8_t WAKE_NO_WIFI      = 0x02;  // served from the cache, radio stayed off
+static const uint8_t WAKE_FULL_REFRESH = 0x04;
+static const uint8_t WAKE_PARTIAL      = 0x08;
+static const uint8_t WAKE_FAILED       = 0x10;  // no WiFi or no weather data
+
+void traceBegin();                              // first thing in setup() / each cycle
+void traceAdd(WakePhase phase, uint32_t ms);    // phases add up, saturating at 65535
+void traceFlag(uint8_t flags);
+void traceCommit();                             // store this wake's record and dump pending ones
+void traceDump(Print& out, bool all = false);   // pending records, or the whole ring
+
+// Adds the lifetime of the enclosing scope to a phase
+class PhaseTimer {
+public:
+  explicit PhaseTimer(WakePhase phase) : _phase(phase), _start(millis()) {}
+  ~PhaseTimer() { traceAdd(_phase, millis() - _start); }
+
+  PhaseTimer(const PhaseTimer&) = delete;
+  PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+  WakePhase _phase;
+  uint32_t _start;
+};
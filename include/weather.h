@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Arduino.h>
+#include <time.h>
+
+#include "fixed_string.h"
+
+// ===== Weather data =====
+struct WeatherData {
+  float temp = NAN;
+  float tempMin = NAN;
+  float tempMax = NAN;
+  float feelsLike = NAN;       // "feels like" temperature
+  int weatherId = -1;          // OpenWeather "id" code
+  FixedString<16> main;        // "Clear", "Clouds", ...
+  FixedString<40> description; // "few clouds"
+  FixedString<4> iconCode;     // Icon code from API (e.g., "01d", "02n")
+  unsigned long timestamp = 0; // Unix timestamp of data retrieval
+};
+
+// ===== Forecast data for tomorrow =====
+// Tomorrow is the next local calendar day: min/max over all its slots,
+// and the condition most of them share.
+struct ForecastData {
+  float tempMin = NAN;         // Tomorrow min temp
+  float tempMax = NAN;         // Tomorrow max temp
+  int weatherId = -1;          // Tomorrow's dominant weather ID
+  FixedString<16> main;        // Tomorrow weather main
+  FixedString<4> iconCode;     // Tomorrow icon code
+  uint32_t tomorrowStart = 0;  // UTC time "tomorrow" begins; the record is stale from then
+  float maxStepC = 0;          // Largest temp change between consecutive slots, next 12 h
+  bool conditionChange = false; // Condition group changes within the next 12 h
+};
+
+// ===== Other locations (multi-location mode) =====
+// Extra cities are given as OpenWeather city IDs and fetched together from
+// the group endpoint, which takes at most this many per request.
+static const size_t MAX_LOCATIONS = 20;
+
+struct LocationWeather {
+  uint32_t cityId = 0;
+  FixedString<24> name;        // as the API spells it
+  WeatherData weather;
+};
+
+// Called once per city, in response order, while the body streams in.
+// `loc` is reused for the next city; the sink may fill in more fields.
+typedef void (*LocationSink)(void* ctx, size_t index, LocationWeather& loc);
+
+// ===== JSON -> record parsing =====
+// Kept apart from the HTTP code so it can be fed recorded payloads
+// (serial captures, fixtures) without WiFi or a panel attached. Input is
+// consumed as a stream; the body is never buffered whole.
+bool parseWeather(Stream& input, WeatherData& out);
+// `now` and `utcOffsetSec` decide which local day is tomorrow
+bool parseForecast(Stream& input, ForecastData& out, time_t now, int32_t utcOffsetSec);
+// Group response, one city at a time: memory use doesn't grow with the
+// number of cities. `count` is how many reached the sink.
+bool parseGroup(Stream& input, LocationSink sink, void* ctx, size_t& count);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "weather.h"
+
+// ===== Weather cache in RTC memory =====
+// Last parsed records plus fetch time and HTTP validators, kept across
+// deep sleep (and soft resets / brownouts). Fresh entries let a wake skip
+// the radio entirely; stale ones are re-fetched conditionally so an
+// unchanged answer (304) costs neither parsing nor a redraw.
+enum CacheKind : uint8_t {
+  CACHE_WEATHER = 0,
+  CACHE_FORECAST = 1,
+  CACHE_GROUP = 2,      // other locations, see cacheStoreLocation()
+};
+
+// Drops every entry if the home location/units differ from the cached
+// ones. The other locations have their own key (units + city IDs), so a
+// changed list only drops those.
+void cacheBegin(const char* homeQuery, const char* groupQuery);
+
+bool cacheFresh(CacheKind kind, uint32_t ttlSec);
+bool cacheLoad(WeatherData& out);
+bool cacheLoad(ForecastData& out);
+
+void cacheStore(const WeatherData& w, const char* etag, const char* lastModified);
+void cacheStore(const ForecastData& f, const char* etag, const char* lastModified);
+void cacheTouch(CacheKind kind);   // server confirmed the entry is unchanged
+
+// Last-good copy of the home records (weather + forecast) in NVS, for
+// cold boots after a power loss when RTC memory starts empty. Written at
+// most every `minIntervalSec` to spare the flash; restored entries keep
+// their fetch time, so they only count as fresh if they still are.
+void cachePersist(uint32_t minIntervalSec);
+bool cacheRestore();
+
+// Other locations are stored one by one as the group response streams in,
+// then committed with the response's validators.
+void cacheStoreLocation(size_t index, const LocationWeather& loc);
+void cacheStoreGroup(size_t count, const char* etag, const char* lastModified);
+size_t cacheLocationCount();
+bool cacheLoadLocation(size_t index, LocationWeather& out);
+
+// Appends "If-None-Match: ...\r\n" / "If-Modified-Since: ...\r\n" lines for a request
+void cacheValidatorHeaders(CacheKind kind, StrBuf& out);
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "weather.h"
+
+// ===== Packed readings =====
+// A reading cut down to what a trend needs: 8 bytes instead of a full
+// WeatherData, so a couple of days of them fit in RTC memory.
+
+// OpenWeather id / 100, with clouds (80x) split off from clear (800)
+enum ConditionCode : uint8_t {
+  COND_UNKNOWN = 0,
+  COND_STORM = 2,
+  COND_DRIZZLE = 3,
+  COND_RAIN = 5,
+  COND_SNOW = 6,
+  COND_MIST = 7,
+  COND_CLEAR = 8,
+  COND_CLOUDS = 9,
+};
+
+struct PackedReading {
+  uint32_t time;          // Unix time of the reading
+  int16_t tempCenti;      // 1/100 degree, in the configured units
+  uint8_t condition;      // ConditionCode
+  uint8_t reserved;
+};
+static_assert(sizeof(PackedReading) == 8, "PackedReading is stored in RTC memory as is");
+
+ConditionCode conditionCode(int weatherId);
+// False when `w` has no temperature or time to keep
+bool packReading(const WeatherData& w, PackedReading& out);
+
+// ===== Temperature history =====
+// Ring of the last HISTORY_SIZE home-city readings in RTC memory. Every
+// reading ever added has a sequence number; the panel draws reading `seq`
+// in column seq % (HISTORY_SIZE + 1), so a new one only changes its own
+// column and the blank one after it.
+static const size_t HISTORY_SIZE = 48;
+
+// Empties the ring if the location/units differ from the stored ones
+void historyBegin(const char* query);
+// Ignores readings not newer than the newest one (cache hits, 304s)
+bool historyAdd(const WeatherData& w);
+size_t historyCount();
+// i = 0 is the oldest kept reading; `seq` is its sequence number
+bool historyAt(size_t i, PackedReading& out, uint32_t& seq);
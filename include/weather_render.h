@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "fixed_string.h"
+#include "framebuffer.h"
+#include "weather.h"
+
+// ===== Screen layouts =====
+// Drawing only: everything here writes into a FrameBuffer and nothing
+// touches the panel, the network or NVS, so the native test env draws the
+// same frames the device shows (test/test_bench dumps them as PBM).
+//
+// Each view is drawn in two passes: the chrome (header, dividers, labels)
+// only needs the settings and can be drawn while WiFi is still connecting,
+// the data pass fills in the fetched values. Text that follows a label
+// continues from the cursor position the label left behind.
+
+// Which view a frame holds
+enum PanelView : uint8_t {
+  VIEW_NONE = 0,   // nothing known / error screen
+  VIEW_DETAIL,
+  VIEW_SPLIT,
+};
+
+struct ChromeCursor {
+  int16_t x;
+  int16_t y;
+};
+
+// What a chrome pass leaves for the data pass
+struct ViewChrome {
+  uint8_t view = VIEW_NONE;   // view whose chrome the frame holds
+  ChromeCursor headerEnd;     // split view: time follows the city
+  ChromeCursor minEnd;        // after "Min: "
+  ChromeCursor maxEnd;        // after "Max: "
+};
+
+// Registers the build-time glyph atlases of the layout fonts (glyph_atlas.h)
+void renderBegin(FrameBuffer& frame);
+
+void drawDetailChrome(FrameBuffer& frame, const char* city, ViewChrome& chrome);
+void drawSplitChrome(FrameBuffer& frame, const char* city, ViewChrome& chrome);
+
+// Pre-rasterized icon (icon_sprites.h) for an OpenWeather icon code, else
+// the condition id, else the condition name
+void drawWeatherIcon(FrameBuffer& frame, int x, int y, const StrBuf& iconCode, int weatherId, const StrBuf& main);
+
+// Data passes over the matching chrome. `stale` flags last-good data with
+// a corner mark; `history` adds the temperature history bars
+// (weather_history.h) left of the big temperature.
+void renderWeather(FrameBuffer& frame, const ViewChrome& chrome, const WeatherData& w, bool stale, bool history);
+void renderWeatherSplitScreen(FrameBuffer& frame, const ViewChrome& chrome, const WeatherData& current,
+                              const ForecastData& tomorrow, bool stale);
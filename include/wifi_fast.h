@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+
+// ===== Fast WiFi reconnect =====
+// WiFiManager scans, builds its portal and runs DHCP on every wake. After
+// one good connect the AP's SSID, password, BSSID and channel (and the
+// DHCP lease) are kept in RTC memory, and warm wakes join that AP
+// directly: no scan, and with static reuse enabled no DHCP either. A
+// failed attempt drops the record so the caller falls back to WiFiManager.
+//
+// No Arduino here: the radio sits behind WifiRadio, so the timing logic
+// can be driven by a scripted fake on the host.
+
+struct WifiCache {
+  uint32_t magic;
+  char ssid[33];
+  char pass[65];
+  uint8_t bssid[6];
+  uint8_t channel;
+  bool haveLease;
+  uint32_t ip;        // last DHCP lease, IPv4 in IPAddress byte order
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+};
+
+enum RadioStatus : uint8_t {
+  RADIO_CONNECTING = 0,
+  RADIO_CONNECTED,
+  RADIO_FAILED,       // wrong password, AP gone, ...
+};
+
+class WifiRadio {
+public:
+  virtual ~WifiRadio() {}
+  // Join `ap` on its cached BSSID/channel; staticIp = use the cached lease
+  virtual void begin(const WifiCache& ap, bool staticIp) = 0;
+  virtual RadioStatus status() = 0;
+  virtual void stop() = 0;
+  virtual uint32_t millis() = 0;
+  virtual void sleep(uint32_t ms) = 0;
+};
+
+bool wifiCacheValid(const WifiCache& cache);
+void wifiCacheClear(WifiCache& cache);
+// Records the AP that was just joined. `bssid` may be null (then the AP
+// is found by scanning, as WiFiManager would); ip == 0 means no lease.
+void wifiCacheStore(WifiCache& cache, const char* ssid, const char* pass,
+                    const uint8_t* bssid, uint8_t channel,
+                    uint32_t ip, uint32_t gateway, uint32_t subnet, uint32_t dns);
+
+// Joins the cached AP. Returns true once connected, false on failure or
+// after timeoutMs; the record is cleared on failure.
+bool wifiFastConnect(WifiRadio& radio, WifiCache& cache, bool staticIp, uint32_t timeoutMs);
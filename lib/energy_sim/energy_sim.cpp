@@ -0,0 +1,312 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "energy_sim.h"
+
+// ---------------- Model ----------------
+static const PhaseModel DEFAULT_PHASES[SIM_PHASES] = {
+  { "boot",          280,    30 },
+  { "display_init",  120,    25 },
+  { "settings",        2,    25 },
+  { "wifi",          800,    90 },
+  { "wifi_fail",  185000,    95 },
+  { "time_sync",    1200,    80 },
+  { "tls",           650,    85 },
+  { "http_wait",     350,    80 },
+  { "json_weather",   40,    75 },
+  { "json_forecast", 250,    75 },
+  { "render",         30,    25 },
+  { "panel_partial", 450,    30 },
+  { "panel_full",   2400,    30 },
+  { "sleep_entry",    20,    40 },
+};
+
+SimConfig::SimConfig() {
+  memcpy(phases, DEFAULT_PHASES, sizeof(phases));
+}
+
+bool simSetPhase(SimConfig& cfg, const char* name, float value, bool current) {
+  for (int i = 0; i < SIM_PHASES; i++) {
+    if (!strcmp(cfg.phases[i].name, name)) {
+      (current ? cfg.phases[i].mA : cfg.phases[i].ms) = value;
+      return true;
+    }
+  }
+  return false;
+}
+
+int simLoadProfile(SimConfig& cfg, const char* path) {
+  FILE* f = fopen(path, "r");
+  if (!f) {
+    fprintf(stderr, "energy_sim: can't read profile %s\n", path);
+    return -1;
+  }
+  char line[128];
+  int set = 0;
+  while (fgets(line, sizeof(line), f)) {
+    char name[32];
+    float ms;
+    if (line[0] == '#' || sscanf(line, "%31s %f", name, &ms) != 2) continue;
+    if (!simSetPhase(cfg, name, ms, false)) {
+      fprintf(stderr, "energy_sim: unknown phase '%s' in %s\n", name, path);
+      fclose(f);
+      return -1;
+    }
+    set++;
+  }
+  fclose(f);
+  return set;
+}
+
+// ---------------- Synthetic weather ----------------
+// A daily cycle plus fronts every few days that move the temperature by a
+// few degrees over three hours and bring rain with them.
+struct Front {
+  uint32_t at;
+  float stepC;
+};
+
+static const int MAX_FRONTS = 256;
+static Front g_fronts[MAX_FRONTS];
+static int g_frontCount = 0;
+static uint32_t g_rng = 1;
+
+static uint32_t nextRandom() {   // xorshift32
+  g_rng ^= g_rng << 13;
+  g_rng ^= g_rng >> 17;
+  g_rng ^= g_rng << 5;
+  return g_rng;
+}
+
+static float uniform() {
+  return (nextRandom() >> 8) / 16777216.0f;
+}
+
+static void makeFronts(uint32_t days) {
+  g_frontCount = 0;
+  uint32_t t = 0;
+  while (g_frontCount < MAX_FRONTS) {
+    t += (uint32_t)((1.5f + 3.0f * uniform()) * 86400);
+    if (t > days * 86400UL) break;
+    g_fronts[g_frontCount].at = t;
+    g_fronts[g_frontCount].stepC = (uniform() < 0.5f ? -1 : 1) * (2.0f + 5.0f * uniform());
+    g_frontCount++;
+  }
+}
+
+static const uint32_t FRONT_RAMP_S = 3 * 3600;
+
+static float temperatureAt(uint32_t t) {
+  float hour = (t % 86400) / 3600.0f;
+  float temp = 18 + 6 * sinf((hour - 9) * (float)M_PI / 12);
+  for (int i = 0; i < g_frontCount && g_fronts[i].at <= t; i++) {
+    float ramp = (float)(t - g_fronts[i].at) / FRONT_RAMP_S;
+    temp += g_fronts[i].stepC * (ramp > 1 ? 1 : ramp);
+  }
+  return temp;
+}
+
+static bool rainingAt(uint32_t t) {
+  for (int i = 0; i < g_frontCount; i++) {
+    if (t >= g_fronts[i].at && t < g_fronts[i].at + 2 * FRONT_RAMP_S) return true;
+  }
+  return false;
+}
+
+// What a forecast fetched at `t` reports for the next 4 slots, as parseForecast()
+static void forecastTrend(uint32_t t, WeatherTrend& trend) {
+  trend.haveForecast = true;
+  trend.forecastStepC = 0;
+  trend.forecastConditionChange = false;
+  for (int k = 1; k < 4; k++) {
+    uint32_t a = t + (k - 1) * 3 * 3600, b = t + k * 3 * 3600;
+    float step = fabsf(temperatureAt(b) - temperatureAt(a));
+    if (step > trend.forecastStepC) trend.forecastStepC = step;
+    if (rainingAt(a) != rainingAt(b)) trend.forecastConditionChange = true;
+  }
+}
+
+// ---------------- Replay ----------------
+enum SimView : uint8_t { VIEW_NONE, VIEW_DETAIL, VIEW_SPLIT };
+
+static bool isNight(const ScheduleConfig& cfg, uint32_t t) {
+  uint8_t hour = (t % 86400) / 3600;
+  if (cfg.nightStartHour == cfg.nightEndHour) return false;
+  if (cfg.nightStartHour > cfg.nightEndHour) return hour >= cfg.nightStartHour || hour < cfg.nightEndHour;
+  return hour >= cfg.nightStartHour && hour < cfg.nightEndHour;
+}
+
+static void add(const SimConfig& cfg, SimTotals& tot, SimPhase phase, int times = 1) {
+  tot.phaseMs[phase] += cfg.phases[phase].ms * times;
+  tot.awakeMs += cfg.phases[phase].ms * times;
+}
+
+void simulate(const SimConfig& cfg, SimTotals& tot) {
+  g_rng = cfg.seed ? cfg.seed : 1;
+  makeFronts(cfg.days);
+
+  // RTC state carried between wakes, as in main.cpp
+  bool cold = true;
+  uint32_t weatherAt = 0, forecastAt = 0;
+  bool haveWeather = false, haveForecast = false;
+  WeatherTrend forecast;
+  float prevTemp = NAN;
+  uint32_t prevTempAt = 0;
+  uint8_t failures = 0;
+  uint8_t partialsSinceFull = 0;
+  bool shownValid = false;
+  ShownReading shown = {};
+  uint32_t shownAt = 0;
+  bool panelKnown = false;
+
+  const uint32_t end = cfg.days * 86400UL;
+  uint32_t t = 7 * 3600;   // first power-on in the morning
+  while (t < end) {
+    double awakeBefore = tot.awakeMs;
+    tot.wakes++;
+    add(cfg, tot, SIM_BOOT);
+    add(cfg, tot, SIM_SETTINGS);
+    add(cfg, tot, SIM_DISPLAY_INIT);
+
+    bool night = isNight(cfg.schedule, t);
+    bool weatherCached = haveWeather && t - weatherAt < cfg.weatherTtlSec;
+    bool forecastCached = haveForecast && t - forecastAt < cfg.forecastTtlSec &&
+                          t / 86400 == forecastAt / 86400;   // fetched before midnight: stale
+    bool fetchOk = true;
+    bool stale = false;
+
+    if (weatherCached && (forecastCached || !night)) {
+      tot.cacheWakes++;
+    } else if (uniform() < cfg.wifiFailRate) {
+      add(cfg, tot, SIM_WIFI_FAIL);
+      fetchOk = false;
+    } else {
+      add(cfg, tot, SIM_WIFI);
+      if (cold) add(cfg, tot, SIM_TIME_SYNC);
+      bool needWeather = !weatherCached, needForecast = night && !forecastCached;
+      add(cfg, tot, SIM_TLS);
+      add(cfg, tot, SIM_HTTP_WAIT, needWeather + needForecast);
+      if (uniform() < cfg.fetchFailRate) {
+        fetchOk = false;
+      } else {
+        if (needWeather) {
+          add(cfg, tot, SIM_JSON_WEATHER);
+          weatherAt = t;
+          haveWeather = true;
+        }
+        if (needForecast) {
+          add(cfg, tot, SIM_JSON_FORECAST);
+          forecastAt = t;
+          haveForecast = true;
+          forecastTrend(t, forecast);
+        }
+      }
+    }
+    if (!fetchOk) {
+      tot.failedWakes++;
+      stale = haveWeather;   // last-good data with the stale mark
+    }
+
+    // showWeather(): refresh threshold, then presentFrame()'s refresh choice
+    ShownReading next = {};
+    uint32_t readAt = haveWeather ? weatherAt : t;
+    bool split = night && haveForecast && t / 86400 == forecastAt / 86400;
+    next.view = haveWeather ? (split ? VIEW_SPLIT : VIEW_DETAIL) : VIEW_NONE;
+    next.localDay = (uint16_t)(readAt / 86400);
+    next.weatherId = rainingAt(readAt) ? 500 : 800;
+    next.temp = temperatureAt(readAt);
+    next.tempMin = split ? NAN : roundf(temperatureAt(readAt / 86400 * 86400 + 3 * 3600));
+    next.tempMax = split ? NAN : roundf(temperatureAt(readAt / 86400 * 86400 + 15 * 3600));
+    next.forecastId = split ? (rainingAt(forecastAt + 86400) ? 500 : 800) : -1;
+    next.forecastMin = split ? roundf(temperatureAt(forecastAt + 86400 - 6 * 3600)) : NAN;
+    next.forecastMax = split ? roundf(temperatureAt(forecastAt + 86400 + 6 * 3600)) : NAN;
+    next.stale = stale;
+
+    bool samePanel = panelKnown && shownValid && next.view == shown.view && shown.stale == stale;
+    bool recent = t - shownAt < cfg.schedule.maxSec;
+    if (!(samePanel && recent && !readingChanged(shown, next, cfg.refreshDeltaC))) {
+      add(cfg, tot, SIM_RENDER);
+      bool full = !panelKnown || !samePanel || partialsSinceFull >= cfg.partialMax;
+      if (full) {
+        add(cfg, tot, SIM_PANEL_FULL);
+        tot.fulls++;
+        partialsSinceFull = 0;
+      } else {
+        add(cfg, tot, SIM_PANEL_PARTIAL);
+        tot.partials++;
+        partialsSinceFull++;
+      }
+      panelKnown = true;
+      shown = next;
+      shownValid = next.view != VIEW_NONE;
+      shownAt = t;
+    }
+    add(cfg, tot, SIM_SLEEP_ENTRY);
+
+    // planRetry() / planNextWake()
+    uint32_t sleepSec;
+    if (!fetchOk) {
+      if (failures < UINT8_MAX) failures++;
+      sleepSec = retryBackoffSeconds(failures, cfg.schedule.maxSec, nextRandom());
+    } else {
+      failures = 0;
+      WeatherTrend trend;
+      if (haveForecast && t - forecastAt < 86400) trend = forecast;
+      if (haveWeather && weatherAt == t) {
+        float temp = temperatureAt(t);
+        if (isnan(prevTemp)) {
+          prevTemp = temp;
+          prevTempAt = t;
+        } else if (t - prevTempAt >= 600) {
+          trend.haveObserved = true;
+          trend.observedRateCPerHour = (temp - prevTemp) * 3600.0f / (float)(t - prevTempAt);
+          prevTemp = temp;
+          prevTempAt = t;
+        }
+      }
+      sleepSec = nextWakeSeconds(cfg.schedule, trend, t % 86400);
+    }
+
+    cold = false;
+    t += sleepSec + (uint32_t)((tot.awakeMs - awakeBefore) / 1000);
+  }
+}
+
+// ---------------- Report ----------------
+double simMahPerDay(const SimConfig& cfg, const SimTotals& tot) {
+  double days = cfg.days;
+  double mah = 0;
+  for (int i = 0; i < SIM_PHASES; i++) mah += tot.phaseMs[i] / 1000.0 / days * cfg.phases[i].mA / 3600.0;
+  double sleepSec = 86400.0 - tot.awakeMs / 1000.0 / days;
+  return mah + sleepSec * cfg.sleepUa / 1000.0 / 3600.0;
+}
+
+void simReport(const SimConfig& cfg, const SimTotals& tot) {
+  double days = cfg.days;
+  printf("Simulated %u days: interval %lu h, min %lu min, night %u-%u, wifi fail %.1f%%, fetch fail %.1f%%\n",
+         cfg.days, (unsigned long)(cfg.schedule.maxSec / 3600), (unsigned long)(cfg.schedule.minSec / 60),
+         cfg.schedule.nightStartHour, cfg.schedule.nightEndHour,
+         cfg.wifiFailRate * 100, cfg.fetchFailRate * 100);
+  printf("Wakes/day %.1f (from cache %.1f, failed %.1f), refreshes/day %.1f partial + %.1f full\n\n",
+         tot.wakes / days, tot.cacheWakes / days, tot.failedWakes / days,
+         tot.partials / days, tot.fulls / days);
+
+  printf("%-14s %10s %10s\n", "phase", "s/day", "mAh/day");
+  double totalMah = 0;
+  for (int i = 0; i < SIM_PHASES; i++) {
+    double sec = tot.phaseMs[i] / 1000.0 / days;
+    double mah = sec * cfg.phases[i].mA / 3600.0;
+    totalMah += mah;
+    if (sec > 0) printf("%-14s %10.1f %10.3f\n", cfg.phases[i].name, sec, mah);
+  }
+  double sleepSec = 86400.0 - tot.awakeMs / 1000.0 / days;
+  double sleepMah = sleepSec * cfg.sleepUa / 1000.0 / 3600.0;
+  totalMah += sleepMah;
+  printf("%-14s %10.1f %10.3f\n", "deep_sleep", sleepSec, sleepMah);
+
+  double usable = cfg.batteryMah * cfg.usablePercent / 100.0;
+  printf("\nTotal %.3f mAh/day -> %.0f days on %.0f mAh (%.0f%% usable)\n",
+         totalMah, usable / totalMah, cfg.batteryMah, cfg.usablePercent);
+}
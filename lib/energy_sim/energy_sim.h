@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "wake_scheduler.h"
+
+// ===== Energy simulator =====
+// Replays days of wakes through the firmware's own scheduling code
+// (src/wake_scheduler.cpp) against synthetic weather and a per-phase
+// time/current model, and projects battery life. Host only: the native
+// env builds it for test/test_energy, tools/energy_sim.cpp is the command
+// line around it.
+//
+// The wake follows setup(): cache check, WiFi, NTP on cold boot, weather
+// (+ forecast at night, within its TTL), the refresh threshold and the
+// partial budget, failed fetches with their backoff. Phase times come
+// from measured wakes: tools/wake_report.py --profile writes the p50s of
+// a serial capture in the format simLoadProfile() reads. Everything is an
+// estimate; compare mAh/day before and after a change, don't predict a
+// real battery with it.
+
+enum SimPhase {
+  SIM_BOOT,           // ROM + bootloader + app start, before the trace begins
+  SIM_DISPLAY_INIT,
+  SIM_SETTINGS,
+  SIM_WIFI,           // fast reconnect
+  SIM_WIFI_FAIL,      // fast reconnect timeout + WiFiManager portal timeout
+  SIM_TIME_SYNC,      // NTP, cold boot only
+  SIM_TLS,
+  SIM_HTTP_WAIT,      // per request
+  SIM_JSON_WEATHER,
+  SIM_JSON_FORECAST,  // 40 slots streamed
+  SIM_RENDER,
+  SIM_PANEL_PARTIAL,
+  SIM_PANEL_FULL,
+  SIM_SLEEP_ENTRY,
+  SIM_PHASES
+};
+
+struct PhaseModel {
+  const char* name;
+  float ms;           // per occurrence
+  float mA;           // average current meanwhile
+};
+
+struct SimConfig {
+  SimConfig();
+
+  PhaseModel phases[SIM_PHASES];  // rough ESP32-C6 + 2.13" panel figures until a profile is loaded
+  uint32_t days = 30;
+  float batteryMah = 1000;
+  float usablePercent = 80;       // capacity left after cutoff voltage / self-discharge
+  float sleepUa = 25;             // deep sleep, whole board
+  ScheduleConfig schedule = { 30 * 60, 12 * 3600, 20, 7 };
+  uint32_t weatherTtlSec = 10 * 60;
+  uint32_t forecastTtlSec = 180 * 60;
+  uint8_t partialMax = 10;
+  float refreshDeltaC = 0.5f;
+  float wifiFailRate = 0.01f;     // per wake that needs the radio
+  float fetchFailRate = 0.01f;    // connected, but no usable answer
+  uint32_t seed = 1;
+};
+
+struct SimTotals {
+  double phaseMs[SIM_PHASES] = {};
+  uint32_t wakes = 0;
+  uint32_t cacheWakes = 0;
+  uint32_t failedWakes = 0;
+  uint32_t partials = 0;
+  uint32_t fulls = 0;
+  double awakeMs = 0;
+};
+
+// "name" onto a phase's time (or current); false for an unknown phase
+bool simSetPhase(SimConfig& cfg, const char* name, float value, bool current);
+
+// Phase times from a wake_report.py profile: "<phase> <p50 ms> <wakes>"
+// per line, '#' comments. Phases it lacks keep their figures. Returns
+// how many phases were set, -1 if the file can't be read or names a
+// phase the model doesn't have.
+int simLoadProfile(SimConfig& cfg, const char* path);
+
+void simulate(const SimConfig& cfg, SimTotals& tot);
+
+// Average charge per day, deep sleep included
+double simMahPerDay(const SimConfig& cfg, const SimTotals& tot);
+
+// Per-phase table and the projected battery life on stdout
+void simReport(const SimConfig& cfg, const SimTotals& tot);
@@ -0,0 +1,66 @@
+#include "background_job.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+static uint32_t nowMs() { return millis(); }
+#else
+#include <chrono>
+
+static uint32_t nowMs() {
+  using namespace std::chrono;
+  return (uint32_t)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+void BackgroundJob::run(void* self) {
+  BackgroundJob* job = (BackgroundJob*)self;
+  uint32_t t0 = nowMs();
+  job->_fn(job->_arg);
+  job->_runMs = nowMs() - t0;
+#ifdef ARDUINO
+  xSemaphoreGive(job->_done);
+  vTaskDelete(nullptr);
+#endif
+}
+
+#ifdef ARDUINO
+bool BackgroundJob::start(const char* name, Fn fn, void* arg, uint32_t stackBytes) {
+  join();
+  _fn = fn;
+  _arg = arg;
+  if (!_done) _done = xSemaphoreCreateBinaryStatic(&_doneBuf);
+
+  // Same priority as the caller: it gets the CPU whenever the caller blocks
+  if (xTaskCreate(run, name, stackBytes, this, uxTaskPriorityGet(nullptr), nullptr) != pdPASS) {
+    Serial.printf("Job %s: no task, running inline\n", name);
+    uint32_t t0 = millis();
+    fn(arg);
+    _runMs = millis() - t0;
+    return false;
+  }
+  _started = true;
+  return true;
+}
+
+void BackgroundJob::join() {
+  if (!_started) return;
+  xSemaphoreTake(_done, portMAX_DELAY);
+  _started = false;
+}
+#else
+bool BackgroundJob::start(const char*, Fn fn, void* arg, uint32_t) {
+  join();
+  _fn = fn;
+  _arg = arg;
+  _thread = std::thread(run, this);
+  _started = true;
+  return true;
+}
+
+void BackgroundJob::join() {
+  if (!_started) return;
+  _thread.join();
+  _started = false;
+}
+#endif
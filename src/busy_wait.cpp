@@ -0,0 +1,96 @@
+#include "busy_wait.h"
+
+#include <atomic>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <WiFi.h>
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+static std::atomic<uint32_t> s_sleptMs{ 0 };
+static std::atomic<uint32_t> s_blockedMs{ 0 };
+
+uint32_t busyWaitSleptMs() {
+  return s_sleptMs.load(std::memory_order_relaxed);
+}
+
+uint32_t busyWaitBlockedMs() {
+  return s_blockedMs.load(std::memory_order_relaxed);
+}
+
+void busyWaitOn(BusyLine& line) {
+  uint32_t t0 = line.millis();
+  if (line.ownerTask() && line.radioOff()) {
+    line.lightSleep(BUSY_WAIT_GUARD_MS);
+    s_sleptMs.fetch_add(line.millis() - t0, std::memory_order_relaxed);
+  } else {
+    line.block(BUSY_WAIT_GUARD_MS);
+    s_blockedMs.fetch_add(line.millis() - t0, std::memory_order_relaxed);
+  }
+}
+
+#ifdef ARDUINO
+static int s_pin = -1;
+static int s_busyLevel = HIGH;
+static TaskHandle_t s_owner = nullptr;             // may light-sleep
+static volatile TaskHandle_t s_waiter = nullptr;   // blocked on the edge
+
+static void IRAM_ATTR onBusyEdge(void*) {
+  BaseType_t woken = pdFALSE;
+  TaskHandle_t waiter = s_waiter;
+  if (waiter) vTaskNotifyGiveFromISR(waiter, &woken);
+  if (woken) portYIELD_FROM_ISR();
+}
+
+class EspBusyLine : public BusyLine {
+public:
+  bool ownerTask() override { return xTaskGetCurrentTaskHandle() == s_owner; }
+  bool radioOff() override { return WiFi.getMode() == WIFI_OFF; }
+
+  // The whole chip sleeps; millis() keeps counting through it
+  void lightSleep(uint32_t guardMs) override {
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+    gpio_wakeup_enable((gpio_num_t)s_pin, s_busyLevel == HIGH ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+    esp_sleep_enable_timer_wakeup((uint64_t)guardMs * 1000ULL);
+    Serial.flush();
+
+    esp_light_sleep_start();
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+    gpio_wakeup_disable((gpio_num_t)s_pin);
+  }
+
+  // Only this task waits; the scheduler runs the others or idles
+  void block(uint32_t guardMs) override {
+    ulTaskNotifyTake(pdTRUE, 0);   // drop a stale notification
+    s_waiter = xTaskGetCurrentTaskHandle();
+    attachInterruptArg(s_pin, onBusyEdge, nullptr, s_busyLevel == HIGH ? FALLING : RISING);
+    // The edge may have come before the interrupt was armed
+    if (digitalRead(s_pin) == s_busyLevel) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(guardMs));
+    detachInterrupt(s_pin);
+    s_waiter = nullptr;
+  }
+
+  uint32_t millis() override { return ::millis(); }
+};
+
+static EspBusyLine s_line;
+
+void busyWaitBegin(int pin, int busyLevel) {
+  s_pin = pin;
+  s_busyLevel = busyLevel;
+  s_owner = xTaskGetCurrentTaskHandle();
+}
+
+void busyWaitCallback(const void*) {
+  if (s_pin < 0) {
+    delay(1);   // not set up: GxEPD2's own polling step
+    return;
+  }
+  busyWaitOn(s_line);
+}
+#endif
@@ -0,0 +1,60 @@
+#include <Arduino.h>
+#include <sys/time.h>
+
+#include "clock_sync.h"
+
+static const uint32_t CLOCK_MAGIC = 0x434C4B31;             // "CLK1"
+static const time_t CLOCK_VALID_AFTER = 1577836800;         // 2020-01-01: earlier means never set
+static const int32_t CLOCK_STEP_S = 2;                      // Date has 1 s resolution, don't chase noise
+static const int32_t CLOCK_NTP_DRIFT_S = 300;               // more than the RC clock drifts in a long sleep
+static const uint32_t CLOCK_MAX_UNCHECKED_S = 3 * 86400UL;  // e.g. fetches failing for days
+
+static RTC_DATA_ATTR uint32_t g_clockMagic = 0;
+static RTC_DATA_ATTR uint32_t g_clockCheckedAt = 0;  // last NTP sync or Date comparison
+static RTC_DATA_ATTR bool g_clockNtpDue = false;
+
+static bool clockKnown(time_t now) {
+  return g_clockMagic == CLOCK_MAGIC && now >= CLOCK_VALID_AFTER;
+}
+
+bool clockNeedsNtp() {
+  time_t now = time(nullptr);
+  if (!clockKnown(now) || g_clockNtpDue) return true;
+  return now < (time_t)g_clockCheckedAt ||
+         (uint32_t)(now - g_clockCheckedAt) > CLOCK_MAX_UNCHECKED_S;
+}
+
+void clockNtpSynced() {
+  g_clockMagic = CLOCK_MAGIC;
+  g_clockCheckedAt = time(nullptr);
+  g_clockNtpDue = false;
+}
+
+int32_t clockCorrect(time_t serverNow) {
+  if (serverNow < CLOCK_VALID_AFTER) return 0;
+
+  time_t now = time(nullptr);
+  bool known = clockKnown(now);
+  int32_t offset = known ? (int32_t)(serverNow - now) : 0;
+
+  if (!known) {
+    Serial.println("Clock: set from HTTP Date");
+  } else {
+    uint32_t since = (uint32_t)(now - g_clockCheckedAt);
+    long ppm = since ? (long)((int64_t)offset * 1000000 / since) : 0;
+    Serial.printf("Clock: %+ld s vs server after %lu s unchecked (%ld ppm)\n",
+                  (long)offset, (unsigned long)since, ppm);
+  }
+
+  if (!known || offset >= CLOCK_STEP_S || offset <= -CLOCK_STEP_S) {
+    struct timeval tv = { serverNow, 0 };
+    settimeofday(&tv, nullptr);
+  }
+
+  // Way beyond what the oscillator explains: the clock or the header is
+  // wrong, let NTP settle it
+  g_clockNtpDue = known && (offset > CLOCK_NTP_DRIFT_S || offset < -CLOCK_NTP_DRIFT_S);
+  g_clockMagic = CLOCK_MAGIC;
+  g_clockCheckedAt = (uint32_t)serverNow;
+  return offset;
+}
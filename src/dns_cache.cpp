@@ -0,0 +1,240 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <esp_random.h>
+#include <time.h>
+
+#include "dns_cache.h"
+
+static const uint16_t DNS_PORT = 53;
+static const uint32_t DNS_TIMEOUT_MS = 1500;   // per attempt
+static const int DNS_ATTEMPTS = 2;
+static const size_t DNS_MAX_MSG = 512;         // plain UDP DNS, no EDNS
+static const uint16_t DNS_TYPE_A = 1;
+static const uint16_t DNS_CLASS_IN = 1;
+
+static const uint32_t DNS_CACHE_MAGIC = 0x444e5332; // "DNS2", bump when DnsEntry changes
+
+struct DnsEntry {
+  char host[DNS_MAX_HOST];   // "" = free slot
+  uint8_t addr[4];
+  uint32_t expires;          // Unix time the TTL runs out
+  uint32_t ttl;              // as the resolver gave it
+};
+
+static RTC_DATA_ATTR uint32_t s_magic = 0;
+static RTC_DATA_ATTR DnsEntry s_entries[DNS_CACHE_SIZE];
+
+// ---------------- Wire format (RFC 1035) ----------------
+static uint16_t get16(const uint8_t* p) {
+  return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+// Header + one question for the A record of `host`; 0 if it doesn't fit
+static size_t buildQuery(uint16_t id, const char* host, uint8_t* out, size_t cap) {
+  static const uint8_t HEADER[10] = { 0x01, 0x00, 0, 1, 0, 0, 0, 0, 0, 0 }; // RD; 1 question
+  if (cap < 12) return 0;
+  out[0] = id >> 8;
+  out[1] = id & 0xff;
+  memcpy(out + 2, HEADER, sizeof(HEADER));
+  size_t n = 12;
+
+  for (const char* label = host; *label;) {
+    const char* dot = strchr(label, '.');
+    size_t len = dot ? (size_t)(dot - label) : strlen(label);
+    if (len == 0 || len > 63 || n + 1 + len + 5 > cap) return 0;
+    out[n++] = (uint8_t)len;
+    memcpy(out + n, label, len);
+    n += len;
+    label += len + (dot ? 1 : 0);
+  }
+  out[n++] = 0;
+  out[n++] = 0;
+  out[n++] = DNS_TYPE_A;
+  out[n++] = 0;
+  out[n++] = DNS_CLASS_IN;
+  return n;
+}
+
+// Past an encoded name (labels, ending in a root label or a pointer); 0 if malformed
+static size_t skipName(const uint8_t* msg, size_t len, size_t pos) {
+  while (pos < len) {
+    uint8_t b = msg[pos];
+    if (b == 0) return pos + 1;
+    if ((b & 0xc0) == 0xc0) return pos + 2 <= len ? pos + 2 : 0;
+    if (b & 0xc0) return 0;
+    pos += 1 + b;
+  }
+  return 0;
+}
+
+// 1: answer to `id` with an A record (TTL = lowest along the CNAME chain
+// leading to it); 0: not an answer to us, keep waiting; -1: our answer,
+// but no address in it
+static int parseResponse(const uint8_t* msg, size_t len, uint16_t id, uint8_t addr[4], uint32_t& ttl) {
+  if (len < 12 || get16(msg) != id || !(msg[2] & 0x80)) return 0;
+  if ((msg[3] & 0x0f) != 0) return -1;   // rcode: NXDOMAIN, SERVFAIL, ...
+  uint16_t questions = get16(msg + 4);
+  uint16_t answers = get16(msg + 6);
+
+  size_t pos = 12;
+  for (uint16_t i = 0; i < questions; i++) {
+    pos = skipName(msg, len, pos);
+    if (!pos || pos + 4 > len) return -1;
+    pos += 4;
+  }
+
+  uint32_t minTtl = UINT32_MAX;
+  for (uint16_t i = 0; i < answers; i++) {
+    pos = skipName(msg, len, pos);
+    if (!pos || pos + 10 > len) return -1;
+    uint16_t type = get16(msg + pos);
+    uint16_t cls = get16(msg + pos + 2);
+    uint32_t recordTtl = (uint32_t)get16(msg + pos + 4) << 16 | get16(msg + pos + 6);
+    uint16_t rdlen = get16(msg + pos + 8);
+    pos += 10;
+    if (pos + rdlen > len) return -1;
+    if (recordTtl < minTtl) minTtl = recordTtl;
+    if (type == DNS_TYPE_A && cls == DNS_CLASS_IN && rdlen == 4) {
+      memcpy(addr, msg + pos, 4);
+      ttl = minTtl;
+      return 1;
+    }
+    pos += rdlen;
+  }
+  return -1;
+}
+
+// ---------------- Lookup ----------------
+static bool lookup(const char* host, uint8_t addr[4], uint32_t& ttl) {
+  IPAddress server = WiFi.dnsIP(0);
+  if (server == IPAddress((uint32_t)0)) {
+    Serial.println("DNS: no resolver address");
+    return false;
+  }
+
+  uint8_t query[DNS_MAX_MSG / 2];
+  uint16_t id = (uint16_t)esp_random();
+  size_t queryLen = buildQuery(id, host, query, sizeof(query));
+  if (!queryLen) {
+    Serial.printf("DNS: bad host name %s\n", host);
+    return false;
+  }
+
+  WiFiUDP udp;
+  if (!udp.begin(0)) return false;   // any local port
+  int result = 0;
+  for (int attempt = 0; attempt < DNS_ATTEMPTS && result == 0; attempt++) {
+    udp.beginPacket(server, DNS_PORT);
+    udp.write(query, queryLen);
+    if (!udp.endPacket()) break;
+
+    uint32_t t0 = millis();
+    while (result == 0 && millis() - t0 < DNS_TIMEOUT_MS) {
+      if (udp.parsePacket() <= 0) {
+        delay(1);
+        continue;
+      }
+      uint8_t msg[DNS_MAX_MSG];
+      int len = udp.read(msg, sizeof(msg));
+      if (len > 0 && udp.remoteIP() == server && udp.remotePort() == DNS_PORT) {
+        result = parseResponse(msg, (size_t)len, id, addr, ttl);
+      }
+    }
+  }
+  udp.stop();
+  return result == 1;
+}
+
+// ---------------- Cache ----------------
+// RTC memory holds garbage after power-on
+static void validate() {
+  if (s_magic != DNS_CACHE_MAGIC) {
+    memset(s_entries, 0, sizeof(s_entries));
+    s_magic = DNS_CACHE_MAGIC;
+  }
+}
+
+static DnsEntry* findEntry(const char* host) {
+  validate();
+  for (DnsEntry& e : s_entries) {
+    if (e.host[0] && strcmp(e.host, host) == 0) return &e;
+  }
+  return nullptr;
+}
+
+// Same host, else a free slot, else the entry that expires first
+static void store(const char* host, const uint8_t addr[4], uint32_t ttl, time_t now) {
+  if (strlen(host) >= DNS_MAX_HOST || ttl == 0) return;
+  DnsEntry* slot = findEntry(host);
+  for (DnsEntry& e : s_entries) {
+    if (slot) break;
+    if (!e.host[0]) slot = &e;
+  }
+  if (!slot) {
+    slot = &s_entries[0];
+    for (DnsEntry& e : s_entries) {
+      if ((int32_t)(e.expires - slot->expires) < 0) slot = &e;
+    }
+  }
+  strcpy(slot->host, host);
+  memcpy(slot->addr, addr, 4);
+  slot->expires = (uint32_t)now + ttl;
+  slot->ttl = ttl;
+}
+
+static bool resolveFresh(const char* host, IPAddress& ip) {
+  uint8_t addr[4];
+  uint32_t ttl = 0;
+  uint32_t t0 = millis();
+  if (!lookup(host, addr, ttl)) {
+    Serial.printf("DNS: lookup of %s failed\n", host);
+    return false;
+  }
+  store(host, addr, ttl, time(nullptr));
+  ip = IPAddress(addr[0], addr[1], addr[2], addr[3]);
+  Serial.printf("DNS: %s -> %u.%u.%u.%u (TTL %lu s) in %lu ms\n", host, addr[0], addr[1], addr[2], addr[3],
+                (unsigned long)ttl, (unsigned long)(millis() - t0));
+  return true;
+}
+
+bool dnsResolve(const char* host, IPAddress& ip, bool* fromCache) {
+  if (fromCache) *fromCache = false;
+  if (ip.fromString(host)) return true;
+
+  const DnsEntry* e = findEntry(host);
+  int32_t left = e ? (int32_t)(e->expires - (uint32_t)time(nullptr)) : 0;
+  if (left > 0) {
+    ip = IPAddress(e->addr[0], e->addr[1], e->addr[2], e->addr[3]);
+    if (fromCache) *fromCache = true;
+    Serial.printf("DNS: %s cached (%ld s left)\n", host, (long)left);
+    return true;
+  }
+  return resolveFresh(host, ip);
+}
+
+void dnsForget(const char* host) {
+  DnsEntry* e = findEntry(host);
+  if (e) e->host[0] = '\0';
+}
+
+// A record whose TTL is shorter than the horizon would be stale by the
+// next wake however freshly it was looked up: the lookup is left to that
+// wake instead of paid twice
+void dnsRefresh(uint32_t horizonSec) {
+  validate();
+  for (DnsEntry& e : s_entries) {
+    if (!e.host[0]) continue;
+    int32_t left = (int32_t)(e.expires - (uint32_t)time(nullptr));
+    if (left >= (int32_t)horizonSec) continue;
+    if (e.ttl < horizonSec) {
+      Serial.printf("DNS: %s not refreshed, TTL %lu s < %lu s to the next wake\n", e.host,
+                    (unsigned long)e.ttl, (unsigned long)horizonSec);
+      continue;
+    }
+    char host[DNS_MAX_HOST];
+    strcpy(host, e.host);   // store() may rewrite the entry
+    IPAddress ip;
+    resolveFresh(host, ip);
+  }
+}
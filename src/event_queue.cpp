@@ -0,0 +1,70 @@
+#include "event_queue.h"
+
+// Signed distance, correct across the 49-day millis() wrap
+static int32_t remaining(uint32_t dueMs, uint32_t nowMs) {
+  return (int32_t)(dueMs - nowMs);
+}
+
+int EventQueue::schedule(uint32_t nowMs, uint32_t delayMs, Job job, void* ctx, uint32_t periodMs) {
+  for (int i = 0; i < MAX_TIMERS; i++) {
+    Timer& t = _timers[i];
+    if (t.active) continue;
+    t.job = job;
+    t.ctx = ctx;
+    t.dueMs = nowMs + delayMs;
+    t.periodMs = periodMs;
+    t.active = true;
+    return i;
+  }
+  return -1;
+}
+
+void EventQueue::reschedule(int id, uint32_t nowMs, uint32_t delayMs) {
+  if (id < 0 || id >= MAX_TIMERS || !_timers[id].job) return;
+  _timers[id].dueMs = nowMs + delayMs;
+  _timers[id].active = true;
+}
+
+void EventQueue::cancel(int id) {
+  if (id < 0 || id >= MAX_TIMERS) return;
+  _timers[id].active = false;
+}
+
+uint32_t EventQueue::nextDueIn(uint32_t nowMs) const {
+  uint32_t next = NEVER;
+  for (const Timer& t : _timers) {
+    if (!t.active) continue;
+    int32_t r = remaining(t.dueMs, nowMs);
+    if (r <= 0) return 0;
+    if ((uint32_t)r < next) next = (uint32_t)r;
+  }
+  return next;
+}
+
+int EventQueue::runDue(uint32_t nowMs) {
+  bool ran[MAX_TIMERS] = {};
+  int count = 0;
+  for (;;) {
+    // Earliest due job not run yet in this call
+    int pick = -1;
+    for (int i = 0; i < MAX_TIMERS; i++) {
+      const Timer& t = _timers[i];
+      if (!t.active || ran[i] || remaining(t.dueMs, nowMs) > 0) continue;
+      if (pick < 0 || remaining(t.dueMs, _timers[pick].dueMs) < 0) pick = i;
+    }
+    if (pick < 0) return count;
+
+    Timer& t = _timers[pick];
+    ran[pick] = true;
+    if (t.periodMs) {
+      do {
+        t.dueMs += t.periodMs;
+      } while (remaining(t.dueMs, nowMs) <= 0);
+    } else {
+      t.active = false;
+    }
+    // After the bookkeeping: the job may reschedule or cancel itself
+    t.job(t.ctx);
+    count++;
+  }
+}
@@ -0,0 +1,126 @@
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "fixed_string.h"
+
+void StrBuf::clear() {
+  _len = 0;
+  _overflow = false;
+  _buf[0] = '\0';
+}
+
+StrBuf& StrBuf::append(const char* s, size_t n) {
+  if (!s) return *this;
+  size_t room = _cap - 1 - _len;
+  if (n > room) {
+    n = room;
+    _overflow = true;
+  }
+  memcpy(_buf + _len, s, n);
+  _len += n;
+  _buf[_len] = '\0';
+  return *this;
+}
+
+StrBuf& StrBuf::append(const char* s) {
+  return s ? append(s, strlen(s)) : *this;
+}
+
+StrBuf& StrBuf::append(char c) {
+  return append(&c, 1);
+}
+
+StrBuf& StrBuf::appendInt(long v) {
+  char digits[12];
+  unsigned long u = v < 0 ? 0UL - (unsigned long)v : (unsigned long)v;
+  int n = 0;
+  do {
+    digits[n++] = (char)('0' + u % 10);
+    u /= 10;
+  } while (u);
+  if (v < 0) append('-');
+  while (n) append(digits[--n]);
+  return *this;
+}
+
+StrBuf& StrBuf::appendFixed(float v, uint8_t decimals) {
+  if (isnan(v)) return append("nan");
+  if (decimals > 6) decimals = 6;
+
+  uint32_t scale = 1;
+  for (uint8_t i = 0; i < decimals; i++) scale *= 10;
+
+  // Round half away from zero on the scaled value; "-0.0" prints as "0.0"
+  bool negative = v < 0;
+  float scaled = fabsf(v) * (float)scale + 0.5f;
+  if (scaled >= 4294967295.0f) return append(negative ? "-inf" : "inf");
+  uint32_t units = (uint32_t)scaled;
+
+  if (negative && units != 0) append('-');
+  appendInt((long)(units / scale));
+  if (decimals) {
+    append('.');
+    uint32_t frac = units % scale;
+    for (uint32_t div = scale / 10; div; div /= 10) {
+      append((char)('0' + (frac / div) % 10));
+    }
+  }
+  return *this;
+}
+
+StrBuf& StrBuf::appendf(const char* fmt, ...) {
+  size_t room = _cap - _len;
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(_buf + _len, room, fmt, ap);
+  va_end(ap);
+  if (n < 0) {
+    _buf[_len] = '\0';
+    return *this;
+  }
+  if ((size_t)n >= room) {
+    _len = _cap - 1;
+    _overflow = true;
+  } else {
+    _len += n;
+  }
+  return *this;
+}
+
+StrBuf& StrBuf::appendUrlEncoded(const char* s) {
+  static const char HEX_DIGITS[] = "0123456789ABCDEF";
+  if (!s) return *this;
+  for (; *s; s++) {
+    uint8_t c = (uint8_t)*s;
+    bool unreserved = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+                      (c >= '0' && c <= '9') || c == '-' || c == '.' || c == '_' || c == '~';
+    if (unreserved) {
+      append((char)c);
+    } else {
+      char esc[3] = { '%', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0x0F] };
+      if (_len + 3 > _cap - 1) {   // don't leave half an escape behind
+        _overflow = true;
+        break;
+      }
+      append(esc, 3);
+    }
+  }
+  return *this;
+}
+
+void StrBuf::trim() {
+  size_t start = 0;
+  while (start < _len && (_buf[start] == ' ' || _buf[start] == '\t' ||
+                          _buf[start] == '\r' || _buf[start] == '\n')) {
+    start++;
+  }
+  size_t end = _len;
+  while (end > start && (_buf[end - 1] == ' ' || _buf[end - 1] == '\t' ||
+                         _buf[end - 1] == '\r' || _buf[end - 1] == '\n')) {
+    end--;
+  }
+  _len = end - start;
+  memmove(_buf, _buf + start, _len);
+  _buf[_len] = '\0';
+}
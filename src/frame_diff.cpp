@@ -0,0 +1,110 @@
+#include "frame_diff.h"
+
+static int16_t min16(int16_t a, int16_t b) { return a < b ? a : b; }
+static int16_t max16(int16_t a, int16_t b) { return a > b ? a : b; }
+
+static DirtyRect unionRect(const DirtyRect& a, const DirtyRect& b) {
+  DirtyRect r;
+  r.x = min16(a.x, b.x);
+  r.y = min16(a.y, b.y);
+  r.w = max16(a.x + a.w, b.x + b.w) - r.x;
+  r.h = max16(a.y + a.h, b.y + b.h) - r.y;
+  return r;
+}
+
+static uint32_t area(const DirtyRect& r) {
+  return (uint32_t)r.w * (uint32_t)r.h;
+}
+
+static uint32_t overlapArea(const DirtyRect& a, const DirtyRect& b) {
+  int16_t w = min16(a.x + a.w, b.x + b.w) - max16(a.x, b.x);
+  int16_t h = min16(a.y + a.h, b.y + b.h) - max16(a.y, b.y);
+  return (w > 0 && h > 0) ? (uint32_t)w * (uint32_t)h : 0;
+}
+
+// Merge the two rectangles whose union wastes the fewest clean pixels:
+// the union's area minus what the pair already covers. A rectangle grown
+// by earlier merges can overlap another; the overlap is counted once.
+static void mergeCheapestPair(DirtyRect* rects, int& count) {
+  int bestA = 0, bestB = 1;
+  uint32_t bestCost = UINT32_MAX;
+  for (int a = 0; a < count; a++) {
+    for (int b = a + 1; b < count; b++) {
+      uint32_t covered = area(rects[a]) + area(rects[b]) - overlapArea(rects[a], rects[b]);
+      uint32_t cost = area(unionRect(rects[a], rects[b])) - covered;
+      if (cost < bestCost) { bestCost = cost; bestA = a; bestB = b; }
+    }
+  }
+  rects[bestA] = unionRect(rects[bestA], rects[bestB]);
+  for (int i = bestB; i < count - 1; i++) rects[i] = rects[i + 1];
+  count--;
+}
+
+static void pushRect(DirtyRect* out, int& count, int maxRects, const DirtyRect& r) {
+  if (maxRects == 1 && count == 1) { out[0] = unionRect(out[0], r); return; } // no pair to merge
+  if (count == maxRects) mergeCheapestPair(out, count);
+  out[count++] = r;
+}
+
+int computeDirtyRects(const uint8_t* prev, const uint8_t* next,
+                      int16_t width, int16_t height,
+                      DirtyRect* out, int maxRects) {
+  if (maxRects <= 0) return 0;
+
+  const int16_t stride = (width + 7) / 8;
+  int count = 0;
+
+  bool open = false;
+  int16_t b0 = 0, b1 = 0, y0 = 0, lastDirty = 0;
+
+  for (int16_t y = 0; y < height; y++) {
+    const uint8_t* p = prev + (uint32_t)y * stride;
+    const uint8_t* n = next + (uint32_t)y * stride;
+
+    int16_t first = 0;
+    while (first < stride && p[first] == n[first]) first++;
+    if (first == stride) continue; // clean row
+
+    int16_t last = stride - 1;
+    while (p[last] == n[last]) last--;
+
+    if (open && y - lastDirty - 1 <= FRAME_DIFF_ROW_GAP) {
+      b0 = min16(b0, first);
+      b1 = max16(b1, last);
+    } else {
+      if (open) {
+        DirtyRect r = { (int16_t)(b0 * 8), y0, (int16_t)((b1 - b0 + 1) * 8), (int16_t)(lastDirty - y0 + 1) };
+        pushRect(out, count, maxRects, r);
+      }
+      open = true;
+      b0 = first;
+      b1 = last;
+      y0 = y;
+    }
+    lastDirty = y;
+  }
+
+  if (open) {
+    DirtyRect r = { (int16_t)(b0 * 8), y0, (int16_t)((b1 - b0 + 1) * 8), (int16_t)(lastDirty - y0 + 1) };
+    pushRect(out, count, maxRects, r);
+  }
+
+  // The last byte of a row runs past the panel edge (122 px = 15.25
+  // bytes). Widths stay whole bytes, padding bits included, so the
+  // rectangles can go to the controller as they are.
+  return count;
+}
+
+uint32_t dirtyArea(const DirtyRect* rects, int count) {
+  uint32_t total = 0;
+  for (int i = 0; i < count; i++) total += area(rects[i]);
+  return total;
+}
+
+DirtyRect dirtyBounds(const DirtyRect* rects, int count) {
+  DirtyRect r = { 0, 0, 0, 0 };
+  if (count <= 0) return r;
+  r = rects[0];
+  for (int i = 1; i < count; i++) r = unionRect(r, rects[i]);
+  return r;
+}
@@ -0,0 +1,206 @@
+#include <string.h>
+
+#include "framebuffer.h"
+
+void FrameBuffer::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= width() || y >= height()) return;
+
+  int16_t t;
+  switch (rotation) {
+    case 1:
+      t = x;
+      x = WIDTH - 1 - y;
+      y = t;
+      break;
+    case 2:
+      x = WIDTH - 1 - x;
+      y = HEIGHT - 1 - y;
+      break;
+    case 3:
+      t = x;
+      x = y;
+      y = HEIGHT - 1 - t;
+      break;
+  }
+
+  uint8_t* p = &_buffer[(uint32_t)y * FRAME_STRIDE + (x >> 3)];
+  uint8_t mask = 0x80 >> (x & 7);
+  if (color) *p |= mask;
+  else       *p &= ~mask;
+}
+
+void FrameBuffer::fillScreen(uint16_t color) {
+  memset(_buffer, color ? 0xFF : 0x00, sizeof(_buffer));
+}
+
+void FrameBuffer::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  if (w < 0) { x += w + 1; w = -w; }
+  if (h < 0) { y += h + 1; h = -h; }
+
+  // Clip in rotated coordinates
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > width())  w = width() - x;
+  if (y + h > height()) h = height() - y;
+  if (w <= 0 || h <= 0) return;
+
+  // Same rectangle in native coordinates
+  switch (rotation) {
+    case 0: fillNative(x, y, w, h, color); break;
+    case 1: fillNative(WIDTH - y - h, x, h, w, color); break;
+    case 2: fillNative(WIDTH - x - w, HEIGHT - y - h, w, h, color); break;
+    case 3: fillNative(y, HEIGHT - x - w, h, w, color); break;
+  }
+}
+
+void FrameBuffer::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  fillRect(x, y, w, 1, color);
+}
+
+void FrameBuffer::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  fillRect(x, y, 1, h, color);
+}
+
+// Native, already clipped rectangle: per row a masked head byte, whole
+// bytes up to a 4-byte boundary, aligned words, then bytes and a masked
+// tail. Rows are 16 bytes and the buffer is 4-aligned, so word stores
+// stay aligned; a word is all ones or all zeros, so byte order is moot.
+void FrameBuffer::fillNative(int16_t x, int16_t y, int16_t w, int16_t h, bool white) {
+  const uint8_t fill = white ? 0xFF : 0x00;
+  const uint32_t fillWord = white ? 0xFFFFFFFFu : 0u;
+  int16_t x1 = x + w;              // exclusive
+  int16_t firstByte = x >> 3;
+  int16_t lastByte = (x1 - 1) >> 3;
+  uint8_t headMask = 0xFF >> (x & 7);
+  uint8_t tailMask = (uint8_t)(0xFF00 >> (((x1 - 1) & 7) + 1));
+
+  for (int16_t row = y; row < y + h; row++) {
+    uint8_t* p = &_buffer[(uint32_t)row * FRAME_STRIDE];
+
+    if (firstByte == lastByte) {
+      uint8_t m = headMask & tailMask;
+      p[firstByte] = white ? (p[firstByte] | m) : (p[firstByte] & ~m);
+      continue;
+    }
+
+    p[firstByte] = white ? (p[firstByte] | headMask) : (p[firstByte] & ~headMask);
+    p[lastByte]  = white ? (p[lastByte] | tailMask)  : (p[lastByte] & ~tailMask);
+
+    int16_t b = firstByte + 1;
+    for (; b < lastByte && (b & 3); b++) p[b] = fill;
+    for (; b + 4 <= lastByte; b += 4) memcpy(p + b, &fillWord, 4);  // one aligned store
+    for (; b < lastByte; b++) p[b] = fill;
+  }
+}
+
+void FrameBuffer::drawSprite(const Sprite& s, int16_t x, int16_t y, uint16_t color) {
+  int16_t lx = x + s.ox;
+  int16_t ly = y + s.oy;
+  int16_t nx = WIDTH - ly - s.h;   // native x of sprite bit 0
+
+  if (rotation != 1 || nx < 0 || nx + s.h > WIDTH) {
+    // Other rotations or clipped across native x: plot pixel by pixel
+    for (int16_t i = 0; i < s.w; i++) {
+      const uint8_t* row = s.bits + i * s.stride;
+      for (int16_t k = 0; k < s.h; k++) {
+        if (row[k >> 3] & (0x80 >> (k & 7))) drawPixel(lx + i, ly + s.h - 1 - k, color);
+      }
+    }
+    return;
+  }
+
+  // Rotation 1: sprite rows are native rows, so each byte lands on at most
+  // two frame bytes. Bits past s.h are zero and never touch the next row.
+  uint8_t shift = nx & 7;
+  int16_t col = nx >> 3;
+  for (int16_t i = 0; i < s.w; i++) {
+    int16_t ny = lx + i;
+    if (ny < 0 || ny >= HEIGHT) continue;
+    const uint8_t* src = s.bits + i * s.stride;
+    uint8_t* dst = &_buffer[(uint32_t)ny * FRAME_STRIDE + col];
+    for (uint8_t k = 0; k < s.stride; k++) {
+      uint8_t b = src[k];
+      if (!b) continue;
+      uint8_t hi = b >> shift;
+      uint8_t lo = (uint8_t)(b << (8 - shift));
+      if (color) {
+        dst[k] |= hi;
+        if (lo) dst[k + 1] |= lo;
+      } else {
+        dst[k] &= ~hi;
+        if (lo) dst[k + 1] &= ~lo;
+      }
+    }
+  }
+}
+
+// ---------------- Glyph atlas ----------------
+void FrameBuffer::addGlyphAtlas(const GFXfont* font, const GlyphAtlas* atlas) {
+  if (_atlasCount < MAX_ATLASES) {
+    _atlasFonts[_atlasCount] = font;
+    _atlases[_atlasCount] = atlas;
+    _atlasCount++;
+  }
+}
+
+// Glyph of `c` in the current font's atlas, nullptr when print() has to
+// take the Adafruit GFX path
+const AtlasGlyph* FrameBuffer::atlasGlyph(uint8_t c) {
+  if (!gfxFont || textsize_x != 1 || textsize_y != 1) return nullptr;
+  for (int i = 0; i < _atlasCount; i++) {
+    if (_atlasFonts[i] != gfxFont) continue;
+    const GlyphAtlas* a = _atlases[i];
+    if (c < a->first || c > a->last) return nullptr;
+    const AtlasGlyph* g = &a->glyphs[c - a->first];
+    return g->xAdvance ? g : nullptr;
+  }
+  return nullptr;
+}
+
+// Adafruit_GFX::write() for a custom font, minus the per-bit drawing
+size_t FrameBuffer::write(uint8_t c) {
+  const AtlasGlyph* g = atlasGlyph(c);
+  if (!g) return Adafruit_GFX::write(c);
+
+  const Sprite& s = g->sprite;
+  if (s.w > 0 && s.h > 0) {
+    if (wrap && cursor_x + s.ox + s.w > _width) return Adafruit_GFX::write(c);   // it wraps first
+    drawSprite(s, cursor_x, cursor_y, textcolor);
+  }
+  cursor_x += g->xAdvance;
+  return 1;
+}
+
+// Adafruit_GFX::getTextBounds() / charBounds() over the atlas metrics
+void FrameBuffer::measureText(const char* str, int16_t x, int16_t y,
+                              int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+  int16_t minx = _width, miny = _height, maxx = -1, maxy = -1;
+  int16_t cx = x;
+  for (const char* p = str; *p; p++) {
+    const AtlasGlyph* g = atlasGlyph((uint8_t)*p);
+    if (!g || (wrap && cx + g->sprite.ox + g->sprite.w > _width)) {
+      getTextBounds(str, x, y, x1, y1, w, h);
+      return;
+    }
+    const Sprite& s = g->sprite;
+    int16_t gx1 = cx + s.ox, gy1 = y + s.oy;
+    int16_t gx2 = gx1 + s.w - 1, gy2 = gy1 + s.h - 1;
+    if (gx1 < minx) minx = gx1;
+    if (gy1 < miny) miny = gy1;
+    if (gx2 > maxx) maxx = gx2;
+    if (gy2 > maxy) maxy = gy2;
+    cx += g->xAdvance;
+  }
+
+  *x1 = x;
+  *y1 = y;
+  *w = *h = 0;
+  if (maxx >= minx) {
+    *x1 = minx;
+    *w = maxx - minx + 1;
+  }
+  if (maxy >= miny) {
+    *y1 = miny;
+    *h = maxy - miny + 1;
+  }
+}
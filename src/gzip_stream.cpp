@@ -0,0 +1,167 @@
+#include <Arduino.h>
+#include <esp_rom_crc.h>
+#include <rom/miniz.h>
+
+#include "gzip_stream.h"
+
+// Header flag bits (RFC 1952, 2.3.1)
+static const uint8_t GZ_FHCRC = 0x02;
+static const uint8_t GZ_FEXTRA = 0x04;
+static const uint8_t GZ_FNAME = 0x08;
+static const uint8_t GZ_FCOMMENT = 0x10;
+
+GzipStream::~GzipStream() {
+  free(_decomp);
+  free(_window);
+}
+
+bool GzipStream::reserve() {
+  if (!_decomp) _decomp = malloc(sizeof(tinfl_decompressor));
+  if (!_window) _window = (uint8_t*)malloc(TINFL_LZ_DICT_SIZE);
+  return _decomp && _window;
+}
+
+void GzipStream::begin(Stream* in) {
+  _in = in;
+  _inPos = _inLen = 0;
+  _inEnd = false;
+  _windowPos = _outPos = _outEnd = 0;
+  _headerRead = false;
+  _done = !reserve();
+  _complete = false;
+  _crc = 0;
+  _produced = 0;
+  _inflateUs = 0;
+  if (!_done) tinfl_init((tinfl_decompressor*)_decomp);
+  setTimeout(in->getTimeout());
+}
+
+void GzipStream::fail(const char* why) {
+  Serial.printf("gzip: %s\n", why);
+  _done = true;
+  _outPos = _outEnd;
+}
+
+// Next compressed byte, refilling the input buffer from what has arrived
+// (at least one byte, waiting for it); -1 at the end of the body
+int GzipStream::nextIn() {
+  if (_inPos == _inLen) {
+    if (_inEnd) return -1;
+    int c = _in->read();
+    if (c < 0) {
+      _inEnd = true;
+      return -1;
+    }
+    _inBuf[0] = (uint8_t)c;
+    _inLen = 1;
+    _inPos = 0;
+    while (_inLen < sizeof(_inBuf) && _in->available() > 0) {
+      c = _in->read();
+      if (c < 0) break;
+      _inBuf[_inLen++] = (uint8_t)c;
+    }
+  }
+  return _inBuf[_inPos++];
+}
+
+bool GzipStream::readHeader() {
+  uint8_t h[10];
+  for (uint8_t& b : h) {
+    int c = nextIn();
+    if (c < 0) return false;
+    b = (uint8_t)c;
+  }
+  if (h[0] != 0x1f || h[1] != 0x8b || h[2] != 8) return false;   // magic, deflate
+  uint8_t flags = h[3];
+
+  if (flags & GZ_FEXTRA) {
+    int lo = nextIn(), hi = nextIn();
+    if (lo < 0 || hi < 0) return false;
+    for (int n = lo | (hi << 8); n > 0; n--) {
+      if (nextIn() < 0) return false;
+    }
+  }
+  for (uint8_t field : { GZ_FNAME, GZ_FCOMMENT }) {
+    if (!(flags & field)) continue;
+    int c;
+    do {
+      c = nextIn();
+    } while (c > 0);
+    if (c < 0) return false;
+  }
+  if ((flags & GZ_FHCRC) && (nextIn() < 0 || nextIn() < 0)) return false;
+  return true;
+}
+
+// CRC-32 and size of the original data, little-endian
+bool GzipStream::readTrailer() {
+  uint32_t v[2] = { 0, 0 };
+  for (int i = 0; i < 8; i++) {
+    int c = nextIn();
+    if (c < 0) return false;
+    v[i / 4] |= (uint32_t)c << (8 * (i % 4));
+  }
+  return v[0] == _crc && v[1] == _produced;
+}
+
+// Runs the inflater until it has output for read(); false at the end
+bool GzipStream::inflateMore() {
+  if (!_headerRead) {
+    _headerRead = true;
+    if (!readHeader()) {
+      fail("not a gzip body");
+      return false;
+    }
+  }
+
+  tinfl_decompressor* decomp = (tinfl_decompressor*)_decomp;
+  while (!_done) {
+    // Input left over from the last call first, then whatever arrives
+    if (_inPos == _inLen && !_inEnd) {
+      int c = nextIn();
+      if (c >= 0) _inPos--;   // keep it in the buffer for the inflater
+    }
+
+    size_t inSize = _inLen - _inPos;
+    size_t outSize = TINFL_LZ_DICT_SIZE - _windowPos;
+    uint32_t t0 = micros();
+    tinfl_status status = tinfl_decompress(decomp, _inBuf + _inPos, &inSize, _window, _window + _windowPos,
+                                           &outSize, _inEnd ? 0 : TINFL_FLAG_HAS_MORE_INPUT);
+    _inflateUs += micros() - t0;
+    _inPos += inSize;
+
+    if (outSize) {
+      _outPos = _windowPos;
+      _outEnd = _windowPos + outSize;
+      _windowPos = (_windowPos + outSize) & (TINFL_LZ_DICT_SIZE - 1);
+      _crc = esp_rom_crc32_le(_crc, _window + _outPos, outSize);
+      _produced += outSize;
+    }
+
+    if (status == TINFL_STATUS_DONE) {
+      _done = true;
+      _complete = readTrailer();
+      if (!_complete) Serial.println("gzip: trailer missing or CRC mismatch");
+    } else if (status < 0 || (status == TINFL_STATUS_NEEDS_MORE_INPUT && _inEnd)) {
+      fail(status < 0 ? "corrupt deflate data" : "body ended early");
+      return false;
+    }
+    if (outSize) return true;
+  }
+  return false;
+}
+
+int GzipStream::read() {
+  if (_outPos == _outEnd && !inflateMore()) return -1;
+  return _window[_outPos++];
+}
+
+int GzipStream::peek() {
+  if (_outPos == _outEnd && !inflateMore()) return -1;
+  return _window[_outPos];
+}
+
+int GzipStream::available() {
+  if (_outPos < _outEnd) return (int)(_outEnd - _outPos);
+  return (!_done && _in && _in->available() > 0) ? 1 : 0;
+}
@@ -0,0 +1,430 @@
+#include <Arduino.h>
+
+#include "dns_cache.h"
+#include "http_session.h"
+
+static const uint32_t HTTP_TIMEOUT_MS = 8000;
+
+// Blocking single-byte read with timeout; -1 on timeout or closed socket
+static int readByte(Client& in, uint32_t timeoutMs) {
+  uint32_t start = millis();
+  while (true) {
+    int c = in.read();
+    if (c >= 0) return c;
+    if (!in.connected() && in.available() <= 0) return -1;
+    if (millis() - start > timeoutMs) return -1;
+    delay(1);
+  }
+}
+
+static int hexValue(int c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// Path without the query string, so API keys stay out of the log
+static void printPath(const char* path) {
+  const char* q = strchr(path, '?');
+  Serial.write((const uint8_t*)path, q ? (size_t)(q - path) : strlen(path));
+}
+
+// RFC 7231 IMF-fixdate, "Sun, 06 Nov 1994 08:49:37 GMT" -> Unix time.
+// Done by hand: mktime() would apply the local TZ set for the display.
+static time_t parseHttpDate(const char* s) {
+  static const char MONTHS[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+  char mon[4];
+  int day, year, hh, mm, ss;
+  if (sscanf(s, "%*3s, %d %3s %d %d:%d:%d", &day, mon, &year, &hh, &mm, &ss) != 6) return 0;
+  const char* m = strstr(MONTHS, mon);
+  if (!m || (m - MONTHS) % 3 != 0 || year < 2020) return 0;
+  int month = (m - MONTHS) / 3 + 1;
+
+  // Days since 1970-01-01 (Howard Hinnant's days_from_civil)
+  int y = year - (month <= 2);
+  int era = y / 400;
+  int yoe = y - era * 400;
+  int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  int32_t days = era * 146097 + doe - 719468;
+  return (time_t)days * 86400 + hh * 3600 + mm * 60 + ss;
+}
+
+// ---------------- Body stream ----------------
+void HttpBodyStream::begin(Client* in, int32_t length, bool chunked, uint32_t timeoutMs) {
+  _in = in;
+  _chunked = chunked;
+  _chunkOpen = false;
+  _remaining = chunked ? 0 : length;
+  _done = (!chunked && length == 0);
+  _complete = _done;
+  _peeked = -1;
+  _consumed = 0;
+  _waitMs = 0;
+  _timeoutMs = timeoutMs;
+  setTimeout(timeoutMs);
+}
+
+// Only the slow path reads the clock, buffered bytes cost nothing extra
+int HttpBodyStream::readRaw() {
+  int c = _in->read();
+  if (c >= 0) return c;
+  uint32_t t0 = millis();
+  c = readByte(*_in, _timeoutMs);
+  _waitMs += millis() - t0;
+  return c;
+}
+
+// Reads the next chunk header; false at the terminating chunk or on error
+bool HttpBodyStream::nextChunk() {
+  if (_chunkOpen) {
+    // CRLF that closes the previous chunk's data
+    if (readRaw() != '\r' || readRaw() != '\n') return false;
+  }
+  _chunkOpen = true;
+
+  int32_t size = 0;
+  int digits = 0;
+  bool extension = false;
+  while (true) {
+    int c = readRaw();
+    if (c < 0) return false;
+    if (c == '\n') break;
+    if (c == '\r' || extension) continue;
+    if (c == ';') { extension = true; continue; }
+    int v = hexValue(c);
+    if (v < 0) return false;
+    size = size * 16 + v;
+    digits++;
+  }
+  if (digits == 0) return false;
+
+  if (size == 0) {
+    // Last chunk: skip optional trailers up to the empty line
+    int lineLen = 0;
+    while (true) {
+      int c = readRaw();
+      if (c < 0) return false;
+      if (c == '\n') {
+        if (lineLen == 0) break;
+        lineLen = 0;
+      } else if (c != '\r') {
+        lineLen++;
+      }
+    }
+    _complete = true;
+    return false;
+  }
+
+  _remaining = size;
+  return true;
+}
+
+int HttpBodyStream::read() {
+  if (_peeked >= 0) {
+    int c = _peeked;
+    _peeked = -1;
+    return c;
+  }
+  if (_done) return -1;
+
+  if (_chunked && _remaining == 0 && !nextChunk()) {
+    _done = true;
+    return -1;
+  }
+
+  int c = readRaw();
+  if (c < 0) {
+    // End of an until-close body is the only clean way to get here
+    _done = true;
+    _complete = (_remaining < 0);
+    return -1;
+  }
+  _consumed++;
+
+  if (_remaining > 0 && --_remaining == 0 && !_chunked) {
+    _done = true;
+    _complete = true;
+  }
+  return c;
+}
+
+int HttpBodyStream::peek() {
+  if (_peeked < 0) _peeked = read();
+  return _peeked;
+}
+
+int HttpBodyStream::available() {
+  if (_peeked >= 0) return 1;
+  if (_done) return 0;
+  int a = _in->available();
+  if (!_chunked && _remaining >= 0 && a > _remaining) a = _remaining;
+  if (_chunked && a > 0) a = 1; // framing bytes may follow, promise only one
+  return a;
+}
+
+// ---------------- Session ----------------
+HttpSession::HttpSession(const char* host, uint16_t port)
+  : _host(host), _port(port) {}
+
+bool HttpSession::connect() {
+  _client.stop();
+  uint32_t t0 = millis();
+  IPAddress ip;
+  bool cached = false;
+  bool resolved = dnsResolve(_host, ip, &cached);
+  bool ok = resolved ? _client.connect(_host, ip, _port) : _client.connect(_host, _port);
+  if (!ok && cached) {
+    // The host may have moved since the address was cached
+    dnsForget(_host);
+    resolved = dnsResolve(_host, ip);
+    ok = resolved ? _client.connect(_host, ip, _port) : _client.connect(_host, _port);
+  }
+  if (!ok) {
+    Serial.printf("HTTP: connect to %s failed\n", _host);
+    return false;
+  }
+  _handshakeMs = millis() - t0;
+  _reusable = true;
+  const TlsHandshakeStats& hs = _client.handshakeStats();
+  Serial.printf("HTTP: TLS connection to %s in %lu ms (%s handshake, %lu B out / %lu B in)\n", _host,
+                (unsigned long)_handshakeMs, hs.resumed ? "resumed" : "full", (unsigned long)hs.bytesOut,
+                (unsigned long)hs.bytesIn);
+  return true;
+}
+
+bool HttpSession::writeRequest(const char* path, const char* headers) {
+  // One write -> one TLS record
+  FixedString<HTTP_MAX_PATH + HTTP_MAX_HEADERS + 160> req;
+  req += "GET ";
+  req += path;
+  req += " HTTP/1.1\r\nHost: ";
+  req += _host;
+  req += "\r\nUser-Agent: ESP32-ePaper\r\nAccept: application/json\r\nConnection: keep-alive\r\n";
+  if (_gzip.reserve()) req += "Accept-Encoding: gzip\r\n";
+  req += headers;
+  req += "\r\n";
+  return _client.write((const uint8_t*)req.c_str(), req.length()) == req.length();
+}
+
+bool HttpSession::send(const char* path, const char* headers) {
+  if (_pendingCount == MAX_PENDING) {
+    Serial.println("HTTP: too many pipelined requests");
+    return false;
+  }
+  if (!headers) headers = "";
+  if (strlen(path) > HTTP_MAX_PATH - 1 || strlen(headers) > HTTP_MAX_HEADERS - 1) {
+    Serial.println("HTTP: request too long");
+    return false;
+  }
+
+  // Only (re)connect when nothing is in flight; otherwise receive()
+  // re-sends the queue if the current connection turns out to be dead.
+  if (_pendingCount == 0 && !_inBody && (!_reusable || !_client.connected())) {
+    if (!connect()) return false;
+  }
+
+  _pending[_pendingCount] = path;
+  _pendingHeaders[_pendingCount] = headers;
+  _sentAt[_pendingCount] = millis();
+  _pendingCount++;
+
+  if (!writeRequest(path, headers)) _reusable = false;
+  return true;
+}
+
+bool HttpSession::resendPending() {
+  if (!connect()) return false;
+  for (int i = 0; i < _pendingCount; i++) {
+    _sentAt[i] = millis();
+    if (!writeRequest(_pending[i].c_str(), _pendingHeaders[i].c_str())) return false;
+  }
+  return true;
+}
+
+void HttpSession::popPending() {
+  _current = _pending[0];
+  for (int i = 1; i < _pendingCount; i++) {
+    _pending[i - 1] = _pending[i];
+    _pendingHeaders[i - 1] = _pendingHeaders[i];
+    _sentAt[i - 1] = _sentAt[i];
+  }
+  _pendingCount--;
+}
+
+int HttpSession::receive() {
+  if (_inBody) skipBody();
+  if (_pendingCount == 0) return -1;
+
+  _stats = HttpStats();
+
+  // Server closed after the previous response: pipelined requests were lost
+  bool resent = false;
+  if (!_reusable) {
+    resent = true;
+    if (!resendPending()) {
+      popPending();
+      return -1;
+    }
+  }
+
+  int code = readHeaders();
+  if (code < 0 && !resent) {
+    Serial.println("HTTP: connection lost, re-sending on a new connection");
+    if (resendPending()) code = readHeaders();
+  }
+
+  uint32_t sentAt = _sentAt[0];
+  popPending();
+  if (code < 0) {
+    _reusable = false;
+    return -1;
+  }
+
+  _stats.connectMs = _handshakeMs;
+  _handshakeMs = 0;
+  _stats.ttfbMs = _headersAt - sentAt;
+  _inBody = true;
+  return code;
+}
+
+Stream& HttpSession::body() {
+  if (_gzipBody) return _gzip;
+  return _body;
+}
+
+// What the parser left of a gzip body is inflated too (a few closing
+// brackets, usually), so the trailer's CRC and length get checked
+bool HttpSession::skipBody() {
+  if (!_inBody) return true;
+  if (_gzipBody) {
+    while (_gzip.read() >= 0) {}
+  }
+  while (_body.read() >= 0) {}
+  return finishResponse();
+}
+
+bool HttpSession::finishResponse() {
+  _inBody = false;
+  _stats.bodyMs = millis() - _headersAt;
+  _stats.waitMs = _body.waitMs();
+  _stats.bodyBytes = _body.consumed();
+  _stats.plainBytes = _gzipBody ? _gzip.produced() : _stats.bodyBytes;
+  _stats.inflateMs = _gzipBody ? _gzip.inflateMs() : 0;
+  if (!_body.complete()) _reusable = false;
+
+  _totals.connectMs += _stats.connectMs;
+  _totals.ttfbMs += _stats.ttfbMs;
+  _totals.bodyMs += _stats.bodyMs;
+  _totals.waitMs += _stats.waitMs;
+  _totals.bodyBytes += _stats.bodyBytes;
+  _totals.plainBytes += _stats.plainBytes;
+  _totals.inflateMs += _stats.inflateMs;
+
+  Serial.print("HTTP ");
+  printPath(_current.c_str());
+  Serial.printf(": connect %lu ms, ttfb %lu ms, body %lu B in %lu ms (%lu ms waiting)",
+                (unsigned long)_stats.connectMs, (unsigned long)_stats.ttfbMs,
+                (unsigned long)_stats.bodyBytes, (unsigned long)_stats.bodyMs,
+                (unsigned long)_stats.waitMs);
+  if (_gzipBody) {
+    Serial.printf(", gzip -> %lu B, %lu ms inflating", (unsigned long)_stats.plainBytes,
+                  (unsigned long)_stats.inflateMs);
+  }
+  Serial.println();
+
+  if (!_body.complete()) {
+    Serial.println("HTTP body cut short");
+    return false;
+  }
+  if (_gzipBody && !_gzip.complete()) {
+    Serial.println("HTTP body failed the gzip check");
+    return false;
+  }
+  return true;
+}
+
+time_t HttpSession::serverTime() const {
+  if (!_date) return 0;
+  return _date + (time_t)((millis() - _dateAt) / 1000);
+}
+
+void HttpSession::close() {
+  if (_inBody) skipBody();
+  _pendingCount = 0;
+  _client.stop();
+}
+
+bool HttpSession::readLine(char* buf, size_t len) {
+  size_t n = 0;
+  while (true) {
+    int c = readByte(_client, HTTP_TIMEOUT_MS);
+    if (c < 0) return false;
+    if (c == '\n') break;
+    if (c == '\r') continue;
+    if (n < len - 1) buf[n++] = (char)c; // overlong header lines are truncated
+  }
+  buf[n] = '\0';
+  return true;
+}
+
+int HttpSession::readHeaders() {
+  char line[256];
+  if (!readLine(line, sizeof(line))) return -1;
+  if (strncmp(line, "HTTP/1.", 7) != 0 || strlen(line) < 12) return -1;
+
+  int code = atoi(line + 9);
+  bool keepAlive = (line[7] == '1'); // HTTP/1.1 keeps the connection by default
+  bool chunked = false;
+  bool gzip = false;
+  int32_t length = -1;
+  _etag[0] = '\0';
+  _lastModified[0] = '\0';
+
+  while (true) {
+    if (!readLine(line, sizeof(line))) return -1;
+    if (line[0] == '\0') break;
+
+    char* colon = strchr(line, ':');
+    if (!colon) continue;
+    *colon = '\0';
+    const char* value = colon + 1;
+    while (*value == ' ') value++;
+
+    if (strcasecmp(line, "Content-Length") == 0) {
+      length = atol(value);
+    } else if (strcasecmp(line, "Transfer-Encoding") == 0) {
+      chunked = (strncasecmp(value, "chunked", 7) == 0);
+    } else if (strcasecmp(line, "Content-Encoding") == 0) {
+      gzip = (strncasecmp(value, "gzip", 4) == 0);
+    } else if (strcasecmp(line, "Connection") == 0) {
+      keepAlive = (strncasecmp(value, "close", 5) != 0);
+    } else if (strcasecmp(line, "ETag") == 0) {
+      if (strlen(value) < sizeof(_etag)) strcpy(_etag, value);
+    } else if (strcasecmp(line, "Last-Modified") == 0) {
+      if (strlen(value) < sizeof(_lastModified)) strcpy(_lastModified, value);
+    } else if (strcasecmp(line, "Date") == 0) {
+      time_t date = parseHttpDate(value);
+      if (date) {
+        _date = date;
+        _dateAt = millis();
+      }
+    }
+  }
+  _headersAt = millis();
+
+  // No body for these, whatever the headers say
+  if (code == 204 || code == 304 || (code >= 100 && code < 200)) {
+    length = 0;
+    chunked = false;
+  }
+  if (chunked) length = -1;
+  if (!chunked && length < 0) keepAlive = false; // body runs until close
+  if (!keepAlive) _reusable = false;
+
+  _body.begin(&_client, length, chunked, HTTP_TIMEOUT_MS);
+  _gzipBody = gzip && length != 0;
+  if (_gzipBody) _gzip.begin(&_body);
+  return code;
+}
@@ -1,18 +1,36 @@
 #include <Arduino.h>
 #include <SPI.h>
 #include <WiFi.h>
-#include <WiFiClientSecure.h>
-#include <HTTPClient.h>
 #include <Preferences.h>
 #include <time.h>
+#include <esp_sntp.h>
+#include <esp_random.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include <driver/uart.h>
 
 #include <WiFiManager.h>     // tzapu
-#include <ArduinoJson.h>     // bblanchon
 
-#include <GxEPD2_BW.h>
-#include <Fonts/FreeMonoBold9pt7b.h>
-#include <Fonts/FreeMonoBold12pt7b.h>
-#include <Fonts/FreeMonoBold18pt7b.h>
+#include <GxEPD2.h>
+#include <epd/GxEPD2_213_BN.h>
+
+#include "weather.h"
+#include "fixed_string.h"
+#include "framebuffer.h"
+#include "weather_render.h"
+#include "frame_diff.h"
+#include "http_session.h"
+#include "weather_cache.h"
+#include "wake_trace.h"
+#include "wifi_fast.h"
+#include "clock_sync.h"
+#include "background_job.h"
+#include "wake_scheduler.h"
+#include "settings_store.h"
+#include "event_queue.h"
+#include "weather_history.h"
+#include "dns_cache.h"
+#include "busy_wait.h"
 
 //static const bool FORCE_CLEAR_SETTINGS = true;
 
@@ -23,48 +41,71 @@ static const int PIN_CS   = 10;
 static const int PIN_DC   = 2;
 static const int PIN_RST  = 3;
 static const int PIN_BUSY = 4;
+static const int PIN_BUTTON = 9;   // BOOT button, active low: update now (always-on mode)
 
 // ===== Display: 2.13" B/W =====
-GxEPD2_BW<GxEPD2_213_BN, GxEPD2_213_BN::HEIGHT> display(
-  GxEPD2_213_BN(PIN_CS, PIN_DC, PIN_RST, PIN_BUSY)
-);
-
-// ===== Storage =====
-Preferences prefs;
-
-// ===== Settings saved in NVS =====
-static String g_apiKey;
-static String g_cityQuery; // e.g. "Beer Sheva,IL"
-static String g_units = "metric"; // "metric" or "imperial"
-static uint32_t g_updateIntervalHours = 12; // Default 12 hours
+// Everything is drawn into `frame`; the panel driver is used directly so
+// only the part that changed since the last wake has to be refreshed.
+GxEPD2_213_BN epd(PIN_CS, PIN_DC, PIN_RST, PIN_BUSY);
+static FrameBuffer frame;
+static_assert(FRAME_WIDTH == GxEPD2_213_BN::WIDTH && FRAME_HEIGHT == GxEPD2_213_BN::HEIGHT,
+              "frame buffer must match the panel's native size");
+
+// ===== Partial refresh policy =====
+static const int MAX_DIRTY_RECTS = 6;             // Diff bands kept per refresh
+static const uint8_t PARTIAL_MAX_DIRTY_PERCENT = 35; // Bigger diffs get a full refresh
+
+// Last frame pushed to the panel, kept in RTC memory across deep sleep
+static const uint32_t FRAME_MAGIC = 0x46445045; // "EPDF"
+static RTC_DATA_ATTR uint32_t g_lastFrameMagic = 0;
+static RTC_DATA_ATTR uint16_t g_partialsSinceFull = 0;
+static RTC_DATA_ATTR uint8_t g_lastFrame[FRAME_BYTES];
+
+// Which view the panel shows (PanelView), so unchanged data doesn't even get redrawn
+static RTC_DATA_ATTR uint8_t g_lastView = VIEW_NONE;
+
+// What the panel shows, so a reading within the refresh delta is skipped
+static RTC_DATA_ATTR bool g_shownValid = false;
+static RTC_DATA_ATTR ShownReading g_shown;
+static RTC_DATA_ATTR uint32_t g_shownAt = 0;
+
+// Multi-location: page the next wake shows (0 = home city, then one per
+// extra location)
+static RTC_DATA_ATTR uint8_t g_nextPage = 0;
+
+// Failed fetches in a row, for the retry backoff
+static RTC_DATA_ATTR uint8_t g_fetchFailures = 0;
+
+// Previous fetched temperature, for the observed rate of change
+static RTC_DATA_ATTR float g_prevTemp = NAN;
+static RTC_DATA_ATTR uint32_t g_prevTempAt = 0;
+
+// ===== Settings (NVS blob, see settings_store.h) =====
+static FixedString<65> g_apiKey;
+static FixedString<65> g_cityQuery;         // e.g. "Beer Sheva,IL"
+static FixedString<10> g_units = "metric";  // "metric" or "imperial"
+static FixedString<200> g_cityIds;          // extra locations: OpenWeather city IDs, comma separated
+static uint32_t g_updateIntervalHours = 12; // Default 12 hours; longest sleep in stable weather
+static uint16_t g_minIntervalMin = 30;      // Shortest sleep when the weather changes fast (minutes)
+static float g_refreshDeltaC = 0.5f;        // Smaller temperature changes don't refresh the panel
 static uint8_t g_nightModeStartHour = 20;   // Night mode starts at 20:00 (8 PM)
 static uint8_t g_nightModeEndHour = 7;      // Night mode ends at 07:00 (7 AM)
 static int16_t g_timezoneOffset = 0;        // Timezone offset in hours (e.g., 2 for UTC+2)
 static bool g_enableDeepSleep = false;      // Enable/disable deep sleep (controlled by user)
-static int16_t g_timezoneOffset = 0;        // Timezone offset in hours (e.g., 2 for UTC+2)
-static bool g_enableDeepSleep = false;      // Enable/disable deep sleep (controlled by user)
+static uint8_t g_maxPartialRefreshes = 10;  // Partial refreshes allowed before a full one (ghosting budget)
+static uint16_t g_weatherTtlMin = 10;       // Cached current weather is reused this long (minutes)
+static uint16_t g_forecastTtlMin = 180;     // Cached forecast is reused this long (minutes)
+static bool g_wifiStaticIp = false;         // Warm wakes reuse the last DHCP lease instead of asking again
+static uint16_t g_rotateMin = 15;           // Multi-location: longest a page stays up (minutes)
 
-// ===== Weather data =====
-struct WeatherData {
-  float temp = NAN;
-  float tempMin = NAN;
-  float tempMax = NAN;
-  float feelsLike = NAN;       // "feels like" temperature
-  int weatherId = -1;          // OpenWeather "id" code
-  String main;                 // "Clear", "Clouds", ...
-  String description;          // "few clouds"
-  String iconCode;             // Icon code from API (e.g., "01d", "02n")
-  unsigned long timestamp = 0; // Unix timestamp of data retrieval
-};
+static size_t g_locationCount = 0;          // IDs in g_cityIds
+static uint8_t g_page = 0;                  // page shown by this wake
+static FixedString<65> g_headerCity;        // location name in the chrome's header
+static bool g_stale = false;                // this wake shows last-good data after a failed fetch
+static bool g_clockTrimmed = false;         // this wake already took a Date header
 
-// ===== Forecast data for tomorrow =====
-struct ForecastData {
-  float tempMin = NAN;         // Tomorrow min temp
-  float tempMax = NAN;         // Tomorrow max temp
-  int weatherId = -1;          // Tomorrow weather ID
-  String main;                 // Tomorrow weather main
-  String iconCode;             // Tomorrow icon code
-};
+// Last-good records are copied to flash at most this often (RTC keeps the latest)
+static const uint32_t LAST_GOOD_FLASH_EVERY_S = 6 * 3600UL;
 
 static const char* OW_HOST = "api.openweathermap.org";
 
@@ -82,305 +123,229 @@ static bool isNightMode() {
   }
 }
 
-// ---------------- Vector icons (simple, B/W) ----------------
-static void drawSun(int cx, int cy) {
-  display.drawCircle(cx, cy, 12, GxEPD_BLACK);
-  for (int a = 0; a < 360; a += 30) {
-    float r = radians((float)a);
-    int x1 = cx + (int)(cos(r) * 16);
-    int y1 = cy + (int)(sin(r) * 16);
-    int x2 = cx + (int)(cos(r) * 24);
-    int y2 = cy + (int)(sin(r) * 24);
-    display.drawLine(x1, y1, x2, y2, GxEPD_BLACK);
+// ---------------- Panel refresh ----------------
+// Diff the finished frame against what the panel already shows and use the
+// cheapest refresh that keeps ghosting in check: nothing when unchanged, a
+// partial window for small diffs, a full refresh for big diffs, cold boots
+// or once the partial budget is used up.
+static void presentFrame() {
+  PhaseTimer timer(PHASE_PANEL);
+  uint32_t slept0 = busyWaitSleptMs();
+  uint32_t blocked0 = busyWaitBlockedMs();
+  const uint8_t* next = frame.getBuffer();
+  const uint32_t frameArea = (uint32_t)FRAME_WIDTH * FRAME_HEIGHT;
+  bool havePrev = (g_lastFrameMagic == FRAME_MAGIC);
+
+  DirtyRect rects[MAX_DIRTY_RECTS];
+  int count = 0;
+  uint32_t area = frameArea;
+  if (havePrev) {
+    count = computeDirtyRects(g_lastFrame, next, FRAME_WIDTH, FRAME_HEIGHT, rects, MAX_DIRTY_RECTS);
+    area = dirtyArea(rects, count);
   }
-}
-
-static void drawCloud(int x, int y) {
-  display.fillCircle(x + 16, y + 18, 12, GxEPD_BLACK);
-  display.fillCircle(x + 34, y + 14, 16, GxEPD_BLACK);
-  display.fillCircle(x + 52, y + 18, 12, GxEPD_BLACK);
-  display.fillRect  (x + 16, y + 18, 36, 18, GxEPD_BLACK);
-}
 
-static void drawCenteredText(int y, const String& text, const GFXfont* font) {
-  display.setFont(font);
-  int16_t x1, y1;
-  uint16_t w, h;
-  display.getTextBounds(text, 0, y, &x1, &y1, &w, &h);
-  int x = (display.width() - w) / 2 - x1;
-  display.setCursor(x, y);
-  display.print(text);
-}
+  if (havePrev && count == 0) {
+    Serial.println("Display: frame unchanged, no refresh");
+    epd.hibernate();
+    traceAdd(PHASE_PANEL_BUSY, busyWaitSleptMs() - slept0);
+    return;
+  }
 
-static void drawRain(int x, int y) {
-  drawCloud(x, y);
-  for (int i = 0; i < 3; i++) {
-    int rx = x + 22 + i * 14;
-    display.drawLine(rx, y + 42, rx - 4, y + 54, GxEPD_BLACK);
+  uint32_t dirtyPercent = area * 100 / frameArea;
+  bool full = !havePrev ||
+              g_partialsSinceFull >= g_maxPartialRefreshes ||
+              dirtyPercent > PARTIAL_MAX_DIRTY_PERCENT;
+
+  unsigned long t0 = millis();
+  if (full) {
+    epd.writeImageForFullRefresh(next, 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+    epd.refresh(false);
+    epd.writeImageAgain(next, 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+    g_partialsSinceFull = 0;
+  } else {
+    // Controller RAM is not trusted across hibernate + deep sleep, so load
+    // the old image from our copy, then only the changed bands of the new one.
+    epd.writeImageForFullRefresh(g_lastFrame, 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+    for (int i = 0; i < count; i++) {
+      const DirtyRect& r = rects[i];
+      epd.writeImagePart(next, r.x, r.y, FRAME_WIDTH, FRAME_HEIGHT, r.x, r.y, r.w, r.h);
+    }
+    DirtyRect b = dirtyBounds(rects, count);
+    epd.refresh(b.x, b.y, b.w, b.h);
+    epd.writeImageAgain(next, 0, 0, FRAME_WIDTH, FRAME_HEIGHT);
+    g_partialsSinceFull++;
   }
+  traceFlag(full ? WAKE_FULL_REFRESH : WAKE_PARTIAL);
+  Serial.printf("Display: %s refresh, %d rect(s), %u%% dirty, %lu ms, waiting on BUSY %lu ms asleep + "
+                "%lu ms blocked (partials since full: %u/%u)\n",
+                full ? "full" : "partial", count, dirtyPercent, millis() - t0,
+                (unsigned long)(busyWaitSleptMs() - slept0), (unsigned long)(busyWaitBlockedMs() - blocked0),
+                g_partialsSinceFull, g_maxPartialRefreshes);
+
+  memcpy(g_lastFrame, next, FRAME_BYTES);
+  g_lastFrameMagic = FRAME_MAGIC;
+
+  // Light sleep only: a blocked wait leaves the CPU running other tasks,
+  // so it stays in the panel's awake time
+  epd.hibernate();
+  traceAdd(PHASE_PANEL_BUSY, busyWaitSleptMs() - slept0);
 }
 
-static String urlEncodeCity(String s) {
-  s.replace(" ", "%20");
-  return s;
-}
+// ---------------- Screen layouts (weather_render.h) ----------------
+static ViewChrome g_chrome;   // chrome `frame` holds, and where its labels end
 
-static void drawStorm(int x, int y) {
-  drawCloud(x, y);
-  // lightning bolt
-  display.fillTriangle(x + 34, y + 36, x + 24, y + 56, x + 38, y + 56, GxEPD_BLACK);
-  display.fillTriangle(x + 38, y + 56, x + 30, y + 72, x + 48, y + 52, GxEPD_BLACK);
-}
+// ---------------- Boot pipeline ----------------
+// Panel reset/init and the chrome of the view the wake will most likely
+// show run in a background job while setup() brings WiFi up and fetches.
+// Whoever needs `epd` or `frame` next joins it first.
+static BackgroundJob g_panelJob;
+
+struct PanelPrep {
+  bool panelKnown;      // warm wake with a known panel image: no initial refresh
+  uint8_t view;         // chrome to pre-draw
+};
+static PanelPrep g_panelPrep;
 
-static void drawSnow(int x, int y) {
-  drawCloud(x, y);
-  for (int i = 0; i < 3; i++) {
-    int sx = x + 22 + i * 14;
-    int sy = y + 48;
-    display.drawLine(sx - 4, sy, sx + 4, sy, GxEPD_BLACK);
-    display.drawLine(sx, sy - 4, sx, sy + 4, GxEPD_BLACK);
-    display.drawLine(sx - 3, sy - 3, sx + 3, sy + 3, GxEPD_BLACK);
-    display.drawLine(sx - 3, sy + 3, sx + 3, sy - 3, GxEPD_BLACK);
+static void preparePanel(void* arg) {
+  const PanelPrep* prep = (const PanelPrep*)arg;
+  {
+    PhaseTimer t(PHASE_DISPLAY_INIT);
+    epd.init(115200, !prep->panelKnown, 50, false);
   }
+  PhaseTimer t(PHASE_RENDER);
+  if (prep->view == VIEW_SPLIT) drawSplitChrome(frame, g_headerCity.c_str(), g_chrome);
+  else                          drawDetailChrome(frame, g_headerCity.c_str(), g_chrome);
 }
 
-static void drawMist(int x, int y) {
-  // simple fog lines
-  display.drawLine(x, y + 18, x + 70, y + 18, GxEPD_BLACK);
-  display.drawLine(x + 8, y + 30, x + 62, y + 30, GxEPD_BLACK);
-  display.drawLine(x, y + 42, x + 70, y + 42, GxEPD_BLACK);
+static void startPanelPrep(bool panelKnown, uint8_t view) {
+  g_panelPrep.panelKnown = panelKnown;
+  g_panelPrep.view = view;
+  g_panelJob.start("panelPrep", preparePanel, &g_panelPrep);
 }
 
-static void drawWeatherIcon(int x, int y, const String& iconCode, int weatherId, const String& main) {
-  // Icon code mapping from OpenWeather API
-  // Always use night icons per user preference (ignore day/night suffix)
-  // Icon codes: 01=clear, 02=few clouds, 03=scattered, 04=broken, 09=shower rain,
-  //             10=rain, 11=thunderstorm, 13=snow, 50=mist
-  
-  if (iconCode.length() >= 2) {
-    String baseIcon = iconCode.substring(0, 2);
-    
-    if (baseIcon == "01") { drawSun(x + 36, y + 28); return; }        // Clear
-    if (baseIcon == "02") { drawCloud(x, y); return; }                // Few clouds
-    if (baseIcon == "03") { drawSnow(x, y); return; }                 // Scattered clouds -> Snow per user request
-    if (baseIcon == "04") { drawCloud(x, y); return; }                // Broken clouds
-    if (baseIcon == "09") { drawRain(x, y); return; }                 // Shower rain
-    if (baseIcon == "10") { drawRain(x, y); return; }                 // Rain
-    if (baseIcon == "11") { drawStorm(x, y); return; }                // Thunderstorm
-    if (baseIcon == "13") { drawSnow(x, y); return; }                 // Snow
-    if (baseIcon == "50") { drawMist(x, y); return; }                 // Mist
-  }
-  
-  // Fallback to weather ID based drawing
-  if (weatherId >= 200 && weatherId < 300) { drawStorm(x, y); return; }
-  if (weatherId >= 300 && weatherId < 600) { drawRain(x, y);  return; }
-  if (weatherId >= 600 && weatherId < 700) { drawSnow(x, y);  return; }
-  if (weatherId >= 700 && weatherId < 800) { drawMist(x, y);  return; }
-  if (weatherId == 800) { drawSun(x + 36, y + 28); return; }
-  if (weatherId > 800 && weatherId < 900) { drawCloud(x, y); return; }
-  
-  // Final fallback
-  if (main == "Clear") drawSun(x + 36, y + 28);
-  else if (main == "Clouds") drawCloud(x, y);
-  else if (main == "Rain" || main == "Drizzle") drawRain(x, y);
-  else if (main == "Thunderstorm") drawStorm(x, y);
-  else if (main == "Snow") drawSnow(x, y);
-  else drawMist(x, y);
-}
-
-static void renderWeather(const WeatherData& w) {
-  display.setRotation(1);
-  display.setFullWindow();
-
-  // Prepare strings (with decimals)
-  String tempNow = "--.-";
-  String tMin = "--.-";
-  String tMax = "--.-";
-  String feelsLike = "--.-";
-
-  if (!isnan(w.temp))      tempNow = String(w.temp, 1);
-  if (!isnan(w.tempMin))   tMin    = String(w.tempMin, 1);
-  if (!isnan(w.tempMax))   tMax    = String(w.tempMax, 1);
-  if (!isnan(w.feelsLike)) feelsLike = String(w.feelsLike, 1);
-
-  // Format timestamp
-  String timeStr = "--:--";
-  String dateStr = "--/--";
-  if (w.timestamp > 0) {
-    time_t t = w.timestamp;
-    struct tm* tm_info = localtime(&t);
-    char timeBuf[16];
-    char dateBuf[16];
-    strftime(timeBuf, sizeof(timeBuf), "%H:%M", tm_info);
-    strftime(dateBuf, sizeof(dateBuf), "%d/%m/%y", tm_info);
-    timeStr = String(timeBuf);
-    dateStr = String(dateBuf);
-  }
-
-  String bigLine = tempNow + "C";
-
-  display.firstPage();
-  do {
-    display.fillScreen(GxEPD_WHITE);
-    display.setTextColor(GxEPD_BLACK);
-
-    // ---- Header ----
-    display.setFont(&FreeMonoBold9pt7b);
-    display.setCursor(8, 16);
-    display.print("Today: ");
-    display.print(g_cityQuery);
-
-    // ---- Timestamp line (under header) ----
-    display.setFont(&FreeMonoBold9pt7b);
-    display.setCursor(8, 32);
-    display.print(dateStr);
-    display.print(" ");
-    display.print(timeStr);
-
-    // small divider line
-    display.drawLine(0, 38, display.width(), 38, GxEPD_BLACK);
-
-    // ---- Icon (right side) ----
-    drawWeatherIcon(display.width() - 66, 42, w.iconCode, w.weatherId, w.main);
-
-    // ---- Big temperature (centered) ----
-    // Keep it away from the icon area by centering but it’s fine visually on 2.13"
-    display.setTextColor(GxEPD_BLACK);
-    drawCenteredText(70, bigLine, &FreeMonoBold18pt7b);
-
-    // ---- Condition line ----
-    display.setFont(&FreeMonoBold12pt7b);
-    // You can use w.description if you want (but it can be long)
-    String cond = (w.main.length() ? w.main : String("Weather"));
-    drawCenteredText(95, cond, &FreeMonoBold12pt7b);
-
-    // ---- Min/Max row ----
-    display.setFont(&FreeMonoBold9pt7b);
-    display.setCursor(10, 118);
-    display.print("Min: ");
-    display.print(tMin);
-    display.print("C");
-
-    display.setCursor(130, 118);
-    display.print("Max: ");
-    display.print(tMax);
-    display.print("C");
-
-  } while (display.nextPage());
-
-  display.hibernate();
-}
-
-// ===== Split-screen render for night mode =====
-static void renderWeatherSplitScreen(const WeatherData& current, const ForecastData& tomorrow) {
-  display.setRotation(1);
-  display.setFullWindow();
-
-  // Format current temperature
-  String tempNow = "--.-";
-  if (!isnan(current.temp)) tempNow = String(current.temp, 1);
-
-  // Format tomorrow temps
-  String tMin = "--.-";
-  String tMax = "--.-";
-  if (!isnan(tomorrow.tempMin)) tMin = String(tomorrow.tempMin, 1);
-  if (!isnan(tomorrow.tempMax)) tMax = String(tomorrow.tempMax, 1);
-
-  // Format timestamp
-  String timeStr = "--:--";
-  if (current.timestamp > 0) {
-    time_t t = current.timestamp;
-    struct tm* tm_info = localtime(&t);
-    char timeBuf[16];
-    strftime(timeBuf, sizeof(timeBuf), "%H:%M", tm_info);
-    timeStr = String(timeBuf);
-  }
-
-  display.firstPage();
-  do {
-    display.fillScreen(GxEPD_WHITE);
-    display.setTextColor(GxEPD_BLACK);
-
-    // ---- Header ----
-    display.setFont(&FreeMonoBold9pt7b);
-    display.setCursor(8, 16);
-    display.print(g_cityQuery);
-    display.print(" ");
-    display.print(timeStr);
-
-    // ---- Divider line below header ----
-    display.drawLine(0, 22, display.width(), 22, GxEPD_BLACK);
-
-    // ---- CURRENT WEATHER (Left side) ----
-    // Small icon for current weather
-    drawWeatherIcon(8, 28, current.iconCode, current.weatherId, current.main);
-
-    // Current temperature (centered on left half)
-    display.setFont(&FreeMonoBold12pt7b);
-    display.setCursor(12, 90);
-    display.print(tempNow);
-    display.print("C");
-
-    // Current condition
-    display.setFont(&FreeMonoBold9pt7b);
-    display.setCursor(8, 105);
-    String cond = (current.main.length() ? current.main : String("Weather"));
-    display.print(cond);
-
-    // ---- VERTICAL DIVIDER ----
-    int dividerX = display.width() / 2;
-    display.drawLine(dividerX, 28, dividerX, display.height(), GxEPD_BLACK);
-
-    // ---- TOMORROW'S FORECAST (Right side) ----
-    display.setFont(&FreeMonoBold9pt7b);
-    display.setCursor(dividerX + 8, 28);
-    display.print("Tomorrow");
-
-    // Small icon for tomorrow
-    drawWeatherIcon(dividerX + 12, 28, tomorrow.iconCode, tomorrow.weatherId, tomorrow.main);
+static void panelReady() {
+  uint32_t t0 = millis();
+  g_panelJob.join();
+  uint32_t waited = millis() - t0;
+  if (waited > 0) Serial.printf("Display: waited %lu ms for panel prep\n", waited);
+}
 
-    // Tomorrow temps
-    display.setFont(&FreeMonoBold9pt7b);
-    display.setCursor(dividerX + 8, 88);
-    display.print("Min: ");
-    display.print(tMin);
-    display.print("C");
+// Header name for the chrome. Call after panelReady(): a change from the
+// pre-drawn one makes beginView() draw the chrome again.
+static void setHeaderCity(const char* name) {
+  if (g_headerCity == name) return;
+  g_headerCity = name;
+  g_chrome.view = VIEW_NONE;
+}
 
-    display.setCursor(dividerX + 8, 106);
-    display.print("Max: ");
-    display.print(tMax);
-    display.print("C");
+// Chrome for `view`, reusing the pre-drawn one if it matches. Consumed:
+// the data pass draws over it, so a second render starts from scratch.
+static void beginView(uint8_t view) {
+  panelReady();
+  if (g_chrome.view != view) {
+    if (view == VIEW_SPLIT) drawSplitChrome(frame, g_headerCity.c_str(), g_chrome);
+    else                    drawDetailChrome(frame, g_headerCity.c_str(), g_chrome);
+  }
+  g_chrome.view = VIEW_NONE;
+}
 
-  } while (display.nextPage());
+// Data pass over the chrome, then out to the panel
+static void presentWeather(const WeatherData& w) {
+  beginView(VIEW_DETAIL);
+  uint32_t t0 = millis();
+  renderWeather(frame, g_chrome, w, g_stale, g_page == 0);
+  traceAdd(PHASE_RENDER, millis() - t0);
+  presentFrame();
+}
 
-  display.hibernate();
+static void presentSplitScreen(const WeatherData& current, const ForecastData& tomorrow) {
+  beginView(VIEW_SPLIT);
+  uint32_t t0 = millis();
+  renderWeatherSplitScreen(frame, g_chrome, current, tomorrow, g_stale);
+  traceAdd(PHASE_RENDER, millis() - t0);
+  presentFrame();
 }
 
 // ---------------- Preferences helpers ----------------
+// Rewrites `ids` as digits separated by single commas, at most
+// MAX_LOCATIONS of them; anything else separates IDs. Returns the count.
+static size_t normalizeCityIds(StrBuf& ids) {
+  FixedString<200> clean;
+  size_t count = 0;
+  bool inId = false;
+  for (const char* p = ids.c_str(); *p; p++) {
+    if (*p >= '0' && *p <= '9') {
+      if (!inId) {
+        if (count == MAX_LOCATIONS) break;
+        if (count) clean += ',';
+        count++;
+        inId = true;
+      }
+      clean += *p;
+    } else {
+      inId = false;
+    }
+  }
+  ids = clean.c_str();
+  return count;
+}
+
+// One blob read on cold boots, none on warm wakes (RTC mirror)
 static void loadSettings() {
-  prefs.begin("weather", true);
-  g_apiKey = prefs.getString("apiKey", "");     // no default secret
-  g_cityQuery = prefs.getString("city", "Beer Sheva,IL");
-  g_updateIntervalHours = prefs.getUInt("interval", 12); // Default 12 hours
-  g_nightModeStartHour = prefs.getUChar("nightStart", 20); // Default 20:00
-  g_nightModeEndHour = prefs.getUChar("nightEnd", 7);     // Default 07:00
-  g_timezoneOffset = prefs.getShort("tzOffset", 0);       // Default UTC+0
-  g_enableDeepSleep = prefs.getBool("deepSleep", false);  // Default disabled
-  prefs.end();
+  Settings s;
+  SettingsSource src = settingsLoad(s);
+  g_apiKey = s.apiKey;                           // no default secret
+  g_cityQuery = s.city;
+  g_cityIds = s.cityIds;
+  g_updateIntervalHours = s.intervalHours;
+  g_nightModeStartHour = s.nightStartHour;
+  g_nightModeEndHour = s.nightEndHour;
+  g_timezoneOffset = s.tzOffsetHours;
+  g_enableDeepSleep = s.deepSleep;
+  g_maxPartialRefreshes = s.partialMax;
+  g_weatherTtlMin = s.weatherTtlMin;
+  g_forecastTtlMin = s.forecastTtlMin;
+  g_wifiStaticIp = s.wifiStaticIp;
+  g_minIntervalMin = s.minIntervalMin;
+  g_refreshDeltaC = s.refreshDeltaC;
+  g_rotateMin = s.rotateMin;
+  g_locationCount = normalizeCityIds(g_cityIds);
   
-  Serial.printf("Loaded settings - Timezone: UTC%+d, Deep sleep: %s\n", g_timezoneOffset, g_enableDeepSleep ? "ON" : "OFF");
+  Serial.printf("Loaded settings (%s) - Timezone: UTC%+d, Deep sleep: %s\n", settingsSourceName(src),
+                g_timezoneOffset, g_enableDeepSleep ? "ON" : "OFF");
+}
+
+static void saveSettings(const char* apiKey, const char* city, const char* cityIds) {
+  Settings s;
+  settingsDefaults(s);
+  strlcpy(s.apiKey, apiKey, sizeof(s.apiKey));
+  strlcpy(s.city, city, sizeof(s.city));
+  strlcpy(s.cityIds, cityIds, sizeof(s.cityIds));
+  s.intervalHours = g_updateIntervalHours;
+  s.nightStartHour = g_nightModeStartHour;
+  s.nightEndHour = g_nightModeEndHour;
+  s.tzOffsetHours = g_timezoneOffset;
+  s.deepSleep = g_enableDeepSleep;
+  s.partialMax = g_maxPartialRefreshes;
+  s.weatherTtlMin = g_weatherTtlMin;
+  s.forecastTtlMin = g_forecastTtlMin;
+  s.wifiStaticIp = g_wifiStaticIp;
+  s.minIntervalMin = g_minIntervalMin;
+  s.refreshDeltaC = g_refreshDeltaC;
+  s.rotateMin = g_rotateMin;
+  settingsSave(s);
 }
 
-static void saveSettings(const String& apiKey, const String& city) {
-  prefs.begin("weather", false);
-  prefs.putString("apiKey", apiKey);
-  prefs.putString("city", city);
-  prefs.putUInt("interval", g_updateIntervalHours);
-  prefs.putUChar("nightStart", g_nightModeStartHour);
-  prefs.putUChar("nightEnd", g_nightModeEndHour);
-  prefs.putShort("tzOffset", g_timezoneOffset);
-  prefs.putBool("deepSleep", g_enableDeepSleep);
-  prefs.end();
+// Cache and history are keyed on the settings they depend on: the home
+// records on city + units, the other locations on units + their IDs, so
+// editing the ID list keeps the home records
+static void beginCache() {
+  FixedString<80> homeQuery;
+  homeQuery.append(g_cityQuery.c_str()).append('|').append(g_units.c_str());
+  FixedString<216> groupQuery;
+  groupQuery.append(g_units.c_str()).append('|').append(g_cityIds.c_str());
+  cacheBegin(homeQuery.c_str(), groupQuery.c_str());
+  historyBegin(homeQuery.c_str());
 }
 
 // ---------------- WiFi portal + custom params ----------------
@@ -392,9 +357,12 @@ static bool ensureWiFiWithPortal() {
   // Custom fields shown in the portal
   WiFiManagerParameter p_apiKey("apikey", "OpenWeather API Key", g_apiKey.c_str(), 64);
   WiFiManagerParameter p_city("city", "City", g_cityQuery.c_str(), 64);
+  WiFiManagerParameter p_cityIds("cityids", "More locations (OpenWeather city IDs, comma separated)",
+                                 g_cityIds.c_str(), 199);
 
   wm.addParameter(&p_apiKey);
   wm.addParameter(&p_city);
+  wm.addParameter(&p_cityIds);
 
   // If no saved WiFi or connect fails, it starts AP portal
   // AP name: "EPD-Setup"
@@ -406,18 +374,22 @@ static bool ensureWiFiWithPortal() {
   }
 
   // Save custom params (even if WiFi was already configured)
-  String newApiKey = String(p_apiKey.getValue());
-  String newCity   = String(p_city.getValue());
+  FixedString<65> newApiKey(p_apiKey.getValue());
+  FixedString<65> newCity(p_city.getValue());
+  FixedString<200> newCityIds(p_cityIds.getValue());
 
   newApiKey.trim();
   newCity.trim();
-  if (newCity.length() == 0) newCity = "Beer Sheva,IL";
+  if (newCity.empty()) newCity = "Beer Sheva,IL";
 
   // Only save if provided (API key must be non-empty for weather)
-  if (newApiKey.length() > 0) {
-    saveSettings(newApiKey, newCity);
+  if (!newApiKey.empty()) {
+    g_locationCount = normalizeCityIds(newCityIds);
+    saveSettings(newApiKey.c_str(), newCity.c_str(), newCityIds.c_str());
     g_apiKey = newApiKey;
     g_cityQuery = newCity;
+    g_cityIds = newCityIds;
+    beginCache();
   } else {
     // Keep old values if user left blank
     Serial.println("WiFi portal: API key left empty, keeping stored key (if any).");
@@ -428,64 +400,145 @@ static bool ensureWiFiWithPortal() {
   return true;
 }
 
-// ---------------- Weather fetch ----------------
-static bool fetchWeather(WeatherData& out) {
-  if (g_apiKey.length() == 0) {
-    Serial.println("No OpenWeather API key stored. Open portal and set it.");
-    return false;
+// ---------------- WiFi fast path ----------------
+static const uint32_t WIFI_FAST_TIMEOUT_MS = 5000;
+
+// AP joined last time, see wifi_fast.h
+static RTC_DATA_ATTR WifiCache g_wifiCache;
+
+class ArduinoRadio : public WifiRadio {
+public:
+  void begin(const WifiCache& ap, bool staticIp) override {
+    WiFi.persistent(false); // credentials are in NVS already, don't rewrite them
+    WiFi.mode(WIFI_STA);
+    if (staticIp) {
+      WiFi.config(IPAddress(ap.ip), IPAddress(ap.gateway), IPAddress(ap.subnet), IPAddress(ap.dns));
+    }
+    WiFi.begin(ap.ssid, ap.pass, ap.channel, ap.channel ? ap.bssid : nullptr, true);
   }
 
-  // OpenWeather "current weather" endpoint:
-  // https://api.openweathermap.org/data/2.5/weather?q=...&appid=...&units=metric
+  RadioStatus status() override {
+    wl_status_t s = WiFi.status();
+    if (s == WL_CONNECTED) return RADIO_CONNECTED;
+    if (s == WL_CONNECT_FAILED || s == WL_NO_SSID_AVAIL) return RADIO_FAILED;
+    return RADIO_CONNECTING;
+  }
+
+  void stop() override {
+    WiFi.disconnect(true);
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE); // back to DHCP for WiFiManager
+  }
+  uint32_t millis() override { return ::millis(); }
+  void sleep(uint32_t ms) override { delay(ms); }
+};
+
+static void rememberWiFi() {
+  wifiCacheStore(g_wifiCache, WiFi.SSID().c_str(), WiFi.psk().c_str(),
+                 WiFi.BSSID(), WiFi.channel(),
+                 (uint32_t)WiFi.localIP(), (uint32_t)WiFi.gatewayIP(),
+                 (uint32_t)WiFi.subnetMask(), (uint32_t)WiFi.dnsIP());
+}
 
-  String cityEncoded = urlEncodeCity(g_cityQuery);
-  String url = String("https://") + OW_HOST + "/data/2.5/weather?q=" +
-               cityEncoded + "&appid=" + g_apiKey + "&units=" + g_units;
-  Serial.println(url);
+// Warm wakes rejoin the cached AP directly; WiFiManager (and its portal)
+// only runs on cold boots or when that fails.
+static bool connectWiFi() {
+  if (wifiCacheValid(g_wifiCache)) {
+    ArduinoRadio radio;
+    uint32_t t0 = millis();
+    bool ok = wifiFastConnect(radio, g_wifiCache, g_wifiStaticIp, WIFI_FAST_TIMEOUT_MS);
+    WiFi.persistent(true);
+    if (ok) {
+      Serial.printf("WiFi: fast reconnect in %lu ms%s, IP=", millis() - t0,
+                    g_wifiStaticIp ? " (cached lease)" : "");
+      Serial.println(WiFi.localIP());
+      rememberWiFi();
+      return true;
+    }
+    Serial.printf("WiFi: fast reconnect failed after %lu ms, falling back to WiFiManager\n", millis() - t0);
+  }
 
-  WiFiClientSecure client;
-  client.setInsecure(); // simplest: skip cert validation
+  if (!ensureWiFiWithPortal()) return false;
+  rememberWiFi();
+  return true;
+}
 
-  HTTPClient https;
-  if (!https.begin(client, url)) {
-    Serial.println("HTTP begin failed");
+// Before any panel refresh that follows WiFi: with the radio up the BUSY
+// wait can't light-sleep and the CPU stays awake through the refresh
+static void radioOff() {
+  PhaseTimer t(PHASE_SLEEP_ENTRY);
+  WiFi.disconnect(true);
+  WiFi.mode(WIFI_OFF);
+}
+
+// ---------------- Weather fetch ----------------
+// Requests are queued on one HttpSession first and their responses read
+// afterwards, so current weather and forecast share a TLS handshake.
+
+// Dumps a (short) error body such as {"cod":401,"message":"Invalid API key"}
+static void printErrorBody(HttpSession& ow) {
+  Stream& body = ow.body();
+  for (int c = body.read(); c >= 0; c = body.read()) Serial.write((uint8_t)c);
+  Serial.println();
+}
+
+// First response with a Date header corrects the RTC drift, before any
+// record gets timestamped
+static void trimClock(HttpSession& ow) {
+  time_t server = ow.serverTime();
+  if (g_clockTrimmed || !server) return;
+  g_clockTrimmed = true;
+  clockCorrect(server);
+}
+
+// "/data/2.5/<endpoint>?q=<city>&appid=<key>&units=<units>"
+static void buildApiPath(StrBuf& path, const char* endpoint) {
+  path.append("/data/2.5/").append(endpoint);
+  path.append("?q=").appendUrlEncoded(g_cityQuery.c_str());
+  path.append("&appid=").appendUrlEncoded(g_apiKey.c_str());
+  path.append("&units=").append(g_units.c_str());
+}
+
+static bool requestWeather(HttpSession& ow) {
+  if (g_apiKey.empty()) {
+    Serial.println("No OpenWeather API key stored. Open portal and set it.");
     return false;
   }
 
-  int code = https.GET();
+  // OpenWeather "current weather" endpoint:
+  // https://api.openweathermap.org/data/2.5/weather?q=...&appid=...&units=metric
+  FixedString<HTTP_MAX_PATH> path;
+  buildApiPath(path, "weather");
+  FixedString<HTTP_MAX_HEADERS> headers;
+  cacheValidatorHeaders(CACHE_WEATHER, headers);
+  return ow.send(path.c_str(), headers.c_str());
+}
+
+// Reads the response to requestWeather(). `unchanged` is set when the
+// server answered 304 and the cached record was used as is.
+static bool fetchWeather(HttpSession& ow, WeatherData& out, bool& unchanged) {
+  int code = ow.receive();
+  trimClock(ow);
   Serial.printf("HTTP GET code: %d\n", code);
+  if (code == 304 && cacheLoad(out)) {
+    cacheTouch(CACHE_WEATHER);
+    unchanged = true;
+    Serial.println("Weather: not modified, using cached record");
+    return true;
+  }
   if (code != 200) {
     Serial.printf("HTTP GET failed, code=%d\n", code);
-    String body = https.getString();
-    Serial.println(body);
-    https.end();
+    if (code > 0) printErrorBody(ow);
     return false;
   }
 
-  String payload = https.getString();
-  https.end();
-
-  // Parse JSON
-  StaticJsonDocument<2048> doc;
-  DeserializationError err = deserializeJson(doc, payload);
-  if (err) {
-    Serial.print("JSON parse failed: ");
-    Serial.println(err.c_str());
-    return false;
-  }
+  bool parsed = parseWeather(ow.body(), out);
+  bool whole = ow.skipBody();
+  if (!parsed || !whole) return false;
 
-  out.temp      = doc["main"]["temp"].as<float>();
-  out.tempMin   = doc["main"]["temp_min"].as<float>();
-  out.tempMax   = doc["main"]["temp_max"].as<float>();
-  out.feelsLike = doc["main"]["feels_like"].as<float>();
-
-  out.weatherId   = doc["weather"][0]["id"].as<int>();
-  out.main        = String((const char*)doc["weather"][0]["main"]);
-  out.description = String((const char*)doc["weather"][0]["description"]);
-  out.iconCode    = String((const char*)doc["weather"][0]["icon"]);
-  
   // Store current time as timestamp
   out.timestamp = time(nullptr);
+  cacheStore(out, ow.etag(), ow.lastModified());
+  unchanged = false;
 
   Serial.printf("Weather: %.1f (feels %.1f, min %.1f max %.1f) id=%d main=%s icon=%s\n",
                 out.temp, out.feelsLike, out.tempMin, out.tempMax, 
@@ -495,86 +548,157 @@ static bool fetchWeather(WeatherData& out) {
 }
 
 // ===== Forecast fetch (tomorrow's weather) =====
-static bool fetchForecast(ForecastData& out) {
-  if (g_apiKey.length() == 0) {
+static bool requestForecast(HttpSession& ow) {
+  if (g_apiKey.empty()) {
     Serial.println("No API key for forecast fetch");
     return false;
   }
 
-  // Use 5-day forecast API to get tomorrow's weather
-  // https://api.openweathermap.org/data/2.5/forecast?q=...&appid=...&units=metric&cnt=10
-  String cityEncoded = urlEncodeCity(g_cityQuery);
-  String url = String("https://") + OW_HOST + "/data/2.5/forecast?q=" +
-               cityEncoded + "&appid=" + g_apiKey + "&units=" + g_units + "&cnt=10";
+  // Use 5-day forecast API to get tomorrow's weather. The whole list is
+  // needed (tomorrow can be up to 48 h out); it is parsed as it streams.
+  // https://api.openweathermap.org/data/2.5/forecast?q=...&appid=...&units=metric
+  FixedString<HTTP_MAX_PATH> path;
+  buildApiPath(path, "forecast");
+  FixedString<HTTP_MAX_HEADERS> headers;
+  cacheValidatorHeaders(CACHE_FORECAST, headers);
   Serial.println("Fetching forecast...");
-  Serial.println(url);
-
-  WiFiClientSecure client;
-  client.setInsecure();
-
-  HTTPClient https;
-  if (!https.begin(client, url)) {
-    Serial.println("Forecast HTTP begin failed");
-    return false;
-  }
+  return ow.send(path.c_str(), headers.c_str());
+}
 
-  int code = https.GET();
+// Reads the response to requestForecast(), see fetchWeather()
+static bool fetchForecast(HttpSession& ow, ForecastData& out, bool& unchanged) {
+  int code = ow.receive();
+  trimClock(ow);
   Serial.printf("Forecast HTTP GET code: %d\n", code);
+  if (code == 304 && cacheLoad(out)) {
+    cacheTouch(CACHE_FORECAST);
+    unchanged = true;
+    Serial.println("Forecast: not modified, using cached record");
+    return true;
+  }
   if (code != 200) {
     Serial.printf("Forecast GET failed, code=%d\n", code);
-    https.end();
     return false;
   }
 
-  String payload = https.getString();
-  https.end();
+  bool parsed = parseForecast(ow.body(), out, time(nullptr), g_timezoneOffset * 3600L);
+  bool whole = ow.skipBody();
+  if (!parsed || !whole) return false;
+
+  cacheStore(out, ow.etag(), ow.lastModified());
+  unchanged = false;
 
-  // Parse forecast JSON
-  StaticJsonDocument<4096> doc;
-  DeserializationError err = deserializeJson(doc, payload);
-  if (err) {
-    Serial.print("Forecast JSON parse failed: ");
-    Serial.println(err.c_str());
+  Serial.printf("Forecast: min %.1f, max %.1f, id=%d, main=%s, icon=%s\n",
+                out.tempMin, out.tempMax, out.weatherId, out.main.c_str(), out.iconCode.c_str());
+
+  return true;
+}
+
+// ===== Other locations (one group request for all of them) =====
+static bool requestGroup(HttpSession& ow) {
+  if (g_apiKey.empty()) {
+    Serial.println("No API key for location fetch");
     return false;
   }
 
-  // Get forecast data from list (first entry represents next period forecast)
-  JsonArray list = doc["list"];
-  if (list.size() > 0) {
-    JsonObject forecast = list[0];
-    out.tempMin   = forecast["main"]["temp_min"].as<float>();
-    out.tempMax   = forecast["main"]["temp_max"].as<float>();
-    out.weatherId = forecast["weather"][0]["id"].as<int>();
-    out.main      = String((const char*)forecast["weather"][0]["main"]);
-    out.iconCode  = String((const char*)forecast["weather"][0]["icon"]);
+  // Current weather for up to 20 city IDs in one response:
+  // https://api.openweathermap.org/data/2.5/group?id=524901,703448&appid=...&units=metric
+  FixedString<HTTP_MAX_PATH> path;
+  path.append("/data/2.5/group?id=").append(g_cityIds.c_str());
+  path.append("&appid=").appendUrlEncoded(g_apiKey.c_str());
+  path.append("&units=").append(g_units.c_str());
+  FixedString<HTTP_MAX_HEADERS> headers;
+  cacheValidatorHeaders(CACHE_GROUP, headers);
+  Serial.printf("Fetching %u location(s)...\n", (unsigned)g_locationCount);
+  return ow.send(path.c_str(), headers.c_str());
+}
+
+// Each city goes to the cache as soon as it is parsed; `ctx` is the fetch time
+static void storeLocation(void* ctx, size_t index, LocationWeather& loc) {
+  loc.weather.timestamp = *(const uint32_t*)ctx;
+  cacheStoreLocation(index, loc);
+  Serial.printf("Location %u: %s %.1f id=%d\n", (unsigned)index, loc.name.c_str(),
+                loc.weather.temp, loc.weather.weatherId);
+}
 
-    Serial.printf("Forecast: min %.1f, max %.1f, id=%d, main=%s, icon=%s\n",
-                  out.tempMin, out.tempMax, out.weatherId, out.main.c_str(), out.iconCode.c_str());
-  } else {
-    Serial.println("No forecast data available");
+// Reads the response to requestGroup(), see fetchWeather()
+static bool fetchGroup(HttpSession& ow, bool& unchanged) {
+  int code = ow.receive();
+  trimClock(ow);
+  Serial.printf("Group HTTP GET code: %d\n", code);
+  if (code == 304 && cacheLocationCount() > 0) {
+    cacheTouch(CACHE_GROUP);
+    unchanged = true;
+    Serial.println("Locations: not modified, using cached records");
+    return true;
+  }
+  if (code != 200) {
+    Serial.printf("Group GET failed, code=%d\n", code);
+    if (code > 0) printErrorBody(ow);
     return false;
   }
 
+  uint32_t now = time(nullptr);
+  size_t count = 0;
+  bool parsed = parseGroup(ow.body(), storeLocation, &now, count);
+  bool whole = ow.skipBody();
+  if (!parsed || !whole) return false;
+
+  cacheStoreGroup(count, ow.etag(), ow.lastModified());
+  unchanged = false;
+  Serial.printf("Locations: %u of %u received\n", (unsigned)count, (unsigned)g_locationCount);
   return true;
 }
 
 // ===== Time sync helper ================
+// The clock keeps running through deep sleep but TZ does not survive it;
+// set it up front so local-time decisions work before any NTP sync.
+static void applyTimezone() {
+  // POSIX TZ counts the other way round: UTC+2 is "UTC-2"
+  char tz[16];
+  snprintf(tz, sizeof(tz), "UTC%+d", -g_timezoneOffset);
+  setenv("TZ", tz, 1);
+  tzset();
+}
+
+static const char* NTP_SERVERS[2] = { "pool.ntp.org", "time.nist.gov" };
+
+// Blocking NTP, only when clockNeedsNtp() says the RTC time can't be trusted
 static void syncTime() {
+  // Servers by cached address where there is one, so SNTP skips its own
+  // lookup. configTime() keeps the pointers: the strings must stay put.
+  static char addrs[2][16];
+  const char* servers[2];
+  bool anyCached = false;
+  for (int i = 0; i < 2; i++) {
+    IPAddress ip;
+    bool cached = false;
+    servers[i] = NTP_SERVERS[i];
+    if (dnsResolve(NTP_SERVERS[i], ip, &cached)) {
+      snprintf(addrs[i], sizeof(addrs[i]), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+      servers[i] = addrs[i];
+      anyCached |= cached;
+    }
+  }
+
   // Configure NTP with timezone offset
   // Format: timezone offset in seconds, daylight saving offset
   int32_t tzOffset = g_timezoneOffset * 3600; // Convert hours to seconds
-  configTime(tzOffset, 0, "pool.ntp.org", "time.nist.gov");
+  sntp_set_sync_status(SNTP_SYNC_STATUS_RESET);
+  configTime(tzOffset, 0, servers[0], servers[1]);
   Serial.printf("Syncing time with timezone offset %d hours (%d seconds)...\n", g_timezoneOffset, tzOffset);
   
+  // Wait for an actual answer: a warm clock is already past 100000
   int retries = 0;
-  while (time(nullptr) < 100000 && retries < 20) {
-    delay(500);
-    Serial.print(".");
+  while (sntp_get_sync_status() != SNTP_SYNC_STATUS_COMPLETED && retries < 100) {
+    delay(100);
+    if (retries % 5 == 4) Serial.print(".");
     retries++;
   }
   Serial.println();
   
-  if (time(nullptr) > 100000) {
+  if (sntp_get_sync_status() == SNTP_SYNC_STATUS_COMPLETED) {
+    clockNtpSynced();
     time_t now = time(nullptr);
     struct tm* tm_info = localtime(&now);
     char timeBuf[32];
@@ -582,12 +706,234 @@ static void syncTime() {
     Serial.printf("Time synced successfully: %s\n", timeBuf);
   } else {
     Serial.println("Time sync failed, using relative time");
+    if (anyCached) {
+      // Perhaps stale addresses: look them up again next time
+      for (const char* host : NTP_SERVERS) dnsForget(host);
+    }
+  }
+}
+
+// Re-resolves the cached hosts whose TTL would run out before the
+// earliest next wake, after the fetch while the wake does its bookkeeping
+// (the radio is up anyway). Joined before the radio goes off for the
+// panel refresh; usually nothing is due.
+static BackgroundJob g_dnsJob;
+
+static void refreshDns(void*) {
+  dnsRefresh(g_minIntervalMin * 60UL);
+}
+
+// ---------------- View selection ----------------
+// Split view needs both records; anything less falls back to the detailed
+// view or an error screen. `unchanged` means every record came from the
+// cache or a 304, so a panel already showing that view is left alone.
+// The values `view` puts on the panel, for the refresh threshold
+static ShownReading shownReading(uint8_t view, const WeatherData& w, const ForecastData& f) {
+  ShownReading r;
+  r.view = view;
+  r.page = g_page;
+  r.localDay = 0;
+  if (w.timestamp > 0) {
+    time_t t = w.timestamp;
+    struct tm* tm_info = localtime(&t);
+    r.localDay = (uint16_t)((tm_info->tm_year % 100) * 366 + tm_info->tm_yday);
+  }
+  r.weatherId = w.weatherId;
+  r.temp = w.temp;
+  bool split = (view == VIEW_SPLIT);
+  r.tempMin = split ? NAN : w.tempMin;
+  r.tempMax = split ? NAN : w.tempMax;
+  r.forecastId = split ? f.weatherId : -1;
+  r.forecastMin = split ? f.tempMin : NAN;
+  r.forecastMax = split ? f.tempMax : NAN;
+  r.stale = g_stale;
+  return r;
+}
+
+static void showWeather(bool night, bool currentOk, const WeatherData& w,
+                        bool forecastOk, const ForecastData& f, bool unchanged) {
+  uint8_t view = VIEW_NONE;
+  if (currentOk) view = (night && forecastOk) ? VIEW_SPLIT : VIEW_DETAIL;
+
+  bool samePanel = view != VIEW_NONE && view == g_lastView && g_lastFrameMagic == FRAME_MAGIC &&
+                   g_shown.page == g_page && g_shown.stale == g_stale;
+  if (unchanged && samePanel) {
+    Serial.println("Data unchanged - keeping the current panel image");
+    panelReady();
+    epd.hibernate();
+    return;
+  }
+
+  // Close enough to what is shown, and the shown reading isn't older than
+  // a stable-weather sleep: not worth a refresh
+  ShownReading next = shownReading(view, w, f);
+  uint32_t now = (uint32_t)time(nullptr);
+  bool recent = now >= g_shownAt && now - g_shownAt < g_updateIntervalHours * 3600UL;
+  if (samePanel && g_shownValid && recent && !readingChanged(g_shown, next, g_refreshDeltaC)) {
+    Serial.printf("Data within %.1f degrees of the panel - no refresh\n", g_refreshDeltaC);
+    panelReady();
+    epd.hibernate();
+    return;
+  }
+
+  if (view == VIEW_SPLIT) {
+    Serial.println("Both current and forecast data OK - rendering split screen");
+    presentSplitScreen(w, f);
+  } else if (view == VIEW_DETAIL) {
+    if (night) {
+      Serial.printf("Current OK: %d, Forecast OK: %d - falling back to detailed view\n", currentOk, forecastOk);
+    }
+    presentWeather(w);
+  } else {
+    WeatherData err;
+    err.main = "Weather ERR";
+    traceFlag(WAKE_FAILED);
+    presentWeather(err);
+  }
+  g_lastView = view;
+  g_shown = next;
+  g_shownValid = (view != VIEW_NONE);
+  g_shownAt = now;
+}
+
+// Multi-location page: always the detailed view, headed by the location's name
+static void showLocation(bool ok, const LocationWeather& loc, bool unchanged) {
+  panelReady();
+  setHeaderCity(ok ? loc.name.c_str() : "");
+  showWeather(false, ok, loc.weather, false, ForecastData(), unchanged);
+}
+
+// ---------------- Failed fetches ----------------
+// The panel keeps showing the last good records, flagged stale, and the
+// fetch is retried with backoff instead of after a whole interval.
+static bool useLastGood(WeatherData& w) {
+  if (!cacheLoad(w)) return false;
+  g_stale = true;
+  return true;
+}
+
+static bool useLastGood(ForecastData& f) {
+  if (!cacheLoad(f) || (uint32_t)time(nullptr) >= f.tomorrowStart) return false;
+  g_stale = true;
+  return true;
+}
+
+static bool useLastGood(LocationWeather& loc) {
+  if (g_page == 0 || !cacheLoadLocation(g_page - 1, loc)) return false;
+  g_stale = true;
+  return true;
+}
+
+static uint32_t planRetry() {
+  if (g_fetchFailures < UINT8_MAX) g_fetchFailures++;
+  uint32_t sleepSec = retryBackoffSeconds(g_fetchFailures, g_updateIntervalHours * 3600UL, esp_random());
+  Serial.printf("Schedule: %u failed fetch(es) in a row%s -> retry in %lu s\n", g_fetchFailures,
+                g_stale ? ", last good data shown" : "", (unsigned long)sleepSec);
+  return sleepSec;
+}
+
+// ---------------- Wake scheduling ----------------
+// Trend inputs: the forecast's volatility fields (from a forecast seen in
+// the last day) and the change since the previous fetched reading.
+static uint32_t planNextWake(bool currentOk, const WeatherData& w) {
+  WeatherTrend trend;
+  ForecastData f;
+  if (cacheFresh(CACHE_FORECAST, 86400UL) && cacheLoad(f)) {
+    trend.haveForecast = true;
+    trend.forecastStepC = f.maxStepC;
+    trend.forecastConditionChange = f.conditionChange;
+  }
+
+  if (currentOk && !isnan(w.temp) && w.timestamp > 0) {
+    uint32_t at = w.timestamp;
+    if (isnan(g_prevTemp) || at < g_prevTempAt) {
+      g_prevTemp = w.temp;
+      g_prevTempAt = at;
+    } else if (at - g_prevTempAt >= 600) {   // too close together says nothing
+      trend.haveObserved = true;
+      trend.observedRateCPerHour = (w.temp - g_prevTemp) * 3600.0f / (float)(at - g_prevTempAt);
+      g_prevTemp = w.temp;
+      g_prevTempAt = at;
+    }
+  }
+
+  ScheduleConfig cfg;
+  cfg.minSec = g_minIntervalMin * 60UL;
+  cfg.maxSec = g_updateIntervalHours * 3600UL;
+  cfg.nightStartHour = g_nightModeStartHour;
+  cfg.nightEndHour = g_nightModeEndHour;
+
+  uint32_t secOfDay = UINT32_MAX;
+  time_t now = time(nullptr);
+  if (now > 100000) {
+    struct tm* tm_info = localtime(&now);
+    secOfDay = tm_info->tm_hour * 3600UL + tm_info->tm_min * 60UL + tm_info->tm_sec;
+  }
+
+  uint32_t sleepSec = nextWakeSeconds(cfg, trend, secOfDay);
+  Serial.printf("Schedule: volatility %.2f (forecast step %.1f%s, observed %.1f/h) -> wake in %lu min\n",
+                trendVolatility(trend), trend.forecastStepC,
+                trend.forecastConditionChange ? ", condition change" : "",
+                trend.observedRateCPerHour, (unsigned long)(sleepSec / 60));
+
+  // Several locations: the next page is due sooner than the weather says
+  if (g_locationCount > 0 && g_rotateMin > 0 && sleepSec > g_rotateMin * 60UL) {
+    sleepSec = g_rotateMin * 60UL;
+    Serial.printf("Schedule: page %u next, in %u min\n", g_nextPage, g_rotateMin);
+  }
+  return sleepSec;
+}
+
+// Records the wake's trace on the way out; nothing after this is measured
+static void enterDeepSleep(uint64_t sleepUs) {
+  uint32_t t0 = millis();
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);   // light sleep's button/UART sources
+  esp_sleep_enable_timer_wakeup(sleepUs);
+  traceAdd(PHASE_SLEEP_ENTRY, millis() - t0);
+  traceCommit();
+  Serial.flush();
+  esp_deep_sleep_start();
+}
+
+// ---------------- Always-on mode ----------------
+// With deep sleep off the device stays up: loop() runs update cycles (and
+// console commands / button presses) from a timer queue and light-sleeps
+// in between, see idleUntilNextEvent().
+static EventQueue g_events;
+static int g_cycleTimer = -1;
+
+static void runWake();
+
+static void runCycle(void*) {
+  traceBegin();
+  runWake();
+}
+
+// Next update cycle in `delayMs`, replacing the pending one
+static void scheduleCycle(uint32_t delayMs) {
+  if (g_cycleTimer < 0) g_cycleTimer = g_events.schedule(millis(), delayMs, runCycle);
+  else                  g_events.reschedule(g_cycleTimer, millis(), delayMs);
+}
+
+static void finishWake(uint32_t sleepSec) {
+  Serial.println("Display rendered successfully.");
+  
+  if (g_enableDeepSleep) {
+    uint64_t sleepTime = sleepSec * 1000000ULL;
+    Serial.printf("Deep sleep enabled - entering sleep for %lu minutes...\n", (unsigned long)(sleepSec / 60));
+    enterDeepSleep(sleepTime);
+  } else {
+    traceCommit();
+    Serial.printf("Deep sleep disabled - next update in %lu minutes (light sleep until then)\n",
+                  (unsigned long)(sleepSec / 60));
+    scheduleCycle(sleepSec * 1000UL);
   }
 }
 
 // ---------------- Setup / Loop ----------------
 void setup() {
   Serial.begin(115200);
+  traceBegin();
   delay(500);
   Serial.println("ePaper Weather Display");
   Serial.println("---------------------");
@@ -609,89 +955,353 @@ void setup() {
   // Force SPI pins (don’t rely on defaults)
   SPI.begin(PIN_SCK, -1 /*MISO*/, PIN_MOSI, PIN_CS);
 
-  display.init(115200, true, 50, false);
+  pinMode(PIN_BUTTON, INPUT_PULLUP);
+
+  // Sleep through the panel's BUSY periods instead of polling (SSD1680:
+  // BUSY is high while the controller works)
+  busyWaitBegin(PIN_BUSY, HIGH);
+  epd.setBusyCallback(busyWaitCallback);
+
+  renderBegin(frame);
 
   // if (FORCE_CLEAR_SETTINGS) {
+  //   Preferences prefs;
   //   prefs.begin("weather", false);
   //   prefs.clear();
   //   prefs.end();
   //   Serial.println("Cleared NVS settings!");
   // }
 
-  loadSettings();
+  runWake();   // only returns with deep sleep off
+  Serial.println("Always-on mode: type 'help' on serial for commands");
+}
+
+// One update: settings, cache, WiFi + fetch as needed, render, then
+// finishWake() - deep sleep, or the next cycle on g_events
+static void runWake() {
+  g_stale = false;
+  g_clockTrimmed = false;
+  {
+    PhaseTimer t(PHASE_SETTINGS);
+    loadSettings();
+  }
+  applyTimezone();
+  beginCache();
+  cacheRestore();   // cold boot: last-good records from flash, if any
+
+  // Multi-location: every wake shows the next page in turn. The extra
+  // locations all come from one group request, so one fetch serves a
+  // whole round of pages while it is fresh. IDs the API didn't answer
+  // for get no page.
+  size_t located = cacheLocationCount();
+  uint8_t pages = 1 + (located ? located : g_locationCount);
+  g_page = g_nextPage < pages ? g_nextPage : 0;
+  g_nextPage = (g_page + 1) % pages;
+  LocationWeather loc;
+  bool locKnown = g_page > 0 && cacheLoadLocation(g_page - 1, loc);
+  bool groupCached = cacheFresh(CACHE_GROUP, g_weatherTtlMin * 60UL) && cacheLocationCount() > 0;
+  if (g_page > 0) Serial.printf("Location page %u of %u\n", g_page, pages - 1);
+
+  // Panel init + chrome of the expected view overlap with WiFi and the
+  // fetch below. Warm wake with a known panel image: skip the initial
+  // full refresh so presentFrame() can go partial.
+  bool panelKnown = (g_lastFrameMagic == FRAME_MAGIC);
+  g_headerCity = g_page == 0 ? g_cityQuery.c_str() : (locKnown ? loc.name.c_str() : "");
+  startPanelPrep(panelKnown, (g_page == 0 && isNightMode()) ? VIEW_SPLIT : VIEW_DETAIL);
+
+  // Records fetched within their TTL (e.g. a reset minutes after the last
+  // wake) are used as they are, without bringing the radio up at all.
+  WeatherData w;
+  ForecastData f;
+  bool weatherCached = cacheFresh(CACHE_WEATHER, g_weatherTtlMin * 60UL) && cacheLoad(w);
+  // A forecast fetched before midnight describes today by now
+  bool forecastCached = cacheFresh(CACHE_FORECAST, g_forecastTtlMin * 60UL) && cacheLoad(f) &&
+                        (uint32_t)time(nullptr) < f.tomorrowStart;
+  if (g_page > 0 && groupCached && locKnown) {
+    Serial.println("Cache: locations still fresh - skipping WiFi");
+    traceFlag(WAKE_NO_WIFI);
+    showLocation(true, loc, true);
+    finishWake(planNextWake(weatherCached, w));
+    return;
+  }
+  if (g_page == 0 && weatherCached && (forecastCached || !isNightMode())) {
+    Serial.println("Cache: records still fresh - skipping WiFi");
+    traceFlag(WAKE_NO_WIFI);
+    showWeather(isNightMode(), true, w, forecastCached, f, true);
+    finishWake(planNextWake(true, w));
+    return;
+  }
 
   // Connect WiFi / portal if needed
-  if (!ensureWiFiWithPortal()) {
-    WeatherData dummy;
-    dummy.main = "No WiFi";
-    renderWeather(dummy);
+  bool wifiOk;
+  {
+    PhaseTimer t(PHASE_WIFI);
+    wifiOk = connectWiFi();
+  }
+  if (!wifiOk) {
+    traceFlag(WAKE_FAILED);
+    radioOff();   // the portal may have left it up
+    bool night = isNightMode();
+    bool shown = false;
+    if (g_page > 0) {
+      shown = useLastGood(loc);
+      if (shown) showLocation(true, loc, false);
+    } else if (weatherCached || useLastGood(w)) {
+      bool forecastOk = night && (forecastCached || useLastGood(f));
+      showWeather(night, true, w, forecastOk, f, false);
+      shown = true;
+    }
+    if (!shown) {
+      WeatherData dummy;
+      dummy.main = "No WiFi";
+      presentWeather(dummy);
+      g_lastView = VIEW_NONE;
+    }
     Serial.println("Going to sleep (WiFi failed)...");
-    esp_sleep_enable_timer_wakeup(g_updateIntervalHours * 3600ULL * 1000000ULL);
-    esp_deep_sleep_start();
+    finishWake(planRetry());
+    return;
   }
 
-  // Sync time from NTP
-  syncTime();
+  // Warm wakes keep the RTC time; the responses' Date header trims it below
+  if (clockNeedsNtp()) {
+    PhaseTimer t(PHASE_TIME_SYNC);
+    syncTime();
+  } else {
+    Serial.println("Clock: RTC time trusted, skipping NTP");
+  }
 
   //Serial.printf("Current time check - Hour: %d, Night mode start: %d, Night mode end: %d\n", 
   //              localtime(&(time_t){time(nullptr)})->tm_hour, g_nightModeStartHour, g_nightModeEndHour);
   
   // Check if night mode is active and fetch appropriate data
-  if (isNightMode()) {
+  bool night = isNightMode();
+  if (night) {
     Serial.println("Night mode active - fetching forecast");
-    
-    WeatherData w;
-    ForecastData f;
-    
-    bool currentOk = fetchWeather(w);
-    bool forecastOk = fetchForecast(f);
-    
-    if (currentOk && forecastOk) {
-      Serial.println("Both current and forecast data OK - rendering split screen");
-      renderWeatherSplitScreen(w, f);
-    } else {
-      Serial.printf("Current OK: %d, Forecast OK: %d - falling back to detailed view\n", currentOk, forecastOk);
-      // Fallback to full detailed view if forecast fails
-      if (currentOk) {
-        renderWeather(w);
-      } else {
-        WeatherData err;
-        err.main = "Weather ERR";
-        renderWeather(err);
-      }
-    }
   } else {
     // Day mode - show detailed current weather
     Serial.println("Day mode active - showing detailed weather");
-    
-    WeatherData w;
-    if (fetchWeather(w)) {
-      renderWeather(w);
+  }
+
+  // One keep-alive TLS connection for every request of this wake. Only
+  // what the page needs and the cache can't answer is requested (plus
+  // stale locations, while the radio is up anyway), and all GETs go out
+  // back to back before any response is read. Static: its request
+  // buffers are a couple of KB, too much for the loop task's stack.
+  static HttpSession ow(OW_HOST);
+  ow.resetTotals();   // always-on mode: the trace wants this cycle's only
+  bool home = (g_page == 0);
+  bool weatherUnchanged = weatherCached;
+  bool forecastUnchanged = forecastCached;
+  bool groupUnchanged = groupCached;
+
+  bool weatherSent = home && !weatherCached && requestWeather(ow);
+  bool forecastSent = home && night && !forecastCached && requestForecast(ow);
+  bool groupSent = g_locationCount > 0 && !groupCached && requestGroup(ow);
+
+  bool currentOk = weatherCached || (weatherSent && fetchWeather(ow, w, weatherUnchanged));
+  bool forecastOk = night && (forecastCached || (forecastSent && fetchForecast(ow, f, forecastUnchanged)));
+  bool groupOk = groupCached || (groupSent && fetchGroup(ow, groupUnchanged));
+  ow.close();
+  g_dnsJob.start("dns", refreshDns, nullptr);
+
+  const HttpStats& http = ow.totals();
+  traceAdd(PHASE_TLS, http.connectMs);
+  traceAdd(PHASE_HTTP_WAIT, http.ttfbMs + http.waitMs);
+  traceAdd(PHASE_JSON, http.bodyMs - http.waitMs);
+  if (http.plainBytes > http.bodyBytes) {
+    Serial.printf("HTTP: %lu B on the wire for %lu B of JSON (%lu ms inflating)\n",
+                  (unsigned long)http.bodyBytes, (unsigned long)http.plainBytes,
+                  (unsigned long)http.inflateMs);
+  }
+
+  // What this page needed came through; anything missing falls back to
+  // the last good record and a retry
+  bool fetchOk = home ? currentOk && (!night || forecastOk) : groupOk;
+  if (!fetchOk) traceFlag(WAKE_FAILED);
+  if (home && currentOk && historyAdd(w)) Serial.printf("History: %u reading(s)\n", (unsigned)historyCount());
+
+  g_dnsJob.join();
+
+  // Date header disagreed by more than drift explains: settle it while the
+  // radio is still up
+  if (clockNeedsNtp()) {
+    PhaseTimer t(PHASE_TIME_SYNC);
+    syncTime();
+  }
+
+  radioOff();
+
+  if (home) {
+    if (!currentOk) currentOk = useLastGood(w);
+    if (night && !forecastOk) forecastOk = useLastGood(f);
+    showWeather(night, currentOk, w, forecastOk, f,
+                weatherUnchanged && (!night || forecastUnchanged));
+  } else {
+    bool locOk = groupOk && cacheLoadLocation(g_page - 1, loc);
+    if (!locOk) locOk = useLastGood(loc);
+    showLocation(locOk, loc, groupUnchanged);
+  }
+
+  if (!fetchOk) {
+    finishWake(planRetry());
+    return;
+  }
+  g_fetchFailures = 0;
+  cachePersist(LAST_GOOD_FLASH_EVERY_S);
+  finishWake(planNextWake(currentOk, w));
+}
+
+// ---------------- Always-on loop ----------------
+// Deep sleep never returns here; without it loop() is an event loop:
+// serial console, BOOT button, due jobs, then light sleep until the next
+// one. The Arduino build has no power management (CONFIG_PM), so there
+// is no automatic light sleep; it is entered explicitly with the timer,
+// the button and UART0 as wake sources.
+static const uint32_t CONSOLE_AWAKE_MS = 60000;   // no light sleep this long after serial input
+static const uint32_t LIGHT_SLEEP_MIN_MS = 20;    // shorter waits aren't worth the sleep entry
+static const uint32_t IDLE_POLL_MS = 20;          // awake idle step while the console is in use
+static const uint32_t BUTTON_DEBOUNCE_MS = 50;
+
+static FixedString<128> g_consoleLine;
+static bool g_consoleActive = false;
+static uint32_t g_consoleAt = 0;      // last serial input
+static bool g_buttonDown = false;
+static uint32_t g_buttonAt = 0;
+static uint32_t g_sleptMs = 0;        // light sleep since boot, for the duty cycle
+
+// "set <name> <value>"; names are the old per-value NVS keys
+static bool setSetting(const char* name, const char* value) {
+  long n = strtol(value, nullptr, 10);
+  if      (!strcmp(name, "apiKey"))     g_apiKey = value;
+  else if (!strcmp(name, "city"))       g_cityQuery = value;
+  else if (!strcmp(name, "cityIds"))    { g_cityIds = value; g_locationCount = normalizeCityIds(g_cityIds); }
+  else if (!strcmp(name, "interval"))   g_updateIntervalHours = n > 0 ? n : 1;
+  else if (!strcmp(name, "nightStart")) g_nightModeStartHour = constrain(n, 0, 23);
+  else if (!strcmp(name, "nightEnd"))   g_nightModeEndHour = constrain(n, 0, 23);
+  else if (!strcmp(name, "tzOffset"))   g_timezoneOffset = constrain(n, -12, 14);
+  else if (!strcmp(name, "deepSleep"))  g_enableDeepSleep = n != 0;
+  else if (!strcmp(name, "partialMax")) g_maxPartialRefreshes = constrain(n, 0, 255);
+  else if (!strcmp(name, "ttlNow"))     g_weatherTtlMin = constrain(n, 0, 65535);
+  else if (!strcmp(name, "ttlFcst"))    g_forecastTtlMin = constrain(n, 0, 65535);
+  else if (!strcmp(name, "staticIp"))   g_wifiStaticIp = n != 0;
+  else if (!strcmp(name, "minIntvl"))   g_minIntervalMin = constrain(n, 1, 65535);
+  else if (!strcmp(name, "refDelta"))   g_refreshDeltaC = strtof(value, nullptr);
+  else if (!strcmp(name, "rotateMin"))  g_rotateMin = constrain(n, 0, 65535);
+  else return false;
+
+  saveSettings(g_apiKey.c_str(), g_cityQuery.c_str(), g_cityIds.c_str());
+  if (!strcmp(name, "city") || !strcmp(name, "cityIds")) beginCache();
+  return true;
+}
+
+static void printStatus() {
+  uint32_t now = millis();
+  uint32_t nextMs = g_events.nextDueIn(now);
+  Serial.printf("City: %s (+%u locations), timezone UTC%+d, deep sleep %s\n", g_cityQuery.c_str(),
+                (unsigned)g_locationCount, g_timezoneOffset, g_enableDeepSleep ? "ON" : "OFF");
+  Serial.printf("Next update in %lu s, %u failed fetch(es) in a row, page %u shown\n",
+                (unsigned long)(nextMs / 1000), g_fetchFailures, g_page);
+  Serial.printf("Light sleep: %lu of %lu s since boot (%.1f%%)\n", (unsigned long)(g_sleptMs / 1000),
+                (unsigned long)(now / 1000), now ? g_sleptMs * 100.0f / now : 0.0f);
+}
+
+static void runCommand(StrBuf& line) {
+  line.trim();
+  if (line.empty()) return;
+  if (line.overflowed()) {
+    Serial.println("Console: line too long");
+    return;
+  }
+
+  char buf[128];
+  strlcpy(buf, line.c_str(), sizeof(buf));
+  const char* cmd = strtok(buf, " ");
+  if (!strcmp(cmd, "help")) {
+    Serial.println("Commands: update | status | trace | set <name> <value>");
+    Serial.println("  names: apiKey city cityIds interval nightStart nightEnd tzOffset deepSleep");
+    Serial.println("         partialMax ttlNow ttlFcst staticIp minIntvl refDelta rotateMin");
+  } else if (!strcmp(cmd, "update")) {
+    scheduleCycle(0);
+  } else if (!strcmp(cmd, "status")) {
+    printStatus();
+  } else if (!strcmp(cmd, "trace")) {
+    traceDump(Serial, true);
+  } else if (!strcmp(cmd, "set")) {
+    const char* name = strtok(nullptr, " ");
+    char* value = strtok(nullptr, "");
+    while (value && *value == ' ') value++;
+    if (!name || !value || !*value) Serial.println("Usage: set <name> <value>");
+    else if (setSetting(name, value)) Serial.printf("Saved %s - applies from the next update\n", name);
+    else Serial.printf("Unknown setting '%s'\n", name);
+  } else {
+    Serial.printf("Unknown command '%s' - try help\n", cmd);
+  }
+}
+
+static void pollConsole() {
+  while (Serial.available() > 0) {
+    int c = Serial.read();
+    g_consoleActive = true;
+    g_consoleAt = millis();
+    if (c == '\r' || c == '\n') {
+      runCommand(g_consoleLine);
+      g_consoleLine.clear();
     } else {
-      WeatherData err;
-      err.main = "Weather ERR";
-      renderWeather(err);
+      g_consoleLine += (char)c;
     }
   }
+  if (g_consoleActive && millis() - g_consoleAt > CONSOLE_AWAKE_MS) g_consoleActive = false;
+}
 
-  // Disconnect WiFi to save power
-  WiFi.disconnect(true);
-  WiFi.mode(WIFI_OFF);
+static void pollButton() {
+  bool down = digitalRead(PIN_BUTTON) == LOW;
+  if (down == g_buttonDown || millis() - g_buttonAt < BUTTON_DEBOUNCE_MS) return;
+  g_buttonDown = down;
+  g_buttonAt = millis();
+  if (down) {
+    Serial.println("Button: update now");
+    scheduleCycle(0);
+  }
+}
 
-  Serial.println("Display rendered successfully.");
-  
-  if (g_enableDeepSleep) {
-    uint64_t sleepTime = g_updateIntervalHours * 3600ULL * 1000000ULL;
-    Serial.printf("Deep sleep enabled - entering sleep for %u hours...\n", g_updateIntervalHours);
-    esp_sleep_enable_timer_wakeup(sleepTime);
-    esp_deep_sleep_start();
-  } else {
-    Serial.println("Deep sleep disabled. Device will remain active.");
-    Serial.println("To enable deep sleep, set g_enableDeepSleep = true via WiFi portal or serial command.");
-    delay(10000);  // Wait 10 seconds for user to see message
+static void idleUntilNextEvent() {
+  uint32_t waitMs = g_events.nextDueIn(millis());
+  if (waitMs == 0) return;
+
+  // Stay awake while someone types (the console would lose characters) or
+  // holds the button (its level wakeup would fire right away)
+  if (g_consoleActive || g_buttonDown || waitMs < LIGHT_SLEEP_MIN_MS) {
+    delay(waitMs < IDLE_POLL_MS ? waitMs : IDLE_POLL_MS);
+    return;
+  }
+
+  if (waitMs != EventQueue::NEVER) esp_sleep_enable_timer_wakeup((uint64_t)waitMs * 1000ULL);
+  gpio_wakeup_enable((gpio_num_t)PIN_BUTTON, GPIO_INTR_LOW_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+  // The characters that wake UART0 are lost; the console then stays
+  // awake for CONSOLE_AWAKE_MS so the command can be typed again
+  uart_set_wakeup_threshold(UART_NUM_0, 3);
+  esp_sleep_enable_uart_wakeup(UART_NUM_0);
+  Serial.flush();
+
+  uint32_t t0 = millis();
+  esp_light_sleep_start();            // millis() keeps counting through it
+  g_sleptMs += millis() - t0;
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+  // Disarm the pin's level interrupt too, or a held button keeps firing it
+  // while awake
+  gpio_wakeup_disable((gpio_num_t)PIN_BUTTON);
+
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_UART) {
+    g_consoleActive = true;
+    g_consoleAt = millis();
+    Serial.println("Console awake - type 'help'");
   }
 }
 
 void loop() {
-  // Not used - device wakes from deep sleep and runs setup() again
+  pollConsole();
+  pollButton();
+  g_events.runDue(millis());
+  idleUntilNextEvent();
 }
@@ -0,0 +1,170 @@
+#include <Arduino.h>
+#include <Preferences.h>
+
+#include "settings_store.h"
+
+static const char* NVS_NAMESPACE = "weather";
+static const char* BLOB_KEY = "cfg";
+static const uint32_t SETTINGS_MAGIC = 0x53544731;   // "STG1"
+
+struct BlobHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;       // payload bytes that follow
+  uint32_t crc;        // CRC-32 of the payload
+};
+
+static RTC_DATA_ATTR BlobHeader s_mirrorHeader;
+static RTC_DATA_ATTR Settings s_mirror;
+
+static Preferences s_prefs;
+
+// CRC-32 (IEEE, reflected), bitwise: a few hundred bytes once per boot
+static uint32_t crc32(const uint8_t* data, size_t len) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
+
+static void terminate(Settings& s) {
+  s.apiKey[sizeof(s.apiKey) - 1] = '\0';
+  s.city[sizeof(s.city) - 1] = '\0';
+  s.cityIds[sizeof(s.cityIds) - 1] = '\0';
+}
+
+static BlobHeader headerFor(const Settings& s) {
+  BlobHeader h;
+  h.magic = SETTINGS_MAGIC;
+  h.version = SETTINGS_VERSION;
+  h.size = sizeof(Settings);
+  h.crc = crc32((const uint8_t*)&s, sizeof(Settings));
+  return h;
+}
+
+static void mirror(const Settings& s) {
+  s_mirror = s;
+  s_mirrorHeader = headerFor(s_mirror);   // CRC over the copy's own bytes
+}
+
+static bool mirrorValid() {
+  return s_mirrorHeader.magic == SETTINGS_MAGIC && s_mirrorHeader.version == SETTINGS_VERSION &&
+         s_mirrorHeader.size == sizeof(Settings) &&
+         s_mirrorHeader.crc == crc32((const uint8_t*)&s_mirror, sizeof(Settings));
+}
+
+void settingsForgetMirror() {
+  memset(&s_mirrorHeader, 0, sizeof(s_mirrorHeader));
+}
+
+void settingsDefaults(Settings& s) {
+  memset(&s, 0, sizeof(s));
+  strlcpy(s.city, "Beer Sheva,IL", sizeof(s.city));
+  s.intervalHours = 12;
+  s.nightStartHour = 20;
+  s.nightEndHour = 7;
+  s.tzOffsetHours = 0;
+  s.deepSleep = false;
+  s.partialMax = 10;
+  s.weatherTtlMin = 10;
+  s.forecastTtlMin = 180;
+  s.wifiStaticIp = false;
+  s.minIntervalMin = 30;
+  s.refreshDeltaC = 0.5f;
+  s.rotateMin = 15;
+}
+
+// The blob, over the defaults when it is from an older layout
+static bool loadBlob(Settings& out) {
+  uint8_t buf[sizeof(BlobHeader) + sizeof(Settings)];
+  size_t len = s_prefs.getBytesLength(BLOB_KEY);
+  if (len < sizeof(BlobHeader) || len > sizeof(buf)) return false;
+  if (s_prefs.getBytes(BLOB_KEY, buf, len) != len) return false;
+
+  BlobHeader h;
+  memcpy(&h, buf, sizeof(h));
+  const uint8_t* payload = buf + sizeof(h);
+  if (h.magic != SETTINGS_MAGIC || h.version > SETTINGS_VERSION) return false;
+  if (h.size != len - sizeof(h) || h.crc != crc32(payload, h.size)) {
+    Serial.println("Settings: stored blob is corrupt");
+    return false;
+  }
+
+  settingsDefaults(out);
+  memcpy(&out, payload, h.size);
+  terminate(out);
+  return true;
+}
+
+// Firmware before the blob kept one NVS key per value
+static bool loadKeys(Settings& out) {
+  settingsDefaults(out);
+  if (!s_prefs.isKey("apiKey") && !s_prefs.isKey("city")) return false;
+
+  s_prefs.getString("apiKey", out.apiKey, sizeof(out.apiKey));
+  if (s_prefs.isKey("city")) s_prefs.getString("city", out.city, sizeof(out.city));
+  if (s_prefs.isKey("cityIds")) s_prefs.getString("cityIds", out.cityIds, sizeof(out.cityIds));
+  out.intervalHours  = s_prefs.getUInt("interval", out.intervalHours);
+  out.nightStartHour = s_prefs.getUChar("nightStart", out.nightStartHour);
+  out.nightEndHour   = s_prefs.getUChar("nightEnd", out.nightEndHour);
+  out.tzOffsetHours  = s_prefs.getShort("tzOffset", out.tzOffsetHours);
+  out.deepSleep      = s_prefs.getBool("deepSleep", out.deepSleep);
+  out.partialMax     = s_prefs.getUChar("partialMax", out.partialMax);
+  out.weatherTtlMin  = s_prefs.getUShort("ttlNow", out.weatherTtlMin);
+  out.forecastTtlMin = s_prefs.getUShort("ttlFcst", out.forecastTtlMin);
+  out.wifiStaticIp   = s_prefs.getBool("staticIp", out.wifiStaticIp);
+  out.minIntervalMin = s_prefs.getUShort("minIntvl", out.minIntervalMin);
+  out.refreshDeltaC  = s_prefs.getFloat("refDelta", out.refreshDeltaC);
+  out.rotateMin      = s_prefs.getUShort("rotateMin", out.rotateMin);
+  terminate(out);
+  return true;
+}
+
+SettingsSource settingsLoad(Settings& out) {
+  if (mirrorValid()) {
+    out = s_mirror;
+    return SETTINGS_RTC;
+  }
+
+  // Read-only open fails while the namespace doesn't exist yet
+  bool opened = s_prefs.begin(NVS_NAMESPACE, true);
+  bool fromBlob = opened && loadBlob(out);
+  bool fromKeys = !fromBlob && opened && loadKeys(out);
+  if (opened) s_prefs.end();
+
+  if (fromBlob) {
+    mirror(out);
+    return SETTINGS_NVS;
+  }
+  if (!fromKeys) settingsDefaults(out);
+
+  // Write the blob once so later cold boots take the single read
+  settingsSave(out);
+  return fromKeys ? SETTINGS_MIGRATED : SETTINGS_DEFAULTS;
+}
+
+bool settingsSave(const Settings& s) {
+  uint8_t buf[sizeof(BlobHeader) + sizeof(Settings)];
+  BlobHeader h = headerFor(s);
+  memcpy(buf, &h, sizeof(h));
+  memcpy(buf + sizeof(h), &s, sizeof(s));
+
+  bool ok = s_prefs.begin(NVS_NAMESPACE, false) &&
+            s_prefs.putBytes(BLOB_KEY, buf, sizeof(buf)) == sizeof(buf);
+  s_prefs.end();
+  if (!ok) Serial.println("Settings: NVS write failed");
+  mirror(s);
+  return ok;
+}
+
+const char* settingsSourceName(SettingsSource src) {
+  switch (src) {
+    case SETTINGS_RTC:      return "RTC mirror";
+    case SETTINGS_NVS:      return "NVS";
+    case SETTINGS_MIGRATED: return "NVS keys (migrated)";
+    case SETTINGS_DEFAULTS: return "defaults";
+  }
+  return "?";
+}
@@ -0,0 +1,380 @@
+#include <Arduino.h>
+#include <esp_crt_bundle.h>
+#include <esp_random.h>
+#include <mbedtls/error.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/sha256.h>
+#include <time.h>
+
+#include "fnv1a.h"
+#include "tls_client.h"
+
+// Optional public key pin: SHA-256 of the SubjectPublicKeyInfo of the
+// server certificate or of an intermediate it sends, as 64 hex digits.
+// The chain must then both verify against the root bundle and contain the
+// key. Set it with build_flags = -DTLS_PIN_SHA256=\"...\"; the hash of a
+// server's leaf key comes from
+//   openssl s_client -connect HOST:443 </dev/null | openssl x509 -pubkey -noout |
+//     openssl pkey -pubin -outform der | openssl dgst -sha256
+// Off by default: the bundle check is what replaced setInsecure(), and a
+// pin goes stale when the server rotates its key, which stops every fetch
+// until the firmware is rebuilt. Pin an intermediate to ride out leaf
+// renewals.
+#ifndef TLS_PIN_SHA256
+#define TLS_PIN_SHA256 ""
+#endif
+
+static const uint32_t TLS_CONNECT_TIMEOUT_MS = 8000;
+static const uint32_t TLS_HANDSHAKE_TIMEOUT_MS = 10000;
+static const uint32_t TLS_WRITE_TIMEOUT_MS = 8000;
+
+// Before the first NTP sync the clock reads 1970 and every certificate
+// would be "not yet valid". The wake syncs the clock before its first
+// request, so a clock still short of this (2024-01-01) means NTP failed.
+// One handshake per cold boot may then go through with only the validity
+// dates unchecked (chain, host name and pin still are), so the response's
+// Date header can set the clock (clockCorrect()); its session is not
+// saved. Any further handshake on an unset clock is refused.
+static const time_t TLS_CLOCK_VALID_AFTER = 1704067200;
+
+static const uint32_t TLS_SESSION_MAGIC = 0x544c5332; // "TLS2", bump when the layout changes
+
+static RTC_DATA_ATTR uint32_t s_magic = 0;
+static RTC_DATA_ATTR uint32_t s_hostHash = 0;
+static RTC_DATA_ATTR uint32_t s_secretHash = 0;   // of the saved session's master secret
+static RTC_DATA_ATTR uint16_t s_sessionLen = 0;
+static RTC_DATA_ATTR uint8_t s_session[TLS_SESSION_MAX];
+static RTC_DATA_ATTR bool s_datesSkipped = false;   // the one unchecked handshake is used
+
+static int tlsRandom(void*, unsigned char* out, size_t len) {
+  esp_fill_random(out, len);
+  return 0;
+}
+
+static void logError(const char* what, int ret) {
+  char msg[80];
+  mbedtls_strerror(ret, msg, sizeof(msg));
+  Serial.printf("TLS: %s failed: -0x%04x %s\n", what, (unsigned)-ret, msg);
+}
+
+static bool pinConfigured() {
+  return TLS_PIN_SHA256[0] != '\0';
+}
+
+static bool matchesPin(const mbedtls_x509_crt* crt) {
+  const char* pin = TLS_PIN_SHA256;
+  uint8_t digest[32];
+  if (strlen(pin) != 64 || mbedtls_sha256(crt->pk_raw.p, crt->pk_raw.len, digest, 0) != 0) return false;
+  for (int i = 0; i < 32; i++) {
+    char hex[3] = { pin[2 * i], pin[2 * i + 1], '\0' };
+    if ((uint8_t)strtoul(hex, nullptr, 16) != digest[i]) return false;
+  }
+  return true;
+}
+
+// Anywhere in the chain the server sent: its own key or an intermediate's
+static bool chainHasPin(const mbedtls_x509_crt* crt) {
+  for (; crt; crt = crt->next) {
+    if (matchesPin(crt)) return true;
+  }
+  return false;
+}
+
+static bool clockSet() {
+  return time(nullptr) >= TLS_CLOCK_VALID_AFTER;
+}
+
+// ---------------- Saved session ----------------
+void TlsClient::dropSession() {
+  s_magic = 0;
+  s_sessionLen = 0;
+}
+
+bool TlsClient::loadSession(const char* host) {
+  if (s_magic != TLS_SESSION_MAGIC || s_hostHash != fnv1a(host) || s_sessionLen == 0) return false;
+
+  mbedtls_ssl_session session;
+  mbedtls_ssl_session_init(&session);
+  int ret = mbedtls_ssl_session_load(&session, s_session, s_sessionLen);
+  if (ret == 0) ret = mbedtls_ssl_set_session(&_ssl, &session);   // copies it
+  mbedtls_ssl_session_free(&session);
+  if (ret != 0) {
+    logError("session load", ret);
+    dropSession();
+    return false;
+  }
+  return true;
+}
+
+// Also after a resumed handshake: the server may have issued a new ticket.
+// The size is asked for first: a session that doesn't fit the RTC buffer
+// (a large ticket, a long peer certificate) is not saved, and every wake
+// pays a full handshake until TLS_SESSION_MAX is raised.
+void TlsClient::saveSession(const char* host) {
+  mbedtls_ssl_session session;
+  mbedtls_ssl_session_init(&session);
+  size_t len = 0;
+  int ret = mbedtls_ssl_get_session(&_ssl, &session);
+  if (ret == 0) {
+    ret = mbedtls_ssl_session_save(&session, nullptr, 0, &len);
+    if (ret == MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL) ret = 0;
+  }
+  if (ret == 0 && len > sizeof(s_session)) {
+    Serial.printf("TLS: session is %u B, TLS_SESSION_MAX is %u: not saved, raise TLS_SESSION_MAX\n",
+                  (unsigned)len, (unsigned)sizeof(s_session));
+    mbedtls_ssl_session_free(&session);
+    dropSession();
+    return;
+  }
+  if (ret == 0) ret = mbedtls_ssl_session_save(&session, s_session, sizeof(s_session), &len);
+  mbedtls_ssl_session_free(&session);
+  if (ret != 0) {
+    logError("session save", ret);
+    dropSession();
+    return;
+  }
+  Serial.printf("TLS: session saved, %u of %u B\n", (unsigned)len, (unsigned)sizeof(s_session));
+  s_sessionLen = (uint16_t)len;
+  s_hostHash = fnv1a(host);
+  s_secretHash = _secretHash;
+  s_magic = TLS_SESSION_MAGIC;
+}
+
+// ---------------- Handshake ----------------
+// A resumed handshake reuses the saved session's master secret, a full one
+// derives a new one: comparing hashes tells them apart without looking
+// into mbedtls's private state.
+void TlsClient::exportKeys(void* ctx, mbedtls_ssl_key_export_type type, const unsigned char* secret,
+                           size_t len, const unsigned char*, const unsigned char*, mbedtls_tls_prf_types) {
+  if (type == MBEDTLS_SSL_KEY_EXPORT_TLS12_MASTER_SECRET) ((TlsClient*)ctx)->_secretHash = fnv1a(secret, len);
+}
+
+int TlsClient::bioSend(void* ctx, const unsigned char* buf, size_t len) {
+  TlsClient* self = (TlsClient*)ctx;
+  size_t n = self->_tcp.write(buf, len);
+  if (n == 0) return self->_tcp.connected() ? MBEDTLS_ERR_SSL_WANT_WRITE : MBEDTLS_ERR_NET_CONN_RESET;
+  if (self->_counting) self->_hs.bytesOut += n;
+  return (int)n;
+}
+
+// Never blocks: mbedtls is driven by the polling in open() / read()
+int TlsClient::bioRecv(void* ctx, unsigned char* buf, size_t len) {
+  TlsClient* self = (TlsClient*)ctx;
+  int n = self->_tcp.available() > 0 ? self->_tcp.read(buf, len) : 0;
+  if (n <= 0) return self->_tcp.connected() ? MBEDTLS_ERR_SSL_WANT_READ : MBEDTLS_ERR_NET_CONN_RESET;
+  if (self->_counting) self->_hs.bytesIn += n;
+  return n;
+}
+
+void TlsClient::fail(const char* what, int ret) {
+  logError(what, ret);
+  stop();
+}
+
+bool TlsClient::open(const char* host, const IPAddress* ip, uint16_t port, bool offerSession) {
+  stop();
+  _hs = TlsHandshakeStats();
+  _retryFull = false;
+  bool clockUnset = !clockSet();
+  if (clockUnset && s_datesSkipped) {
+    Serial.printf("TLS: clock still not set, can't check the certificate of %s\n", host);
+    return false;
+  }
+  uint32_t t0 = millis();
+  bool tcp = ip ? _tcp.connect(*ip, port, TLS_CONNECT_TIMEOUT_MS) : _tcp.connect(host, port, TLS_CONNECT_TIMEOUT_MS);
+  if (!tcp) {
+    Serial.printf("TLS: TCP connect to %s:%u failed\n", host, port);
+    return false;
+  }
+
+  mbedtls_ssl_init(&_ssl);
+  mbedtls_ssl_config_init(&_conf);
+  _open = true;
+
+  int ret = mbedtls_ssl_config_defaults(&_conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                        MBEDTLS_SSL_PRESET_DEFAULT);
+  if (ret != 0) {
+    fail("config", ret);
+    return false;
+  }
+  // TLS 1.2: the session is complete when the handshake ends, while a 1.3
+  // ticket only arrives later with the application data
+  mbedtls_ssl_conf_max_tls_version(&_conf, MBEDTLS_SSL_VERSION_TLS1_2);
+  // Unset clock: verify anyway, then accept a chain whose only fault is
+  // its dates (checked after the handshake)
+  mbedtls_ssl_conf_authmode(&_conf, clockUnset ? MBEDTLS_SSL_VERIFY_OPTIONAL : MBEDTLS_SSL_VERIFY_REQUIRED);
+  mbedtls_ssl_conf_rng(&_conf, tlsRandom, nullptr);
+  if (esp_crt_bundle_attach(&_conf) != ESP_OK) {
+    Serial.println("TLS: certificate bundle unavailable");
+    stop();
+    return false;
+  }
+
+  if ((ret = mbedtls_ssl_setup(&_ssl, &_conf)) != 0 || (ret = mbedtls_ssl_set_hostname(&_ssl, host)) != 0) {
+    fail("setup", ret);
+    return false;
+  }
+  mbedtls_ssl_set_bio(&_ssl, this, bioSend, bioRecv, nullptr);
+  mbedtls_ssl_set_export_keys_cb(&_ssl, exportKeys, this);
+
+  bool offered = offerSession && loadSession(host);
+  _secretHash = 0;
+  _counting = true;
+  while ((ret = mbedtls_ssl_handshake(&_ssl)) != 0) {
+    if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) break;
+    if (millis() - t0 > TLS_HANDSHAKE_TIMEOUT_MS) {
+      ret = MBEDTLS_ERR_SSL_TIMEOUT;
+      break;
+    }
+    delay(1);
+  }
+  _counting = false;
+
+  if (ret == MBEDTLS_ERR_X509_CERT_VERIFY_FAILED) {
+    char why[160];
+    mbedtls_x509_crt_verify_info(why, sizeof(why), "", mbedtls_ssl_get_verify_result(&_ssl));
+    Serial.printf("TLS: certificate of %s rejected: %s", host, why);
+    stop();
+    return false;
+  }
+  if (ret != 0) {
+    _retryFull = offered;
+    fail("handshake", ret);
+    return false;
+  }
+
+  if (clockUnset) {
+    uint32_t flags = mbedtls_ssl_get_verify_result(&_ssl);
+    if (flags & ~(uint32_t)(MBEDTLS_X509_BADCERT_EXPIRED | MBEDTLS_X509_BADCERT_FUTURE)) {
+      char why[160];
+      mbedtls_x509_crt_verify_info(why, sizeof(why), "", flags);
+      Serial.printf("TLS: certificate of %s rejected: %s", host, why);
+      stop();
+      return false;
+    }
+    Serial.printf("TLS: clock not set, validity dates of %s not checked (once per cold boot)\n", host);
+    s_datesSkipped = true;
+  }
+
+  // A resumed session was pinned when it was saved, and keeps only the
+  // leaf certificate; a full handshake has the whole chain the server sent
+  _hs.resumed = offered && _secretHash == s_secretHash;
+  if (pinConfigured() && !_hs.resumed && !chainHasPin(mbedtls_ssl_get_peer_cert(&_ssl))) {
+    Serial.printf("TLS: %s did not present the pinned key\n", host);
+    stop();
+    return false;
+  }
+  _hs.ms = millis() - t0;
+  _connected = true;
+  // Not resumed later without the dates ever having been checked
+  if (!clockUnset) saveSession(host);
+  return true;
+}
+
+// ---------------- Client ----------------
+int TlsClient::connect(IPAddress, uint16_t) {
+  Serial.println("TLS: connect needs a host name to verify");
+  return 0;
+}
+
+int TlsClient::connect(const char* host, uint16_t port) {
+  if (open(host, nullptr, port, true)) return 1;
+  if (!_retryFull) return 0;
+  Serial.println("TLS: retrying without the saved session");
+  dropSession();
+  return open(host, nullptr, port, false) ? 1 : 0;
+}
+
+int TlsClient::connect(const char* host, IPAddress ip, uint16_t port) {
+  if (open(host, &ip, port, true)) return 1;
+  if (!_retryFull) return 0;
+  Serial.println("TLS: retrying without the saved session");
+  dropSession();
+  return open(host, &ip, port, false) ? 1 : 0;
+}
+
+size_t TlsClient::write(const uint8_t* buf, size_t size) {
+  if (!_connected) return 0;
+  size_t sent = 0;
+  uint32_t t0 = millis();
+  while (sent < size) {
+    int ret = mbedtls_ssl_write(&_ssl, buf + sent, size - sent);
+    if (ret > 0) {
+      sent += ret;
+    } else if ((ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) &&
+               millis() - t0 < TLS_WRITE_TIMEOUT_MS) {
+      delay(1);   // same arguments again, as mbedtls requires
+    } else {
+      logError("write", ret);
+      _connected = false;
+      break;
+    }
+  }
+  return sent;
+}
+
+int TlsClient::available() {
+  if (!_connected) return _peeked >= 0 ? 1 : 0;
+  int n = (int)mbedtls_ssl_get_bytes_avail(&_ssl);
+  if (n == 0 && _tcp.available() > 0) {
+    // Decrypt the next record, if it is complete, without consuming it
+    int ret = mbedtls_ssl_read(&_ssl, nullptr, 0);
+    if (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+      if (ret != MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY) logError("read", ret);
+      _connected = false;
+    }
+    n = (int)mbedtls_ssl_get_bytes_avail(&_ssl);
+  }
+  return n + (_peeked >= 0 ? 1 : 0);
+}
+
+// -1 when nothing has arrived yet, like WiFiClient
+int TlsClient::read(uint8_t* buf, size_t size) {
+  if (size == 0) return 0;
+  size_t n = 0;
+  if (_peeked >= 0) {
+    buf[n++] = (uint8_t)_peeked;
+    _peeked = -1;
+  }
+  if (n == size || !_connected) return n ? (int)n : -1;
+
+  int ret = mbedtls_ssl_read(&_ssl, buf + n, size - n);
+  if (ret > 0) return (int)n + ret;
+  if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+    // 0 / close_notify: the server closed the connection
+    if (ret != 0 && ret != MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY) logError("read", ret);
+    _connected = false;
+  }
+  return n ? (int)n : -1;
+}
+
+int TlsClient::read() {
+  uint8_t b;
+  return read(&b, 1) == 1 ? b : -1;
+}
+
+int TlsClient::peek() {
+  if (_peeked < 0) {
+    uint8_t b;
+    if (read(&b, 1) == 1) _peeked = b;
+  }
+  return _peeked;
+}
+
+uint8_t TlsClient::connected() {
+  if (_peeked >= 0) return 1;
+  if (!_connected) return 0;
+  return mbedtls_ssl_get_bytes_avail(&_ssl) > 0 || _tcp.connected();
+}
+
+void TlsClient::stop() {
+  if (_open) {
+    if (_connected) mbedtls_ssl_close_notify(&_ssl);
+    mbedtls_ssl_free(&_ssl);
+    mbedtls_ssl_config_free(&_conf);
+    _open = false;
+  }
+  _connected = false;
+  _peeked = -1;
+  _tcp.stop();
+}
@@ -0,0 +1,127 @@
+// TlsClient for off-target builds: plain TCP, no TLS, so HttpSession can
+// talk to a stand-in server on the host (test/test_http). The device
+// build uses tls_client.cpp.
+#ifndef ARDUINO
+
+#include <Arduino.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "tls_client.h"
+
+void TlsClient::dropSession() {}
+
+int TlsClient::connect(IPAddress, uint16_t) {
+  Serial.println("TLS: connect needs a host name to verify");
+  return 0;
+}
+
+int TlsClient::connect(const char* host, uint16_t port) {
+  IPAddress ip;
+  if (!ip.fromString(host)) {
+    Serial.printf("TLS: host build only connects to addresses, not %s\n", host);
+    return 0;
+  }
+  return connect(host, ip, port);
+}
+
+int TlsClient::connect(const char* host, IPAddress ip, uint16_t port) {
+  stop();
+  _hs = TlsHandshakeStats();
+  uint32_t t0 = millis();
+
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = (uint32_t)ip;
+  _fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (_fd < 0 || ::connect(_fd, (const sockaddr*)&addr, sizeof(addr)) != 0) {
+    Serial.printf("TLS: TCP connect to %s:%u failed\n", host, port);
+    stop();
+    return 0;
+  }
+  int one = 1;
+  setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  _hs.ms = millis() - t0;
+  return 1;
+}
+
+size_t TlsClient::write(const uint8_t* buf, size_t size) {
+  size_t sent = 0;
+  while (_fd >= 0 && sent < size) {
+    ssize_t n = send(_fd, buf + sent, size - sent, MSG_NOSIGNAL);
+    if (n <= 0) {
+      if (n < 0 && errno == EINTR) continue;
+      stop();
+      break;
+    }
+    sent += (size_t)n;
+  }
+  return sent;
+}
+
+int TlsClient::available() {
+  int n = 0;
+  if (_fd >= 0 && ioctl(_fd, FIONREAD, &n) != 0) n = 0;
+  return n + (_peeked >= 0 ? 1 : 0);
+}
+
+// -1 when nothing has arrived yet, like WiFiClient; a closed connection
+// reads as -1 too and drops connected()
+int TlsClient::read(uint8_t* buf, size_t size) {
+  if (size == 0) return 0;
+  size_t n = 0;
+  if (_peeked >= 0) {
+    buf[n++] = (uint8_t)_peeked;
+    _peeked = -1;
+  }
+  if (n == size || _fd < 0) return n ? (int)n : -1;
+
+  ssize_t got = recv(_fd, buf + n, size - n, MSG_DONTWAIT);
+  if (got > 0) return (int)(n + got);
+  if (got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) stop();
+  return n ? (int)n : -1;
+}
+
+int TlsClient::read() {
+  uint8_t b;
+  return read(&b, 1) == 1 ? b : -1;
+}
+
+int TlsClient::peek() {
+  if (_peeked < 0) {
+    uint8_t b;
+    if (read(&b, 1) == 1) _peeked = b;
+  }
+  return _peeked;
+}
+
+uint8_t TlsClient::connected() {
+  if (_peeked >= 0) return 1;
+  if (_fd < 0) return 0;
+  // Closed by the peer, with nothing left to read?
+  pollfd p = { _fd, POLLIN, 0 };
+  if (poll(&p, 1, 0) > 0 && (p.revents & (POLLIN | POLLHUP))) {
+    uint8_t b;
+    ssize_t n = recv(_fd, &b, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+      stop();
+      return 0;
+    }
+  }
+  return 1;
+}
+
+void TlsClient::stop() {
+  if (_fd >= 0) close(_fd);
+  _fd = -1;
+  _peeked = -1;
+}
+
+#endif
@@ -0,0 +1,74 @@
+#include <math.h>
+
+#include "wake_scheduler.h"
+
+static const uint32_t DAY_S = 86400;
+
+static float clamp01(float v) {
+  return v < 0 ? 0 : (v > 1 ? 1 : v);
+}
+
+float trendVolatility(const WeatherTrend& trend) {
+  float v = 0;
+  if (trend.haveForecast) {
+    v = fmaxf(v, fabsf(trend.forecastStepC) / TREND_FAST_STEP_C);
+    if (trend.forecastConditionChange) v = fmaxf(v, TREND_CONDITION_CHANGE);
+  }
+  if (trend.haveObserved) {
+    v = fmaxf(v, fabsf(trend.observedRateCPerHour) / TREND_FAST_RATE_C_PER_H);
+  }
+  return clamp01(v);
+}
+
+// Seconds until just past the next time `hour` comes round
+static uint32_t untilHour(uint8_t hour, uint32_t secOfDay) {
+  uint32_t at = (uint32_t)hour * 3600;
+  uint32_t d = (at + DAY_S - secOfDay) % DAY_S;
+  if (d == 0) d = DAY_S;   // on the boundary: this wake already sees the new side
+  return d + SCHEDULE_BOUNDARY_SLACK_S;
+}
+
+uint32_t nextWakeSeconds(const ScheduleConfig& cfg, const WeatherTrend& trend, uint32_t secOfDay) {
+  uint32_t minSec = cfg.minSec < cfg.maxSec ? cfg.minSec : cfg.maxSec;
+  float v = trendVolatility(trend);
+  uint32_t sleep = cfg.maxSec - (uint32_t)(v * (float)(cfg.maxSec - minSec));
+
+  bool nightMode = cfg.nightStartHour != cfg.nightEndHour;
+  if (nightMode && secOfDay < DAY_S) {
+    uint32_t boundary = untilHour(cfg.nightStartHour, secOfDay);
+    uint32_t end = untilHour(cfg.nightEndHour, secOfDay);
+    if (end < boundary) boundary = end;
+    if (boundary < sleep) sleep = boundary;
+  }
+  return sleep;
+}
+
+uint32_t retryBackoffSeconds(uint8_t failures, uint32_t maxSec, uint32_t random) {
+  uint32_t sleep = maxSec;
+  if (failures >= 1 && failures <= 16) {
+    uint64_t backoff = (uint64_t)RETRY_FIRST_S << (failures - 1);
+    if (backoff < sleep) sleep = (uint32_t)backoff;
+  }
+  // Spread over [1 - j, 1 + j] of the nominal value, never past maxSec
+  uint32_t span = (uint32_t)((uint64_t)sleep * RETRY_JITTER_PERCENT * 2 / 100);
+  uint32_t jittered = sleep - span / 2 + random % (span + 1);
+  if (jittered > maxSec) jittered = maxSec;
+  return jittered;
+}
+
+// Same value on screen: both missing, or within delta
+static bool sameTemp(float a, float b, float deltaC) {
+  if (isnan(a) || isnan(b)) return isnan(a) && isnan(b);
+  return fabsf(a - b) <= deltaC;
+}
+
+bool readingChanged(const ShownReading& prev, const ShownReading& next, float deltaC) {
+  if (prev.view != next.view || prev.page != next.page || prev.localDay != next.localDay) return true;
+  if (prev.weatherId != next.weatherId || prev.forecastId != next.forecastId) return true;
+  if (prev.stale != next.stale) return true;
+  return !sameTemp(prev.temp, next.temp, deltaC) ||
+         !sameTemp(prev.tempMin, next.tempMin, deltaC) ||
+         !sameTemp(prev.tempMax, next.tempMax, deltaC) ||
+         !sameTemp(prev.forecastMin, next.forecastMin, deltaC) ||
+         !sameTemp(prev.forecastMax, next.forecastMax, deltaC);
+}
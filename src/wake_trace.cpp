@@ -0,0 +1,117 @@
+#include <Arduino.h>
+#include <esp_random.h>
+#include <esp_system.h>
+
+#include "wake_trace.h"
+
+// Dump line: "#WT1 " + hex of, little-endian:
+//   session u32, wake u32, totalMs u32, flags u8, phase count u8,
+//   phaseMs u16 x count, checksum u8 (sum of the previous bytes)
+// The session id changes whenever the ring is reset, so the host tool
+// can tell wakes of different power cycles apart and drop repeats.
+
+static const int TRACE_RING_SIZE = 32;
+static const uint32_t TRACE_MAGIC = 0x57545232; // "WTR2", bump when WakeRecord changes
+
+struct WakeRecord {
+  uint32_t wake;
+  uint32_t totalMs;                // boot (or cycle start) -> traceCommit()
+  uint16_t phaseMs[PHASE_COUNT];
+  uint8_t flags;
+};
+
+static RTC_DATA_ATTR uint32_t g_traceMagic = 0;
+static RTC_DATA_ATTR uint32_t g_traceSession = 0;
+static RTC_DATA_ATTR uint32_t g_traceWakes = 0;      // records ever committed this session
+static RTC_DATA_ATTR uint32_t g_traceDumped = 0;     // ... of which went out on serial
+static RTC_DATA_ATTR WakeRecord g_traceRing[TRACE_RING_SIZE];
+
+static WakeRecord s_current;
+static bool s_committed = false;
+static bool s_booted = false;
+static uint32_t s_startMs = 0;     // 0 for the boot's first cycle: counts from reset
+
+void traceBegin() {
+  memset(&s_current, 0, sizeof(s_current));
+  s_committed = false;
+
+  if (g_traceMagic != TRACE_MAGIC) {
+    g_traceMagic = TRACE_MAGIC;
+    g_traceSession = esp_random();
+    g_traceWakes = 0;
+    g_traceDumped = 0;
+  }
+  s_current.wake = g_traceWakes;
+
+  // Later cycles of the always-on loop are neither cold nor a deep sleep wake
+  if (s_booted) {
+    s_startMs = millis();
+    return;
+  }
+  s_booted = true;
+  esp_reset_reason_t reason = esp_reset_reason();
+  if (reason != ESP_RST_DEEPSLEEP) s_current.flags |= WAKE_COLD;
+}
+
+void traceAdd(WakePhase phase, uint32_t ms) {
+  if (phase >= PHASE_COUNT) return;
+  uint32_t sum = s_current.phaseMs[phase] + ms;
+  s_current.phaseMs[phase] = sum > 0xFFFF ? 0xFFFF : (uint16_t)sum;
+}
+
+void traceFlag(uint8_t flags) {
+  s_current.flags |= flags;
+}
+
+void traceCommit() {
+  if (s_committed) return;
+  s_committed = true;
+
+  s_current.totalMs = millis() - s_startMs;
+  g_traceRing[g_traceWakes % TRACE_RING_SIZE] = s_current;
+  g_traceWakes++;
+
+  // Only talk when someone listens; records wait in the ring otherwise
+  if (Serial) traceDump(Serial);
+}
+
+// ---------------- Serial dump ----------------
+static void putHex(Print& out, const uint8_t* p, size_t n, uint8_t& sum) {
+  static const char HEX_DIGITS[] = "0123456789abcdef";
+  for (size_t i = 0; i < n; i++) {
+    out.write(HEX_DIGITS[p[i] >> 4]);
+    out.write(HEX_DIGITS[p[i] & 0x0F]);
+    sum += p[i];
+  }
+}
+
+static void putU32(Print& out, uint32_t v, uint8_t& sum) {
+  uint8_t b[4] = { (uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24) };
+  putHex(out, b, sizeof(b), sum);
+}
+
+static void dumpRecord(Print& out, const WakeRecord& r) {
+  uint8_t sum = 0;
+  out.print("#WT1 ");
+  putU32(out, g_traceSession, sum);
+  putU32(out, r.wake, sum);
+  putU32(out, r.totalMs, sum);
+  uint8_t head[2] = { r.flags, (uint8_t)PHASE_COUNT };
+  putHex(out, head, sizeof(head), sum);
+  for (int i = 0; i < PHASE_COUNT; i++) {
+    uint8_t b[2] = { (uint8_t)r.phaseMs[i], (uint8_t)(r.phaseMs[i] >> 8) };
+    putHex(out, b, sizeof(b), sum);
+  }
+  uint8_t check = sum;
+  putHex(out, &check, 1, sum);
+  out.print("\n");
+}
+
+void traceDump(Print& out, bool all) {
+  uint32_t oldest = g_traceWakes > TRACE_RING_SIZE ? g_traceWakes - TRACE_RING_SIZE : 0;
+  uint32_t from = all ? oldest : (g_traceDumped > oldest ? g_traceDumped : oldest);
+  for (uint32_t i = from; i < g_traceWakes; i++) {
+    dumpRecord(out, g_traceRing[i % TRACE_RING_SIZE]);
+  }
+  g_traceDumped = g_traceWakes;
+}
@@ -0,0 +1,272 @@
+#include <Arduino.h>
+#include <Preferences.h>
+#include <time.h>
+
+#include "fnv1a.h"
+#include "weather_cache.h"
+
+// Plain-old-data copies with the same field sizes as the records (whose
+// FixedString members carry a pointer to themselves).
+struct CachedWeather {
+  float temp;
+  float tempMin;
+  float tempMax;
+  float feelsLike;
+  int32_t weatherId;
+  char main[16];
+  char description[40];
+  char iconCode[4];
+  uint32_t timestamp;
+};
+
+struct CachedForecast {
+  float tempMin;
+  float tempMax;
+  int32_t weatherId;
+  char main[16];
+  char iconCode[4];
+  float maxStepC;
+  bool conditionChange;
+  uint32_t tomorrowStart;
+};
+
+// No description: location pages only show the main condition
+struct CachedLocation {
+  uint32_t cityId;
+  char name[24];
+  float temp;
+  float tempMin;
+  float tempMax;
+  int32_t weatherId;
+  char main[16];
+  char iconCode[4];
+  uint32_t timestamp;
+};
+
+struct CacheMeta {
+  uint32_t fetchedAt;    // 0 = empty
+  char etag[48];
+  char lastModified[32];
+};
+
+static const uint32_t CACHE_MAGIC = 0x57434335; // "WCC5", bump when a record layout changes
+
+static RTC_DATA_ATTR uint32_t s_magic = 0;
+static RTC_DATA_ATTR uint32_t s_queryHash = 0;   // home entries
+static RTC_DATA_ATTR uint32_t s_groupHash = 0;   // other locations
+static RTC_DATA_ATTR CacheMeta s_meta[3];
+static RTC_DATA_ATTR CachedWeather s_weather;
+static RTC_DATA_ATTR CachedForecast s_forecast;
+static RTC_DATA_ATTR CachedLocation s_locations[MAX_LOCATIONS];
+static RTC_DATA_ATTR uint8_t s_locationCount = 0;
+static RTC_DATA_ATTR uint32_t s_persistedAt = 0;   // fetch time of the records last written to NVS
+
+// NVS image of the home entries, same layouts as in RTC
+struct PersistedCache {
+  uint32_t magic;
+  uint32_t queryHash;
+  CacheMeta meta[2];
+  CachedWeather weather;
+  CachedForecast forecast;
+};
+static const char* PERSIST_NAMESPACE = "weather";
+static const char* PERSIST_KEY = "lastGood";
+
+static bool timeIsSet(time_t now) {
+  return now > 100000;
+}
+
+static void copyField(char* dst, size_t len, const char* src) {
+  strlcpy(dst, src ? src : "", len);
+}
+
+// Validators that do not fit are dropped rather than truncated
+static void setValidators(CacheMeta& m, const char* etag, const char* lastModified) {
+  m.etag[0] = '\0';
+  m.lastModified[0] = '\0';
+  if (etag && strlen(etag) < sizeof(m.etag)) strcpy(m.etag, etag);
+  if (lastModified && strlen(lastModified) < sizeof(m.lastModified)) strcpy(m.lastModified, lastModified);
+}
+
+void cacheBegin(const char* homeQuery, const char* groupQuery) {
+  uint32_t h = fnv1a(homeQuery);
+  uint32_t g = fnv1a(groupQuery);
+  if (s_magic == CACHE_MAGIC && s_queryHash == h && s_groupHash == g) return;
+
+  if (s_magic != CACHE_MAGIC || s_queryHash != h) {
+    if (s_magic == CACHE_MAGIC) Serial.println("Cache: location changed, dropping cached weather");
+    memset(s_meta, 0, sizeof(s_meta));
+  } else {
+    Serial.println("Cache: location list changed, dropping cached locations");
+    memset(&s_meta[CACHE_GROUP], 0, sizeof(s_meta[CACHE_GROUP]));
+  }
+  s_locationCount = 0;
+  s_queryHash = h;
+  s_groupHash = g;
+  s_magic = CACHE_MAGIC;
+}
+
+bool cacheFresh(CacheKind kind, uint32_t ttlSec) {
+  const CacheMeta& m = s_meta[kind];
+  time_t now = time(nullptr);
+  if (m.fetchedAt == 0 || !timeIsSet(now)) return false;
+  if ((uint32_t)now < m.fetchedAt) return false; // clock went backwards
+  return (uint32_t)now - m.fetchedAt < ttlSec;
+}
+
+bool cacheLoad(WeatherData& out) {
+  if (s_meta[CACHE_WEATHER].fetchedAt == 0) return false;
+  out.temp        = s_weather.temp;
+  out.tempMin     = s_weather.tempMin;
+  out.tempMax     = s_weather.tempMax;
+  out.feelsLike   = s_weather.feelsLike;
+  out.weatherId   = s_weather.weatherId;
+  out.main        = s_weather.main;
+  out.description = s_weather.description;
+  out.iconCode    = s_weather.iconCode;
+  out.timestamp   = s_weather.timestamp;
+  return true;
+}
+
+bool cacheLoad(ForecastData& out) {
+  if (s_meta[CACHE_FORECAST].fetchedAt == 0) return false;
+  out.tempMin   = s_forecast.tempMin;
+  out.tempMax   = s_forecast.tempMax;
+  out.weatherId = s_forecast.weatherId;
+  out.main      = s_forecast.main;
+  out.iconCode  = s_forecast.iconCode;
+  out.maxStepC  = s_forecast.maxStepC;
+  out.conditionChange = s_forecast.conditionChange;
+  out.tomorrowStart = s_forecast.tomorrowStart;
+  return true;
+}
+
+void cacheStore(const WeatherData& w, const char* etag, const char* lastModified) {
+  s_weather.temp      = w.temp;
+  s_weather.tempMin   = w.tempMin;
+  s_weather.tempMax   = w.tempMax;
+  s_weather.feelsLike = w.feelsLike;
+  s_weather.weatherId = w.weatherId;
+  copyField(s_weather.main, sizeof(s_weather.main), w.main.c_str());
+  copyField(s_weather.description, sizeof(s_weather.description), w.description.c_str());
+  copyField(s_weather.iconCode, sizeof(s_weather.iconCode), w.iconCode.c_str());
+  s_weather.timestamp = w.timestamp;
+
+  setValidators(s_meta[CACHE_WEATHER], etag, lastModified);
+  s_meta[CACHE_WEATHER].fetchedAt = time(nullptr);
+}
+
+void cacheStore(const ForecastData& f, const char* etag, const char* lastModified) {
+  s_forecast.tempMin   = f.tempMin;
+  s_forecast.tempMax   = f.tempMax;
+  s_forecast.weatherId = f.weatherId;
+  copyField(s_forecast.main, sizeof(s_forecast.main), f.main.c_str());
+  copyField(s_forecast.iconCode, sizeof(s_forecast.iconCode), f.iconCode.c_str());
+  s_forecast.maxStepC = f.maxStepC;
+  s_forecast.conditionChange = f.conditionChange;
+  s_forecast.tomorrowStart = f.tomorrowStart;
+
+  setValidators(s_meta[CACHE_FORECAST], etag, lastModified);
+  s_meta[CACHE_FORECAST].fetchedAt = time(nullptr);
+}
+
+void cacheTouch(CacheKind kind) {
+  if (s_meta[kind].fetchedAt != 0) s_meta[kind].fetchedAt = time(nullptr);
+}
+
+void cachePersist(uint32_t minIntervalSec) {
+  uint32_t fetched = s_meta[CACHE_WEATHER].fetchedAt;
+  if (fetched == 0 || fetched == s_persistedAt) return;
+  if (s_persistedAt != 0 && fetched > s_persistedAt && fetched - s_persistedAt < minIntervalSec) return;
+
+  PersistedCache p;
+  p.magic = CACHE_MAGIC;
+  p.queryHash = s_queryHash;
+  memcpy(p.meta, s_meta, sizeof(p.meta));
+  p.weather = s_weather;
+  p.forecast = s_forecast;
+
+  Preferences prefs;
+  if (!prefs.begin(PERSIST_NAMESPACE, false)) return;
+  bool ok = prefs.putBytes(PERSIST_KEY, &p, sizeof(p)) == sizeof(p);
+  prefs.end();
+  if (ok) s_persistedAt = fetched;
+  Serial.println(ok ? "Cache: last-good records saved to flash" : "Cache: flash write failed");
+}
+
+bool cacheRestore() {
+  if (s_meta[CACHE_WEATHER].fetchedAt != 0) return false;   // RTC copy survived
+
+  PersistedCache p;
+  Preferences prefs;
+  if (!prefs.begin(PERSIST_NAMESPACE, true)) return false;
+  bool ok = prefs.getBytesLength(PERSIST_KEY) == sizeof(p) &&
+            prefs.getBytes(PERSIST_KEY, &p, sizeof(p)) == sizeof(p);
+  prefs.end();
+  if (!ok || p.magic != CACHE_MAGIC || p.queryHash != s_queryHash || p.meta[CACHE_WEATHER].fetchedAt == 0) {
+    return false;
+  }
+
+  memcpy(s_meta, p.meta, sizeof(p.meta));
+  s_weather = p.weather;
+  s_forecast = p.forecast;
+  s_persistedAt = s_meta[CACHE_WEATHER].fetchedAt;
+  Serial.println("Cache: last-good records restored from flash");
+  return true;
+}
+
+void cacheStoreLocation(size_t index, const LocationWeather& loc) {
+  if (index >= MAX_LOCATIONS) return;
+  CachedLocation& c = s_locations[index];
+  c.cityId    = loc.cityId;
+  copyField(c.name, sizeof(c.name), loc.name.c_str());
+  c.temp      = loc.weather.temp;
+  c.tempMin   = loc.weather.tempMin;
+  c.tempMax   = loc.weather.tempMax;
+  c.weatherId = loc.weather.weatherId;
+  copyField(c.main, sizeof(c.main), loc.weather.main.c_str());
+  copyField(c.iconCode, sizeof(c.iconCode), loc.weather.iconCode.c_str());
+  c.timestamp = loc.weather.timestamp;
+}
+
+void cacheStoreGroup(size_t count, const char* etag, const char* lastModified) {
+  s_locationCount = count < MAX_LOCATIONS ? count : MAX_LOCATIONS;
+  setValidators(s_meta[CACHE_GROUP], etag, lastModified);
+  s_meta[CACHE_GROUP].fetchedAt = time(nullptr);
+}
+
+size_t cacheLocationCount() {
+  return s_meta[CACHE_GROUP].fetchedAt == 0 ? 0 : s_locationCount;
+}
+
+bool cacheLoadLocation(size_t index, LocationWeather& out) {
+  if (index >= cacheLocationCount()) return false;
+  const CachedLocation& c = s_locations[index];
+  out.cityId            = c.cityId;
+  out.name              = c.name;
+  out.weather.temp      = c.temp;
+  out.weather.tempMin   = c.tempMin;
+  out.weather.tempMax   = c.tempMax;
+  out.weather.feelsLike = NAN;
+  out.weather.weatherId = c.weatherId;
+  out.weather.main      = c.main;
+  out.weather.description = "";
+  out.weather.iconCode  = c.iconCode;
+  out.weather.timestamp = c.timestamp;
+  return true;
+}
+
+void cacheValidatorHeaders(CacheKind kind, StrBuf& out) {
+  const CacheMeta& m = s_meta[kind];
+  if (m.fetchedAt == 0) return;
+  if (m.etag[0]) {
+    out += "If-None-Match: ";
+    out += m.etag;
+    out += "\r\n";
+  }
+  if (m.lastModified[0]) {
+    out += "If-Modified-Since: ";
+    out += m.lastModified;
+    out += "\r\n";
+  }
+}
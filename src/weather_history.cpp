@@ -0,0 +1,67 @@
+#include <Arduino.h>
+#include <math.h>
+
+#include "fnv1a.h"
+#include "weather_history.h"
+
+static const uint32_t HISTORY_MAGIC = 0x57484931; // "WHI1", bump when PackedReading changes
+
+static RTC_DATA_ATTR uint32_t s_magic = 0;
+static RTC_DATA_ATTR uint32_t s_queryHash = 0;
+static RTC_DATA_ATTR uint32_t s_added = 0;     // sequence number of the next reading
+static RTC_DATA_ATTR PackedReading s_ring[HISTORY_SIZE];
+
+ConditionCode conditionCode(int weatherId) {
+  if (weatherId > 800 && weatherId < 900) return COND_CLOUDS;
+  switch (weatherId / 100) {
+    case 2: return COND_STORM;
+    case 3: return COND_DRIZZLE;
+    case 5: return COND_RAIN;
+    case 6: return COND_SNOW;
+    case 7: return COND_MIST;
+    case 8: return COND_CLEAR;
+  }
+  return COND_UNKNOWN;
+}
+
+bool packReading(const WeatherData& w, PackedReading& out) {
+  if (isnan(w.temp) || w.timestamp == 0) return false;
+  float centi = roundf(w.temp * 100.0f);
+  out.time = (uint32_t)w.timestamp;
+  out.tempCenti = (int16_t)(centi > INT16_MAX ? INT16_MAX : (centi < INT16_MIN ? INT16_MIN : centi));
+  out.condition = conditionCode(w.weatherId);
+  out.reserved = 0;
+  return true;
+}
+
+void historyBegin(const char* query) {
+  uint32_t h = fnv1a(query);
+  if (s_magic == HISTORY_MAGIC && s_queryHash == h) return;
+
+  if (s_magic == HISTORY_MAGIC) Serial.println("History: location changed, starting over");
+  s_added = 0;
+  s_queryHash = h;
+  s_magic = HISTORY_MAGIC;
+}
+
+bool historyAdd(const WeatherData& w) {
+  PackedReading r;
+  if (!packReading(w, r)) return false;
+  if (s_added > 0 && r.time <= s_ring[(s_added - 1) % HISTORY_SIZE].time) return false;
+
+  s_ring[s_added % HISTORY_SIZE] = r;
+  s_added++;
+  return true;
+}
+
+size_t historyCount() {
+  return s_added < HISTORY_SIZE ? s_added : HISTORY_SIZE;
+}
+
+bool historyAt(size_t i, PackedReading& out, uint32_t& seq) {
+  size_t count = historyCount();
+  if (i >= count) return false;
+  seq = s_added - count + i;
+  out = s_ring[seq % HISTORY_SIZE];
+  return true;
+}
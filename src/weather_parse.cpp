@@ -0,0 +1,324 @@
+#include <Arduino.h>
+#include <ArduinoJson.h>     // bblanchon
+
+#include "weather.h"
+
+// The parsers read straight from the HTTP body stream. The filter keeps
+// only the fields copied into the records below, so the document holds a
+// few dozen values instead of the full payload, and no String copy of the
+// body is ever made. Lists are read one element at a time.
+
+// ---------------- Parse arena ----------------
+// The filter and data documents of a parse allocate from one static block
+// instead of the heap, so a fetch leaves no holes behind. Blocks carry
+// their size for reallocate(); freeing or resizing the newest block works
+// in place, which covers ArduinoJson growing a string and then trimming
+// it. Everything is dropped when the parse ends (ArenaScope). Should the
+// block run out, the heap takes over for the rest.
+static const size_t PARSE_ARENA_BYTES = 8192;
+
+class ParseArena : public ArduinoJson::Allocator {
+public:
+  void* allocate(size_t size) override {
+    size_t need = HEADER + round8(size);
+    if (_top + need > sizeof(_buf)) {
+      if (!_warned) Serial.printf("Parse arena full (%u B), using the heap\n", (unsigned)sizeof(_buf));
+      _warned = true;
+      return malloc(size);
+    }
+    uint8_t* block = _buf + _top;
+    *(uint32_t*)block = (uint32_t)round8(size);
+    _top += need;
+    return block + HEADER;
+  }
+
+  void deallocate(void* ptr) override {
+    if (!owns(ptr)) { free(ptr); return; }
+    if (isNewest(ptr)) _top = (uint8_t*)ptr - HEADER - _buf;
+  }
+
+  void* reallocate(void* ptr, size_t size) override {
+    if (!ptr) return allocate(size);
+    if (!owns(ptr)) return realloc(ptr, size);
+    uint32_t& have = *(uint32_t*)((uint8_t*)ptr - HEADER);
+    if (isNewest(ptr) && (uint8_t*)ptr - _buf + round8(size) <= sizeof(_buf)) {
+      _top = (uint8_t*)ptr - _buf + round8(size);
+      have = (uint32_t)round8(size);
+      return ptr;
+    }
+    if (size <= have) return ptr;
+    size_t old = have;
+    deallocate(ptr);   // only frees the newest block, whose bytes stay intact until copied
+    void* moved = allocate(size);
+    if (moved) memmove(moved, ptr, old);
+    return moved;
+  }
+
+  size_t mark() const { return _top; }
+  void release(size_t mark) { _top = mark; }
+
+private:
+  static const size_t HEADER = 8;   // keeps blocks 8-byte aligned for doubles
+  static size_t round8(size_t n) { return (n + 7) & ~(size_t)7; }
+
+  bool owns(const void* p) const { return p >= _buf && p < _buf + sizeof(_buf); }
+  bool isNewest(const void* p) const {
+    const uint8_t* b = (const uint8_t*)p;
+    return b + *(const uint32_t*)(b - HEADER) == _buf + _top;
+  }
+
+  alignas(8) uint8_t _buf[PARSE_ARENA_BYTES];
+  size_t _top = 0;
+  bool _warned = false;
+};
+
+static ParseArena s_arena;
+
+// Gives back everything allocated from the arena in the scope
+class ArenaScope {
+public:
+  ArenaScope() : _mark(s_arena.mark()) {}
+  ~ArenaScope() { s_arena.release(_mark); }
+
+private:
+  size_t _mark;
+};
+
+// ---------------- Current weather ----------------
+// Shared with the group parser: its list elements have the same shape
+static void addWeatherFilter(JsonDocument& filter) {
+  filter["main"]["temp"] = true;
+  filter["main"]["temp_min"] = true;
+  filter["main"]["temp_max"] = true;
+  filter["main"]["feels_like"] = true;
+  filter["weather"][0]["id"] = true;
+  filter["weather"][0]["main"] = true;
+  filter["weather"][0]["description"] = true;
+  filter["weather"][0]["icon"] = true;
+}
+
+static void readWeather(const JsonDocument& doc, WeatherData& out) {
+  out.temp      = doc["main"]["temp"].as<float>();
+  out.tempMin   = doc["main"]["temp_min"].as<float>();
+  out.tempMax   = doc["main"]["temp_max"].as<float>();
+  out.feelsLike = doc["main"]["feels_like"].as<float>();
+
+  out.weatherId   = doc["weather"][0]["id"].as<int>();
+  out.main        = (const char*)doc["weather"][0]["main"];
+  out.description = (const char*)doc["weather"][0]["description"];
+  out.iconCode    = (const char*)doc["weather"][0]["icon"];
+}
+
+bool parseWeather(Stream& input, WeatherData& out) {
+  ArenaScope scope;
+  JsonDocument filter(&s_arena);
+  addWeatherFilter(filter);
+
+  JsonDocument doc(&s_arena);
+  DeserializationError err = deserializeJson(doc, input, DeserializationOption::Filter(filter));
+  if (err) {
+    Serial.print("JSON parse failed: ");
+    Serial.println(err.c_str());
+    return false;
+  }
+
+  readWeather(doc, out);
+  return true;
+}
+
+// ---------------- Streaming a list[] ----------------
+// Skip to the array, then deserialize one element at a time into the same
+// document. The parser stops right after an element's closing brace, so
+// the stream is left on the "," or "]" that follows it:
+//
+//   if (openList(in) && !listEmpty(in)) do { deserializeJson(doc, in, ...); } while (nextElement(in));
+static void skipSpace(Stream& input) {
+  int c = input.peek();
+  while (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+    input.read();
+    c = input.peek();
+  }
+}
+
+// Compact or pretty-printed: "list", whitespace, ':', whitespace, '['
+static bool openList(Stream& input) {
+  while (input.find("\"list\"")) {
+    skipSpace(input);
+    if (input.peek() != ':') continue;   // "list" as a value, not the key
+    input.read();
+    skipSpace(input);
+    if (input.peek() != '[') continue;
+    input.read();
+    return true;
+  }
+  return false;
+}
+
+static bool listEmpty(Stream& input) {
+  skipSpace(input);
+  return input.peek() == ']';
+}
+
+static bool nextElement(Stream& input) {
+  return input.findUntil(",", "]");
+}
+
+// ---------------- Forecast (tomorrow) ----------------
+// The 5-day forecast is 40 slots of 3 h. They are folded one by one into
+// tomorrow's aggregate, so the whole list costs the memory of one slot.
+
+// 3 h slots looked at for the volatility fields used by the wake scheduler
+static const size_t FORECAST_TREND_SLOTS = 4;
+
+// Clear and cloudy are both 8xx but look nothing alike on the panel
+static const int CONDITION_GROUPS = 10;
+static int conditionGroup(int id) {
+  return id > 800 ? 9 : id / 100;
+}
+
+// Tie-break for the dominant condition: the one that matters more
+// (storm 2, drizzle 3, rain 5, snow 6, mist 7, clear 8, clouds 9)
+static const uint8_t CONDITION_WEIGHT[CONDITION_GROUPS] = { 0, 0, 6, 3, 0, 4, 5, 2, 0, 1 };
+
+// Slots per condition group, with the first slot of each group standing in
+// for it on the panel
+struct ConditionTally {
+  uint8_t count[CONDITION_GROUPS] = {};
+  int id[CONDITION_GROUPS];
+  FixedString<16> main[CONDITION_GROUPS];
+  FixedString<4> icon[CONDITION_GROUPS];
+};
+
+static int32_t localDay(uint32_t utc, int32_t utcOffsetSec) {
+  int64_t local = (int64_t)utc + utcOffsetSec;
+  return (int32_t)(local >= 0 ? local / 86400 : (local - 86399) / 86400);
+}
+
+bool parseForecast(Stream& input, ForecastData& out, time_t now, int32_t utcOffsetSec) {
+  if (!openList(input) || listEmpty(input)) {
+    Serial.println("No forecast data available");
+    return false;
+  }
+
+  // The filter describes one list element, read on its own
+  ArenaScope scope;
+  JsonDocument filter(&s_arena);
+  filter["dt"] = true;
+  filter["main"]["temp"] = true;
+  filter["main"]["temp_min"] = true;
+  filter["main"]["temp_max"] = true;
+  filter["weather"][0]["id"] = true;
+  filter["weather"][0]["main"] = true;
+  filter["weather"][0]["icon"] = true;
+
+  // Each slot goes into the same arena space: the previous one is
+  // cleared before the next is read
+  const size_t slotMark = s_arena.mark();
+  JsonDocument doc(&s_arena);
+  ConditionTally tally;
+  int32_t tomorrow = 0;
+  float tMin = NAN;
+  float tMax = NAN;
+  float prevTemp = NAN;
+  int firstGroup = -1;
+  size_t slot = 0;
+
+  out.maxStepC = 0;
+  out.conditionChange = false;
+  do {
+    doc.clear();
+    s_arena.release(slotMark);
+    DeserializationError err = deserializeJson(doc, input, DeserializationOption::Filter(filter));
+    if (err) {
+      Serial.printf("Forecast JSON parse failed at slot %u: %s\n", (unsigned)slot, err.c_str());
+      return false;
+    }
+    uint32_t dt = doc["dt"].as<uint32_t>();
+    float temp = doc["main"]["temp"].as<float>();
+    int id = doc["weather"][0]["id"].as<int>();
+    int group = conditionGroup(id);
+
+    if (slot == 0) {
+      // Clock not set yet: the first slot is close enough to now
+      if (now < 100000) now = dt;
+      tomorrow = localDay((uint32_t)now, utcOffsetSec) + 1;
+      firstGroup = group;
+    } else if (slot < FORECAST_TREND_SLOTS) {
+      // How fast things move over the next few slots
+      float step = fabsf(temp - prevTemp);
+      if (step > out.maxStepC) out.maxStepC = step;
+      if (group != firstGroup) out.conditionChange = true;
+    }
+    prevTemp = temp;
+
+    if (localDay(dt, utcOffsetSec) == tomorrow) {
+      float lo = doc["main"]["temp_min"].as<float>();
+      float hi = doc["main"]["temp_max"].as<float>();
+      if (isnan(tMin) || lo < tMin) tMin = lo;
+      if (isnan(tMax) || hi > tMax) tMax = hi;
+      if (id >= 200 && group < CONDITION_GROUPS && tally.count[group]++ == 0) {
+        tally.id[group] = id;
+        tally.main[group] = (const char*)doc["weather"][0]["main"];
+        tally.icon[group] = (const char*)doc["weather"][0]["icon"];
+      }
+    }
+    slot++;
+  } while (nextElement(input));
+
+  int best = -1;
+  for (int g = 0; g < CONDITION_GROUPS; g++) {
+    if (tally.count[g] == 0) continue;
+    if (best < 0 || tally.count[g] > tally.count[best] ||
+        (tally.count[g] == tally.count[best] && CONDITION_WEIGHT[g] > CONDITION_WEIGHT[best])) {
+      best = g;
+    }
+  }
+  if (best < 0) {
+    Serial.printf("Forecast: none of %u slots falls on tomorrow\n", (unsigned)slot);
+    return false;
+  }
+
+  out.tempMin   = tMin;
+  out.tempMax   = tMax;
+  out.weatherId = tally.id[best];
+  out.main      = tally.main[best].c_str();
+  out.iconCode  = tally.icon[best].c_str();
+  out.tomorrowStart = (uint32_t)((int64_t)tomorrow * 86400 - utcOffsetSec);
+  return true;
+}
+
+// ---------------- Several cities (group endpoint) ----------------
+// {"cnt":N,"list":[{city},{city},...]}, streamed like the forecast list.
+bool parseGroup(Stream& input, LocationSink sink, void* ctx, size_t& count) {
+  count = 0;
+  if (!openList(input)) {
+    Serial.println("Group JSON: no list");
+    return false;
+  }
+  if (listEmpty(input)) return true;
+
+  ArenaScope scope;
+  JsonDocument filter(&s_arena);
+  addWeatherFilter(filter);
+  filter["id"] = true;
+  filter["name"] = true;
+
+  const size_t cityMark = s_arena.mark();
+  JsonDocument doc(&s_arena);
+  LocationWeather loc;
+  do {
+    doc.clear();
+    s_arena.release(cityMark);
+    DeserializationError err = deserializeJson(doc, input, DeserializationOption::Filter(filter));
+    if (err) {
+      Serial.printf("Group JSON parse failed at city %u: %s\n", (unsigned)count, err.c_str());
+      return false;
+    }
+    loc.cityId = doc["id"].as<uint32_t>();
+    loc.name = (const char*)doc["name"];
+    readWeather(doc, loc.weather);
+    sink(ctx, count++, loc);
+  } while (input.findUntil(",", "]"));
+
+  return true;
+}
@@ -0,0 +1,311 @@
+#include <Arduino.h>
+#include <time.h>
+
+#include <Adafruit_GFX.h>
+#include <GxEPD2.h>
+#include <Fonts/FreeMonoBold9pt7b.h>
+#include <Fonts/FreeMonoBold12pt7b.h>
+#include <Fonts/FreeMonoBold18pt7b.h>
+
+#include "weather_render.h"
+#include "icon_sprites.h"
+#include "weather_history.h"
+#include "glyph_atlas.h"     // generated by tools/gen_glyph_atlas.py
+
+void renderBegin(FrameBuffer& frame) {
+  frame.addGlyphAtlas(&FreeMonoBold9pt7b, &ATLAS_FreeMonoBold9pt7b);
+  frame.addGlyphAtlas(&FreeMonoBold12pt7b, &ATLAS_FreeMonoBold12pt7b);
+  frame.addGlyphAtlas(&FreeMonoBold18pt7b, &ATLAS_FreeMonoBold18pt7b);
+}
+
+static void drawCenteredText(FrameBuffer& frame, int y, const char* text, const GFXfont* font) {
+  frame.setFont(font);
+  int16_t x1, y1;
+  uint16_t w, h;
+  frame.measureText(text, 0, y, &x1, &y1, &w, &h);
+  int x = (frame.width() - w) / 2 - x1;
+  frame.setCursor(x, y);
+  frame.print(text);
+}
+
+// One decimal, "--.-" when missing
+static void formatTemp(StrBuf& out, float v) {
+  out.clear();
+  if (isnan(v)) out.append("--.-");
+  else out.appendFixed(v, 1);
+}
+
+// ---------------- Weather icons (pre-rasterized, see icon_sprites.h) ----------------
+static void drawIcon(FrameBuffer& frame, const Sprite& s, int x, int y) {
+  frame.drawSprite(s, x, y, GxEPD_BLACK);
+}
+
+void drawWeatherIcon(FrameBuffer& frame, int x, int y, const StrBuf& iconCode, int weatherId, const StrBuf& main) {
+  // Icon code mapping from OpenWeather API
+  // Always use night icons per user preference (ignore day/night suffix)
+  // Icon codes: 01=clear, 02=few clouds, 03=scattered, 04=broken, 09=shower rain,
+  //             10=rain, 11=thunderstorm, 13=snow, 50=mist
+
+  if (iconCode.length() >= 2) {
+    FixedString<3> baseIcon;
+    baseIcon.append(iconCode.c_str(), 2);
+
+    if (baseIcon == "01") { drawIcon(frame, SPRITE_SUN, x, y); return; }   // Clear
+    if (baseIcon == "02") { drawIcon(frame, SPRITE_CLOUD, x, y); return; } // Few clouds
+    if (baseIcon == "03") { drawIcon(frame, SPRITE_SNOW, x, y); return; }  // Scattered clouds -> Snow per user request
+    if (baseIcon == "04") { drawIcon(frame, SPRITE_CLOUD, x, y); return; } // Broken clouds
+    if (baseIcon == "09") { drawIcon(frame, SPRITE_RAIN, x, y); return; }  // Shower rain
+    if (baseIcon == "10") { drawIcon(frame, SPRITE_RAIN, x, y); return; }  // Rain
+    if (baseIcon == "11") { drawIcon(frame, SPRITE_STORM, x, y); return; } // Thunderstorm
+    if (baseIcon == "13") { drawIcon(frame, SPRITE_SNOW, x, y); return; }  // Snow
+    if (baseIcon == "50") { drawIcon(frame, SPRITE_MIST, x, y); return; }  // Mist
+  }
+
+  // Fallback to weather ID based drawing
+  if (weatherId >= 200 && weatherId < 300) { drawIcon(frame, SPRITE_STORM, x, y); return; }
+  if (weatherId >= 300 && weatherId < 600) { drawIcon(frame, SPRITE_RAIN, x, y);  return; }
+  if (weatherId >= 600 && weatherId < 700) { drawIcon(frame, SPRITE_SNOW, x, y);  return; }
+  if (weatherId >= 700 && weatherId < 800) { drawIcon(frame, SPRITE_MIST, x, y);  return; }
+  if (weatherId == 800) { drawIcon(frame, SPRITE_SUN, x, y); return; }
+  if (weatherId > 800 && weatherId < 900) { drawIcon(frame, SPRITE_CLOUD, x, y); return; }
+
+  // Final fallback
+  if (main == "Clear") drawIcon(frame, SPRITE_SUN, x, y);
+  else if (main == "Clouds") drawIcon(frame, SPRITE_CLOUD, x, y);
+  else if (main == "Rain" || main == "Drizzle") drawIcon(frame, SPRITE_RAIN, x, y);
+  else if (main == "Thunderstorm") drawIcon(frame, SPRITE_STORM, x, y);
+  else if (main == "Snow") drawIcon(frame, SPRITE_SNOW, x, y);
+  else drawIcon(frame, SPRITE_MIST, x, y);
+}
+
+// ---------------- Chrome ----------------
+static void continueAt(FrameBuffer& frame, const ChromeCursor& c) {
+  frame.setFont(&FreeMonoBold9pt7b);
+  frame.setCursor(c.x, c.y);
+}
+
+static ChromeCursor cursorNow(const FrameBuffer& frame) {
+  return ChromeCursor{ frame.getCursorX(), frame.getCursorY() };
+}
+
+void drawDetailChrome(FrameBuffer& frame, const char* city, ViewChrome& chrome) {
+  frame.setRotation(1);
+  frame.fillScreen(GxEPD_WHITE);
+  frame.setTextColor(GxEPD_BLACK);
+
+  // ---- Header ----
+  frame.setFont(&FreeMonoBold9pt7b);
+  frame.setCursor(8, 16);
+  frame.print("Today: ");
+  frame.print(city);
+
+  // small divider line
+  frame.drawLine(0, 38, frame.width(), 38, GxEPD_BLACK);
+
+  // ---- Min/Max labels ----
+  frame.setFont(&FreeMonoBold9pt7b);
+  frame.setCursor(10, 118);
+  frame.print("Min: ");
+  chrome.minEnd = cursorNow(frame);
+
+  frame.setCursor(130, 118);
+  frame.print("Max: ");
+  chrome.maxEnd = cursorNow(frame);
+
+  chrome.view = VIEW_DETAIL;
+}
+
+void drawSplitChrome(FrameBuffer& frame, const char* city, ViewChrome& chrome) {
+  frame.setRotation(1);
+  frame.fillScreen(GxEPD_WHITE);
+  frame.setTextColor(GxEPD_BLACK);
+
+  // ---- Header ----
+  frame.setFont(&FreeMonoBold9pt7b);
+  frame.setCursor(8, 16);
+  frame.print(city);
+  frame.print(" ");
+  chrome.headerEnd = cursorNow(frame);
+
+  // ---- Divider line below header ----
+  frame.drawLine(0, 22, frame.width(), 22, GxEPD_BLACK);
+
+  // ---- VERTICAL DIVIDER ----
+  int dividerX = frame.width() / 2;
+  frame.drawLine(dividerX, 28, dividerX, frame.height(), GxEPD_BLACK);
+
+  // ---- TOMORROW'S FORECAST (Right side) ----
+  frame.setFont(&FreeMonoBold9pt7b);
+  frame.setCursor(dividerX + 8, 28);
+  frame.print("Tomorrow");
+
+  frame.setCursor(dividerX + 8, 88);
+  frame.print("Min: ");
+  chrome.minEnd = cursorNow(frame);
+
+  frame.setCursor(dividerX + 8, 106);
+  frame.print("Max: ");
+  chrome.maxEnd = cursorNow(frame);
+
+  chrome.view = VIEW_SPLIT;
+}
+
+// ---------------- Data passes ----------------
+// Corner flag over data that could not be refreshed (last-good records)
+static void drawStaleMark(FrameBuffer& frame) {
+  int x = frame.width() - 1;
+  frame.fillTriangle(x - 13, 0, x, 0, x, 13, GxEPD_BLACK);
+}
+
+// ---- Temperature history (left of the big temperature) ----
+// One bar per reading, at a fixed column per sequence number: a new
+// reading changes its own column and blanks the next (the oldest one
+// dropped), so the frame diff keeps the refresh to that sliver. The scale
+// moves in 5 degree steps and only when a reading leaves it.
+static const int SPARK_X = 4;
+static const int SPARK_Y = 42;
+static const int SPARK_H = 28;
+static const int SPARK_COLUMNS = HISTORY_SIZE + 1;
+static const int SPARK_STEP_CENTI = 500;
+
+static int floorTo(int v, int step) {
+  return (v >= 0 ? v : v - step + 1) / step * step;
+}
+
+static void drawHistory(FrameBuffer& frame) {
+  size_t count = historyCount();
+  if (count == 0) return;
+
+  PackedReading r;
+  uint32_t seq;
+  int lo = INT16_MAX, hi = INT16_MIN;
+  for (size_t i = 0; i < count && historyAt(i, r, seq); i++) {
+    if (r.tempCenti < lo) lo = r.tempCenti;
+    if (r.tempCenti > hi) hi = r.tempCenti;
+  }
+  lo = floorTo(lo, SPARK_STEP_CENTI);
+  hi = floorTo(hi, SPARK_STEP_CENTI) + SPARK_STEP_CENTI;
+  if (hi - lo < 2 * SPARK_STEP_CENTI) hi = lo + 2 * SPARK_STEP_CENTI;
+
+  int bottom = SPARK_Y + SPARK_H - 1;
+  frame.drawFastHLine(SPARK_X, SPARK_Y + SPARK_H, SPARK_COLUMNS, GxEPD_BLACK);
+  for (size_t i = 0; i < count && historyAt(i, r, seq); i++) {
+    int x = SPARK_X + (int)(seq % SPARK_COLUMNS);
+    int y = bottom - (r.tempCenti - lo) * (SPARK_H - 1) / (hi - lo);
+    frame.drawFastVLine(x, y, bottom - y + 1, GxEPD_BLACK);
+  }
+}
+
+void renderWeather(FrameBuffer& frame, const ViewChrome& chrome, const WeatherData& w, bool stale, bool history) {
+  // Prepare strings (with decimals)
+  FixedString<12> tempNow, tMin, tMax;
+  formatTemp(tempNow, w.temp);
+  formatTemp(tMin, w.tempMin);
+  formatTemp(tMax, w.tempMax);
+
+  // Format timestamp
+  char timeStr[16] = "--:--";
+  char dateStr[16] = "--/--";
+  if (w.timestamp > 0) {
+    time_t t = w.timestamp;
+    struct tm* tm_info = localtime(&t);
+    strftime(timeStr, sizeof(timeStr), "%H:%M", tm_info);
+    strftime(dateStr, sizeof(dateStr), "%d/%m/%y", tm_info);
+  }
+
+  FixedString<16> bigLine;
+  bigLine.append(tempNow.c_str()).append('C');
+
+  frame.setTextColor(GxEPD_BLACK);
+  if (stale) drawStaleMark(frame);
+
+  // ---- Timestamp line (under header) ----
+  frame.setFont(&FreeMonoBold9pt7b);
+  frame.setCursor(8, 32);
+  frame.print(dateStr);
+  frame.print(" ");
+  frame.print(timeStr);
+
+  // ---- Icon (right side) ----
+  drawWeatherIcon(frame, frame.width() - 66, 42, w.iconCode, w.weatherId, w.main);
+
+  if (history) drawHistory(frame);
+
+  // ---- Big temperature (centered) ----
+  // Keep it away from the icon area by centering but it’s fine visually on 2.13"
+  frame.setTextColor(GxEPD_BLACK);
+  drawCenteredText(frame, 70, bigLine.c_str(), &FreeMonoBold18pt7b);
+
+  // ---- Condition line ----
+  frame.setFont(&FreeMonoBold12pt7b);
+  // You can use w.description if you want (but it can be long)
+  const char* cond = (!w.main.empty() ? w.main.c_str() : "Weather");
+  drawCenteredText(frame, 95, cond, &FreeMonoBold12pt7b);
+
+  // ---- Min/Max values ----
+  continueAt(frame, chrome.minEnd);
+  frame.print(tMin.c_str());
+  frame.print("C");
+
+  continueAt(frame, chrome.maxEnd);
+  frame.print(tMax.c_str());
+  frame.print("C");
+}
+
+// ===== Split-screen render for night mode =====
+void renderWeatherSplitScreen(FrameBuffer& frame, const ViewChrome& chrome, const WeatherData& current,
+                              const ForecastData& tomorrow, bool stale) {
+  // Format current temperature
+  FixedString<12> tempNow;
+  formatTemp(tempNow, current.temp);
+
+  // Format tomorrow temps
+  FixedString<12> tMin, tMax;
+  formatTemp(tMin, tomorrow.tempMin);
+  formatTemp(tMax, tomorrow.tempMax);
+
+  // Format timestamp
+  char timeStr[16] = "--:--";
+  if (current.timestamp > 0) {
+    time_t t = current.timestamp;
+    struct tm* tm_info = localtime(&t);
+    strftime(timeStr, sizeof(timeStr), "%H:%M", tm_info);
+  }
+
+  frame.setTextColor(GxEPD_BLACK);
+  if (stale) drawStaleMark(frame);
+
+  // ---- Header time (after the city) ----
+  continueAt(frame, chrome.headerEnd);
+  frame.print(timeStr);
+
+  // ---- CURRENT WEATHER (Left side) ----
+  // Small icon for current weather
+  drawWeatherIcon(frame, 8, 28, current.iconCode, current.weatherId, current.main);
+
+  // Current temperature (centered on left half)
+  frame.setFont(&FreeMonoBold12pt7b);
+  frame.setCursor(12, 90);
+  frame.print(tempNow.c_str());
+  frame.print("C");
+
+  // Current condition
+  frame.setFont(&FreeMonoBold9pt7b);
+  frame.setCursor(8, 105);
+  frame.print(!current.main.empty() ? current.main.c_str() : "Weather");
+
+  // ---- TOMORROW'S FORECAST (Right side) ----
+  int dividerX = frame.width() / 2;
+
+  // Small icon for tomorrow
+  drawWeatherIcon(frame, dividerX + 12, 28, tomorrow.iconCode, tomorrow.weatherId, tomorrow.main);
+
+  // Tomorrow temps
+  continueAt(frame, chrome.minEnd);
+  frame.print(tMin.c_str());
+  frame.print("C");
+
+  continueAt(frame, chrome.maxEnd);
+  frame.print(tMax.c_str());
+  frame.print("C");
+}
@@ -0,0 +1,53 @@
+#include <string.h>
+
+#include "wifi_fast.h"
+
+static const uint32_t WIFI_CACHE_MAGIC = 0x57464331; // "WFC1"
+static const uint32_t POLL_MS = 10;
+
+bool wifiCacheValid(const WifiCache& cache) {
+  return cache.magic == WIFI_CACHE_MAGIC && cache.ssid[0] != '\0';
+}
+
+void wifiCacheClear(WifiCache& cache) {
+  memset(&cache, 0, sizeof(cache));
+}
+
+void wifiCacheStore(WifiCache& cache, const char* ssid, const char* pass,
+                    const uint8_t* bssid, uint8_t channel,
+                    uint32_t ip, uint32_t gateway, uint32_t subnet, uint32_t dns) {
+  wifiCacheClear(cache);
+  if (!ssid || strlen(ssid) >= sizeof(cache.ssid)) return;
+  if (pass && strlen(pass) >= sizeof(cache.pass)) return;
+
+  strcpy(cache.ssid, ssid);
+  if (pass) strcpy(cache.pass, pass);
+  if (bssid) memcpy(cache.bssid, bssid, sizeof(cache.bssid));
+  cache.channel = bssid ? channel : 0;
+
+  cache.haveLease = (ip != 0 && gateway != 0 && subnet != 0);
+  cache.ip = ip;
+  cache.gateway = gateway;
+  cache.subnet = subnet;
+  cache.dns = dns ? dns : gateway;
+  cache.magic = WIFI_CACHE_MAGIC;
+}
+
+bool wifiFastConnect(WifiRadio& radio, WifiCache& cache, bool staticIp, uint32_t timeoutMs) {
+  if (!wifiCacheValid(cache)) return false;
+
+  uint32_t t0 = radio.millis();
+  radio.begin(cache, staticIp && cache.haveLease);
+  while (true) {
+    RadioStatus s = radio.status();
+    if (s == RADIO_CONNECTED) return true;
+    if (s == RADIO_FAILED || radio.millis() - t0 >= timeoutMs) break;
+    radio.sleep(POLL_MS);
+  }
+
+  // AP moved channel, password changed, lease taken...: let the next
+  // attempt (and the next wake) go the slow way and re-learn it
+  radio.stop();
+  wifiCacheClear(cache);
+  return false;
+}
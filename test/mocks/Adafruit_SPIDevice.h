@@ -0,0 +1,4 @@
+#pragma once
+
+// Adafruit GFX includes Adafruit BusIO unconditionally; nothing on the
+// host uses it (see lib_ignore in platformio.ini)
@@ -0,0 +1,202 @@
+#pragma once
+
+// ===== Host stand-in for the Arduino core =====
+// Just enough of Arduino-ESP32 for the hardware-independent modules to
+// build in the native env (platformio.ini): Print/Stream with the
+// parsing helpers the JSON and HTTP code use, a Serial that writes to
+// stdout, millis()/delay() on the host clock. ARDUINO stays undefined, so
+// code with a host path (background_job, tls_client) takes it.
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define IRAM_ATTR
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_pointer(addr) ((void*)*(void* const*)(addr))
+
+#define HIGH 0x1
+#define LOW 0x0
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+inline unsigned long millis() {
+  using namespace std::chrono;
+  static const steady_clock::time_point start = steady_clock::now();
+  return (unsigned long)duration_cast<milliseconds>(steady_clock::now() - start).count();
+}
+
+inline unsigned long micros() {
+  using namespace std::chrono;
+  static const steady_clock::time_point start = steady_clock::now();
+  return (unsigned long)duration_cast<microseconds>(steady_clock::now() - start).count();
+}
+
+inline void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+inline void yield() {}
+
+// newlib has it; glibc only since 2.38
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+inline size_t strlcpy(char* dst, const char* src, size_t size) {
+  size_t len = strlen(src);
+  if (size) {
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return len;
+}
+#endif
+
+class __FlashStringHelper;
+
+// Only what Adafruit GFX's String overloads need
+class String {
+public:
+  String(const char* s = "") : _s(s ? s : "") {}
+  const char* c_str() const { return _s.c_str(); }
+  unsigned int length() const { return (unsigned int)_s.size(); }
+
+private:
+  std::string _s;
+};
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t size) {
+    size_t n = 0;
+    while (size-- && write(*buf++)) n++;
+    return n;
+  }
+  size_t write(const char* s) { return s ? write((const uint8_t*)s, strlen(s)) : 0; }
+  size_t write(const char* buf, size_t size) { return write((const uint8_t*)buf, size); }
+  virtual void flush() {}
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v) { return printf("%d", v); }
+  size_t print(unsigned int v) { return printf("%u", v); }
+  size_t print(long v) { return printf("%ld", v); }
+  size_t print(unsigned long v) { return printf("%lu", v); }
+  size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+
+  size_t println() { return write("\r\n"); }
+  template <typename T>
+  size_t println(const T& v) { return print(v) + println(); }
+
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (n < 0) return 0;
+    return write((const uint8_t*)buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+  }
+};
+
+// Arduino's Stream: reads wait up to the timeout for the next byte
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long ms) { _timeout = ms; }
+  unsigned long getTimeout() const { return _timeout; }
+
+  size_t readBytes(char* buf, size_t len) {
+    size_t n = 0;
+    while (n < len) {
+      int c = timedRead();
+      if (c < 0) break;
+      buf[n++] = (char)c;
+    }
+    return n;
+  }
+  size_t readBytes(uint8_t* buf, size_t len) { return readBytes((char*)buf, len); }
+
+  bool find(const char* target) { return findUntil(target, nullptr); }
+
+  // Consumes the stream through `target`; false when `terminator` comes
+  // first (consumed too), or on timeout / end of stream. No heap, like
+  // the core's: the last 64 bytes are kept in a window on the stack.
+  bool findUntil(const char* target, const char* terminator) {
+    size_t tlen = strlen(target);
+    size_t elen = terminator ? strlen(terminator) : 0;
+    char seen[64];
+    size_t n = 0;
+    for (;;) {
+      int c = timedRead();
+      if (c < 0) return false;
+      if (n == sizeof(seen)) {
+        memmove(seen, seen + 1, sizeof(seen) - 1);
+        n--;
+      }
+      seen[n++] = (char)c;
+      if (endsWith(seen, n, target, tlen)) return true;
+      if (elen && endsWith(seen, n, terminator, elen)) return false;
+    }
+  }
+
+protected:
+  int timedRead() {
+    unsigned long start = millis();
+    do {
+      int c = read();
+      if (c >= 0) return c;
+      yield();
+    } while (millis() - start < _timeout);
+    return -1;
+  }
+
+private:
+  static bool endsWith(const char* s, size_t n, const char* tail, size_t len) {
+    return len && n >= len && memcmp(s + n - len, tail, len) == 0;
+  }
+
+  unsigned long _timeout = 1000;
+};
+
+// Serial logs go to stdout, so `pio test -v` shows them next to the results
+class HostSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  void end() {}
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  using Print::write;
+  size_t write(uint8_t c) override { return fputc(c, stdout) == EOF ? 0 : 1; }
+  size_t write(const uint8_t* buf, size_t size) override { return fwrite(buf, 1, size, stdout); }
+  void flush() override { fflush(stdout); }
+  operator bool() const { return true; }
+};
+
+inline HostSerial Serial;
+
+#include "IPAddress.h"
+#include "Client.h"
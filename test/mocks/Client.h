@@ -0,0 +1,15 @@
+#pragma once
+
+#include "Arduino.h"
+
+class Client : public Stream {
+public:
+  virtual int connect(IPAddress ip, uint16_t port) = 0;
+  virtual int connect(const char* host, uint16_t port) = 0;
+  using Print::write;
+  virtual int read(uint8_t* buf, size_t size) = 0;
+  using Stream::read;
+  virtual void stop() = 0;
+  virtual uint8_t connected() = 0;
+  virtual operator bool() = 0;
+};
@@ -0,0 +1,7 @@
+#pragma once
+
+// Host stand-in for GxEPD2's colour constants. Drawing targets FrameBuffer
+// (framebuffer.h), which stores the panel's own bit layout, so that and
+// the test's PBM dump (test/support/pbm.h) replace the driver.
+#define GxEPD_BLACK 0x0000
+#define GxEPD_WHITE 0xFFFF
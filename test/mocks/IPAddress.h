@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Host stand-in for the Arduino core's IPv4 address
+class IPAddress {
+public:
+  IPAddress() {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _b{ a, b, c, d } {}
+  // Network byte order, as lwIP keeps it
+  explicit IPAddress(uint32_t addr) {
+    for (int i = 0; i < 4; i++) _b[i] = (uint8_t)(addr >> (8 * i));
+  }
+
+  operator uint32_t() const {
+    return (uint32_t)_b[0] | (uint32_t)_b[1] << 8 | (uint32_t)_b[2] << 16 | (uint32_t)_b[3] << 24;
+  }
+  bool operator==(const IPAddress& o) const { return (uint32_t)*this == (uint32_t)o; }
+  bool operator!=(const IPAddress& o) const { return !(*this == o); }
+  uint8_t operator[](int i) const { return _b[i]; }
+  uint8_t& operator[](int i) { return _b[i]; }
+
+  bool fromString(const char* s) {
+    unsigned a, b, c, d;
+    char tail;
+    if (sscanf(s, "%u.%u.%u.%u%c", &a, &b, &c, &d, &tail) != 4 || a > 255 || b > 255 || c > 255 || d > 255) {
+      return false;
+    }
+    *this = IPAddress(a, b, c, d);
+    return true;
+  }
+
+private:
+  uint8_t _b[4] = { 0, 0, 0, 0 };
+};
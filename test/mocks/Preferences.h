@@ -0,0 +1,88 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Arduino.h"
+
+// ===== Host stand-in for NVS Preferences =====
+// Namespaces of key -> bytes in process memory, shared by every instance
+// like the real partition. Typed getters read back what the matching put
+// stored. Preferences::store() lets tests wipe or inspect it.
+class Preferences {
+public:
+  typedef std::map<std::string, std::map<std::string, std::vector<uint8_t>>> Store;
+  static Store& store() {
+    static Store s;
+    return s;
+  }
+
+  bool begin(const char* name, bool readOnly = false) {
+    if (readOnly && !store().count(name)) return false;   // NVS: no such namespace yet
+    _ns = &store()[name];
+    _readOnly = readOnly;
+    return true;
+  }
+  void end() { _ns = nullptr; }
+  bool clear() { return _ns && !_readOnly && (_ns->clear(), true); }
+  bool remove(const char* key) { return _ns && !_readOnly && _ns->erase(key) > 0; }
+  bool isKey(const char* key) const { return _ns && _ns->count(key); }
+
+  size_t putBytes(const char* key, const void* buf, size_t len) {
+    if (!_ns || _readOnly) return 0;
+    (*_ns)[key].assign((const uint8_t*)buf, (const uint8_t*)buf + len);
+    return len;
+  }
+  size_t getBytesLength(const char* key) const {
+    const std::vector<uint8_t>* v = find(key);
+    return v ? v->size() : 0;
+  }
+  size_t getBytes(const char* key, void* buf, size_t maxLen) const {
+    const std::vector<uint8_t>* v = find(key);
+    if (!v || v->size() > maxLen) return 0;
+    memcpy(buf, v->data(), v->size());
+    return v->size();
+  }
+
+  size_t putString(const char* key, const char* value) { return putBytes(key, value, strlen(value) + 1); }
+  size_t getString(const char* key, char* value, size_t maxLen) const { return getBytes(key, value, maxLen); }
+
+  size_t putBool(const char* key, bool v) { return put(key, v); }
+  size_t putUChar(const char* key, uint8_t v) { return put(key, v); }
+  size_t putShort(const char* key, int16_t v) { return put(key, v); }
+  size_t putUShort(const char* key, uint16_t v) { return put(key, v); }
+  size_t putUInt(const char* key, uint32_t v) { return put(key, v); }
+  size_t putFloat(const char* key, float v) { return put(key, v); }
+
+  bool getBool(const char* key, bool def = false) const { return get(key, def); }
+  uint8_t getUChar(const char* key, uint8_t def = 0) const { return get(key, def); }
+  int16_t getShort(const char* key, int16_t def = 0) const { return get(key, def); }
+  uint16_t getUShort(const char* key, uint16_t def = 0) const { return get(key, def); }
+  uint32_t getUInt(const char* key, uint32_t def = 0) const { return get(key, def); }
+  float getFloat(const char* key, float def = NAN) const { return get(key, def); }
+
+private:
+  const std::vector<uint8_t>* find(const char* key) const {
+    if (!_ns) return nullptr;
+    auto it = _ns->find(key);
+    return it == _ns->end() ? nullptr : &it->second;
+  }
+
+  template <typename T>
+  size_t put(const char* key, T v) {
+    return putBytes(key, &v, sizeof(v));
+  }
+
+  template <typename T>
+  T get(const char* key, T def) const {
+    const std::vector<uint8_t>* v = find(key);
+    if (!v || v->size() != sizeof(T)) return def;
+    T out;
+    memcpy(&out, v->data(), sizeof(T));
+    return out;
+  }
+
+  std::map<std::string, std::vector<uint8_t>>* _ns = nullptr;
+  bool _readOnly = false;
+};
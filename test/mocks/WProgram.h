@@ -0,0 +1,4 @@
+#pragma once
+
+// Adafruit GFX includes this when ARDUINO is undefined (pre-1.0 cores)
+#include "Arduino.h"
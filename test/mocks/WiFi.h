@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Arduino.h"
+
+// Host stand-in for the WiFi singleton: only the resolver address, which
+// tests set to where their stub DNS server "listens" (see WiFiUdp.h)
+class WiFiClass {
+public:
+  IPAddress dnsIP(uint8_t = 0) const { return _dns; }
+  void setDnsIP(const IPAddress& ip) { _dns = ip; }   // host only
+
+private:
+  IPAddress _dns;
+};
+
+inline WiFiClass WiFi;
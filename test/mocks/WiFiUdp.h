@@ -0,0 +1,55 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "Arduino.h"
+
+// Host stand-in for WiFiUDP. Nothing reaches the network: a datagram sent
+// with endPacket() goes to WiFiUDP::server, installed by the test, and its
+// reply (if any) comes back as a packet from the same address and port.
+class WiFiUDP {
+public:
+  typedef std::function<std::vector<uint8_t>(const IPAddress& to, uint16_t port, const std::vector<uint8_t>& packet)>
+      Server;
+  static inline Server server;
+  static inline int packetsSent = 0;
+
+  uint8_t begin(uint16_t) { return 1; }
+  void stop() { _rx.clear(); }
+
+  int beginPacket(IPAddress ip, uint16_t port) {
+    _to = ip;
+    _toPort = port;
+    _tx.clear();
+    return 1;
+  }
+  size_t write(const uint8_t* buf, size_t size) {
+    _tx.insert(_tx.end(), buf, buf + size);
+    return size;
+  }
+  int endPacket() {
+    packetsSent++;
+    if (server) _rx = server(_to, _toPort, _tx);
+    _pos = 0;
+    return 1;
+  }
+
+  int parsePacket() { return (int)(_rx.size() - _pos); }
+  int read(uint8_t* buf, size_t len) {
+    size_t n = _rx.size() - _pos < len ? _rx.size() - _pos : len;
+    memcpy(buf, _rx.data() + _pos, n);
+    _pos += n;
+    if (_pos == _rx.size()) _rx.clear(), _pos = 0;
+    return (int)n;
+  }
+  IPAddress remoteIP() const { return _to; }
+  uint16_t remotePort() const { return _toPort; }
+
+private:
+  IPAddress _to;
+  uint16_t _toPort = 0;
+  std::vector<uint8_t> _tx;
+  std::vector<uint8_t> _rx;
+  size_t _pos = 0;
+};
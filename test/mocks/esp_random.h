@@ -0,0 +1,14 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+inline uint32_t esp_random() {
+  return (uint32_t)rand() << 16 ^ (uint32_t)rand();
+}
+
+inline void esp_fill_random(void* buf, size_t len) {
+  uint8_t* p = (uint8_t*)buf;
+  while (len--) *p++ = (uint8_t)rand();
+}
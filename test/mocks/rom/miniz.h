@@ -0,0 +1,55 @@
+#pragma once
+
+// ===== Host stand-in for the ROM's tinfl inflater =====
+// The slice of the miniz API GzipStream uses, on top of zlib's raw
+// inflate. zlib keeps its own history, so the caller's 32 KB window is
+// only an output buffer here; results are the same.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <zlib.h>
+
+#define TINFL_LZ_DICT_SIZE 32768
+#define TINFL_FLAG_HAS_MORE_INPUT 2
+
+typedef enum {
+  TINFL_STATUS_FAILED = -1,
+  TINFL_STATUS_DONE = 0,
+  TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+  TINFL_STATUS_HAS_MORE_OUTPUT = 2,
+} tinfl_status;
+
+typedef struct {
+  z_stream z;
+  uint32_t live;   // TINFL_HOST_LIVE while z holds an inflate state
+} tinfl_decompressor;
+
+#define TINFL_HOST_LIVE 0x7a6c6976u
+
+inline void tinfl_init(tinfl_decompressor* r) {
+  if (r->live == TINFL_HOST_LIVE) inflateEnd(&r->z);
+  memset(r, 0, sizeof(*r));
+  if (inflateInit2(&r->z, -15) == Z_OK) r->live = TINFL_HOST_LIVE;
+}
+
+inline tinfl_status tinfl_decompress(tinfl_decompressor* r, const uint8_t* in, size_t* inSize, uint8_t*,
+                                     uint8_t* next, size_t* outSize, uint32_t flags) {
+  if (r->live != TINFL_HOST_LIVE) return TINFL_STATUS_FAILED;
+  r->z.next_in = (Bytef*)in;
+  r->z.avail_in = (uInt)*inSize;
+  r->z.next_out = next;
+  r->z.avail_out = (uInt)*outSize;
+  int ret = inflate(&r->z, Z_NO_FLUSH);
+  *inSize -= r->z.avail_in;
+  *outSize -= r->z.avail_out;
+
+  if (ret == Z_STREAM_END) {
+    inflateEnd(&r->z);
+    r->live = 0;
+    return TINFL_STATUS_DONE;
+  }
+  if (ret != Z_OK && ret != Z_BUF_ERROR) return TINFL_STATUS_FAILED;
+  if (r->z.avail_out == 0) return TINFL_STATUS_HAS_MORE_OUTPUT;
+  return (flags & TINFL_FLAG_HAS_MORE_INPUT) ? TINFL_STATUS_NEEDS_MORE_INPUT : TINFL_STATUS_FAILED;
+}
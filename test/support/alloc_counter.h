@@ -0,0 +1,112 @@
+#pragma once
+
+// ===== Heap accounting for host tests =====
+// Wraps the C allocator so a test can read how much heap a piece of code
+// held at its worst, the number the ESP32's ~300 KB of DRAM cares about:
+//
+//   HeapUse use = measureHeap("parseForecast", [&] { parseForecast(in, f, now, 0); });
+//
+// Bytes are counted as malloc_usable_size() reports them, which is what
+// the allocator really hands out. operator new goes through malloc, so
+// C++ containers are counted too.
+//
+// glibc only. This defines malloc() and friends, so include it from
+// exactly one file of a suite (its test_main.cpp).
+
+#include <malloc.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include <atomic>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t n, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t align, size_t size);
+void __libc_free(void* ptr);
+}
+
+struct HeapUse {
+  size_t peak;          // bytes above the level at the start
+  size_t allocations;   // malloc/calloc/realloc calls
+};
+
+namespace heap_counter {
+inline std::atomic<size_t> g_live{ 0 };
+inline std::atomic<size_t> g_peak{ 0 };
+inline std::atomic<size_t> g_calls{ 0 };
+
+inline void add(void* p) {
+  if (!p) return;
+  size_t live = g_live.fetch_add(malloc_usable_size(p)) + malloc_usable_size(p);
+  size_t peak = g_peak.load();
+  while (live > peak && !g_peak.compare_exchange_weak(peak, live)) {}
+}
+
+inline void remove(void* p) {
+  if (p) g_live.fetch_sub(malloc_usable_size(p));
+}
+}  // namespace heap_counter
+
+extern "C" {
+void* malloc(size_t size) {
+  void* p = __libc_malloc(size);
+  heap_counter::g_calls++;
+  heap_counter::add(p);
+  return p;
+}
+
+void* calloc(size_t n, size_t size) {
+  void* p = __libc_calloc(n, size);
+  heap_counter::g_calls++;
+  heap_counter::add(p);
+  return p;
+}
+
+void* realloc(void* ptr, size_t size) {
+  size_t old = ptr ? malloc_usable_size(ptr) : 0;
+  void* p = __libc_realloc(ptr, size);
+  heap_counter::g_calls++;
+  if (p || size == 0) heap_counter::g_live.fetch_sub(old);
+  heap_counter::add(p);
+  return p;
+}
+
+void free(void* ptr) {
+  heap_counter::remove(ptr);
+  __libc_free(ptr);
+}
+
+// Aligned allocations are freed through free() too, so they must be counted
+void* memalign(size_t align, size_t size) {
+  void* p = __libc_memalign(align, size);
+  heap_counter::add(p);
+  return p;
+}
+
+void* aligned_alloc(size_t align, size_t size) {
+  return memalign(align, size);
+}
+
+int posix_memalign(void** out, size_t align, size_t size) {
+  void* p = memalign(align, size);
+  if (!p) return 12;   // ENOMEM
+  *out = p;
+  return 0;
+}
+}
+
+// Peak heap of `fn` over what was live when it started, printed as
+//
+//   HEAP parseForecast                     1184 B in 23 allocations
+template <typename Fn>
+HeapUse measureHeap(const char* name, Fn&& fn) {
+  size_t base = heap_counter::g_live.load();
+  size_t calls = heap_counter::g_calls.load();
+  heap_counter::g_peak.store(base);
+  fn();
+  HeapUse use = { heap_counter::g_peak.load() - base, heap_counter::g_calls.load() - calls };
+  printf("HEAP  %-32s %9zu B in %zu allocations\n", name, use.peak, use.allocations);
+  return use;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+// ===== Host benchmarks =====
+// Median wall time of a piece of code over a few hundred runs, printed as
+// one line per case so runs can be diffed:
+//
+//   BENCH renderWeather                  38.2 us
+//
+// Budgets are set well above what a desktop CPU needs, so they only trip
+// on real regressions (an accidental O(n^2), a heap copy per call).
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+template <typename Fn>
+double benchMicros(const char* name, Fn&& fn, int runs = 300) {
+  using namespace std::chrono;
+  std::vector<double> us;
+  us.reserve(runs);
+  fn();   // warm-up: first-touch page faults, lazy statics
+  for (int i = 0; i < runs; i++) {
+    auto t0 = steady_clock::now();
+    fn();
+    us.push_back(duration<double, std::micro>(steady_clock::now() - t0).count());
+  }
+  std::nth_element(us.begin(), us.begin() + runs / 2, us.end());
+  double median = us[runs / 2];
+  printf("BENCH %-32s %9.1f us\n", name, median);
+  return median;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+// ===== Recorded payloads for host tests =====
+// Fixtures live in test/fixtures; `pio test` runs from the project
+// directory. FIXTURE_DIR in the environment points elsewhere.
+
+#include <Arduino.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+inline std::string fixturePath(const char* name) {
+  const char* dir = getenv("FIXTURE_DIR");
+  return std::string(dir ? dir : "test/fixtures") + "/" + name;
+}
+
+// Whole file, "" if missing (tests check for that first)
+inline std::string loadFixture(const char* name) {
+  std::ifstream in(fixturePath(name), std::ios::binary);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+// A payload served as a Stream, `chunk` bytes "arriving" per available()
+// so parsers see the short reads they get from the network
+class FixtureStream : public Stream {
+public:
+  explicit FixtureStream(std::string data, size_t chunk = 0) : _data(std::move(data)), _chunk(chunk) {
+    setTimeout(0);
+  }
+
+  int available() override {
+    size_t left = _data.size() - _pos;
+    return (int)(_chunk && left > _chunk ? _chunk : left);
+  }
+  int read() override { return _pos < _data.size() ? (uint8_t)_data[_pos++] : -1; }
+  int peek() override { return _pos < _data.size() ? (uint8_t)_data[_pos] : -1; }
+  size_t write(uint8_t) override { return 0; }
+
+  size_t position() const { return _pos; }
+  void rewind() { _pos = 0; }
+
+private:
+  std::string _data;
+  size_t _chunk;
+  size_t _pos = 0;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+// ===== Reference weather icons =====
+// The primitive drawing code drawWeatherIcon() used before the icons were
+// baked into sprites (icon_sprites.h), kept for the host tests only: the
+// sprites must match it pixel for pixel, and test_icons times both.
+
+#include <cmath>
+
+#include <Adafruit_GFX.h>
+#include <GxEPD2.h>
+
+#include "fixed_string.h"
+
+namespace icon_reference {
+
+static void drawSun(Adafruit_GFX& g, int cx, int cy) {
+  g.drawCircle(cx, cy, 12, GxEPD_BLACK);
+  for (int a = 0; a < 360; a += 30) {
+    float r = (float)((float)a * 0.017453292519943295); // Arduino's radians(), in double
+    int x1 = cx + (int)(std::cos(r) * 16);
+    int y1 = cy + (int)(std::sin(r) * 16);
+    int x2 = cx + (int)(std::cos(r) * 24);
+    int y2 = cy + (int)(std::sin(r) * 24);
+    g.drawLine(x1, y1, x2, y2, GxEPD_BLACK);
+  }
+}
+
+static void drawCloud(Adafruit_GFX& g, int x, int y) {
+  g.fillCircle(x + 16, y + 18, 12, GxEPD_BLACK);
+  g.fillCircle(x + 34, y + 14, 16, GxEPD_BLACK);
+  g.fillCircle(x + 52, y + 18, 12, GxEPD_BLACK);
+  g.fillRect  (x + 16, y + 18, 36, 18, GxEPD_BLACK);
+}
+
+static void drawRain(Adafruit_GFX& g, int x, int y) {
+  drawCloud(g, x, y);
+  for (int i = 0; i < 3; i++) {
+    int rx = x + 22 + i * 14;
+    g.drawLine(rx, y + 42, rx - 4, y + 54, GxEPD_BLACK);
+  }
+}
+
+static void drawStorm(Adafruit_GFX& g, int x, int y) {
+  drawCloud(g, x, y);
+  // lightning bolt
+  g.fillTriangle(x + 34, y + 36, x + 24, y + 56, x + 38, y + 56, GxEPD_BLACK);
+  g.fillTriangle(x + 38, y + 56, x + 30, y + 72, x + 48, y + 52, GxEPD_BLACK);
+}
+
+static void drawSnow(Adafruit_GFX& g, int x, int y) {
+  drawCloud(g, x, y);
+  for (int i = 0; i < 3; i++) {
+    int sx = x + 22 + i * 14;
+    int sy = y + 48;
+    g.drawLine(sx - 4, sy, sx + 4, sy, GxEPD_BLACK);
+    g.drawLine(sx, sy - 4, sx, sy + 4, GxEPD_BLACK);
+    g.drawLine(sx - 3, sy - 3, sx + 3, sy + 3, GxEPD_BLACK);
+    g.drawLine(sx - 3, sy + 3, sx + 3, sy - 3, GxEPD_BLACK);
+  }
+}
+
+static void drawMist(Adafruit_GFX& g, int x, int y) {
+  // simple fog lines
+  g.drawLine(x, y + 18, x + 70, y + 18, GxEPD_BLACK);
+  g.drawLine(x + 8, y + 30, x + 62, y + 30, GxEPD_BLACK);
+  g.drawLine(x, y + 42, x + 70, y + 42, GxEPD_BLACK);
+}
+
+// Same mapping as drawWeatherIcon()
+static void drawWeatherIcon(Adafruit_GFX& g, int x, int y, const StrBuf& iconCode, int weatherId, const StrBuf& main) {
+  if (iconCode.length() >= 2) {
+    FixedString<3> baseIcon;
+    baseIcon.append(iconCode.c_str(), 2);
+
+    if (baseIcon == "01") { drawSun(g, x + 36, y + 28); return; }
+    if (baseIcon == "02") { drawCloud(g, x, y); return; }
+    if (baseIcon == "03") { drawSnow(g, x, y); return; }
+    if (baseIcon == "04") { drawCloud(g, x, y); return; }
+    if (baseIcon == "09") { drawRain(g, x, y); return; }
+    if (baseIcon == "10") { drawRain(g, x, y); return; }
+    if (baseIcon == "11") { drawStorm(g, x, y); return; }
+    if (baseIcon == "13") { drawSnow(g, x, y); return; }
+    if (baseIcon == "50") { drawMist(g, x, y); return; }
+  }
+
+  if (weatherId >= 200 && weatherId < 300) { drawStorm(g, x, y); return; }
+  if (weatherId >= 300 && weatherId < 600) { drawRain(g, x, y);  return; }
+  if (weatherId >= 600 && weatherId < 700) { drawSnow(g, x, y);  return; }
+  if (weatherId >= 700 && weatherId < 800) { drawMist(g, x, y);  return; }
+  if (weatherId == 800) { drawSun(g, x + 36, y + 28); return; }
+  if (weatherId > 800 && weatherId < 900) { drawCloud(g, x, y); return; }
+
+  if (main == "Clear") drawSun(g, x + 36, y + 28);
+  else if (main == "Clouds") drawCloud(g, x, y);
+  else if (main == "Rain" || main == "Drizzle") drawRain(g, x, y);
+  else if (main == "Thunderstorm") drawStorm(g, x, y);
+  else if (main == "Snow") drawSnow(g, x, y);
+  else drawMist(g, x, y);
+}
+
+} // namespace icon_reference
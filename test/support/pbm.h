@@ -0,0 +1,45 @@
+#pragma once
+
+// ===== Frame capture =====
+// Writes a FrameBuffer as a binary PBM (P4) the way the panel shows it:
+// landscape, 250 x 122, as drawn with setRotation(1). Any image viewer
+// opens it; `pio test -e native -f test_bench` leaves the rendered views
+// in .pio/frames.
+
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include <string>
+
+#include "framebuffer.h"
+
+inline bool framePixelInk(const FrameBuffer& frame, int x, int y) {
+  // Rotation 1: landscape (x, y) is native (WIDTH - 1 - y, x); bit set = white
+  int nx = FRAME_WIDTH - 1 - y;
+  int ny = x;
+  const uint8_t* buf = frame.getBuffer();
+  return !(buf[ny * FRAME_STRIDE + nx / 8] & (0x80 >> (nx % 8)));
+}
+
+inline bool writePbm(const FrameBuffer& frame, const std::string& path) {
+  size_t slash = path.rfind('/');
+  if (slash != std::string::npos) {
+    std::string dir;
+    for (size_t i = 0; i <= slash; i++) {
+      dir += path[i];
+      if (path[i] == '/') mkdir(dir.c_str(), 0755);
+    }
+  }
+  FILE* f = fopen(path.c_str(), "wb");
+  if (!f) return false;
+  const int w = FRAME_HEIGHT, h = FRAME_WIDTH;
+  fprintf(f, "P4\n%d %d\n", w, h);
+  for (int y = 0; y < h; y++) {
+    uint8_t row[(FRAME_HEIGHT + 7) / 8] = {};
+    for (int x = 0; x < w; x++) {
+      if (framePixelInk(frame, x, y)) row[x / 8] |= 0x80 >> (x % 8);
+    }
+    fwrite(row, 1, sizeof(row), f);
+  }
+  return fclose(f) == 0;
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+// ===== Stand-in HTTP server on the loopback =====
+// Plays a script of responses to whatever requests arrive, in order, so
+// HttpSession can be driven over a real socket (the host TlsClient is
+// plain TCP). One connection at a time, like the device's session:
+//
+//   StubHttpServer srv;
+//   srv.reply(StubHttpServer::Reply::json(body));
+//   HttpSession s("127.0.0.1", srv.port());
+//
+// A reply can make the server hang up instead of answering, once, to
+// exercise the session's re-send of pipelined requests.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class StubHttpServer {
+public:
+  struct Reply {
+    int status = 200;
+    std::string headers;        // extra "Name: value\r\n" lines
+    std::string body;
+    size_t chunk = 0;           // > 0: Transfer-Encoding: chunked, pieces of this size
+    int delayMs = 0;            // before the response goes out
+    bool close = false;         // "Connection: close" and hang up after it
+    bool hangUp = false;        // first time: drop the connection instead of answering
+
+    static Reply json(std::string body, size_t chunk = 0) {
+      Reply r;
+      r.headers = "Content-Type: application/json\r\n";
+      r.body = std::move(body);
+      r.chunk = chunk;
+      return r;
+    }
+  };
+
+  StubHttpServer() {
+    _listen = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(_listen, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (bind(_listen, (sockaddr*)&addr, sizeof(addr)) == 0 && listen(_listen, 4) == 0 &&
+        getsockname(_listen, (sockaddr*)&addr, &len) == 0) {
+      _port = ntohs(addr.sin_port);
+    }
+    _thread = std::thread([this] { run(); });
+  }
+
+  ~StubHttpServer() {
+    _stop = true;
+    _thread.join();
+    close(_listen);
+  }
+
+  uint16_t port() const { return _port; }
+
+  void reply(Reply r) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _replies.push_back(std::move(r));
+  }
+
+  // Request heads as received, and how many connections were accepted
+  std::vector<std::string> requests() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _requests;
+  }
+  int connections() const { return _connections; }
+  size_t bytesSent() const { return _bytesSent; }
+
+private:
+  void run() {
+    while (!_stop) {
+      pollfd p = { _listen, POLLIN, 0 };
+      if (poll(&p, 1, 20) <= 0) continue;
+      int fd = accept(_listen, nullptr, nullptr);
+      if (fd < 0) continue;
+      _connections++;
+      serve(fd);
+      close(fd);
+    }
+  }
+
+  // Answers requests on one connection until either side closes it
+  void serve(int fd) {
+    std::string in;
+    while (!_stop) {
+      size_t end;
+      while ((end = in.find("\r\n\r\n")) == std::string::npos) {
+        pollfd p = { fd, POLLIN, 0 };
+        if (_stop) return;
+        if (poll(&p, 1, 20) <= 0) continue;
+        char buf[1024];
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) return;
+        in.append(buf, (size_t)n);
+      }
+      std::string head = in.substr(0, end + 4);
+      in.erase(0, end + 4);
+
+      Reply r;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_next >= _replies.size()) return;
+        Reply& next = _replies[_next];
+        if (next.hangUp) {
+          next.hangUp = false;
+          return;
+        }
+        _requests.push_back(head);
+        r = _replies[_next++];
+      }
+      if (r.delayMs) std::this_thread::sleep_for(std::chrono::milliseconds(r.delayMs));
+      if (!sendAll(fd, response(r)) || r.close) return;
+    }
+  }
+
+  static std::string response(const Reply& r) {
+    std::string out = "HTTP/1.1 " + std::to_string(r.status) + " Stub\r\n" + r.headers;
+    if (r.close) out += "Connection: close\r\n";
+    if (!r.chunk) {
+      out += "Content-Length: " + std::to_string(r.body.size()) + "\r\n\r\n" + r.body;
+      return out;
+    }
+    out += "Transfer-Encoding: chunked\r\n\r\n";
+    char size[16];
+    for (size_t i = 0; i < r.body.size(); i += r.chunk) {
+      size_t n = r.body.size() - i < r.chunk ? r.body.size() - i : r.chunk;
+      snprintf(size, sizeof(size), "%zx\r\n", n);
+      out += size;
+      out.append(r.body, i, n);
+      out += "\r\n";
+    }
+    return out + "0\r\n\r\n";
+  }
+
+  bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+      ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+      if (n <= 0) return false;
+      sent += (size_t)n;
+    }
+    _bytesSent += sent;
+    return true;
+  }
+
+  int _listen = -1;
+  uint16_t _port = 0;
+  std::thread _thread;
+  std::atomic<bool> _stop{ false };
+  std::mutex _mutex;
+  std::vector<Reply> _replies;
+  size_t _next = 0;
+  std::vector<std::string> _requests;
+  std::atomic<int> _connections{ 0 };
+  std::atomic<size_t> _bytesSent{ 0 };
+};
@@ -0,0 +1,104 @@
+// The wake's data path without the heap: building the request paths and
+// validator headers, parsing the recorded bodies and both render passes
+// of each view must not call malloc once. WiFi and TLS are not part of
+// this; they allocate inside the core.
+#include <Arduino.h>
+#include <GxEPD2.h>
+#include <unity.h>
+
+#include "alloc_counter.h"
+#include "fixed_string.h"
+#include "fixtures.h"
+#include "framebuffer.h"
+#include "http_session.h"
+#include "weather.h"
+#include "weather_cache.h"
+#include "weather_render.h"
+
+static const time_t FIXTURE_NOW = 1760004000;   // dt of owm_weather.json
+static const int32_t FIXTURE_UTC_OFFSET = 10800;
+
+static std::string s_weatherJson;
+static std::string s_forecastJson;
+static std::string s_groupJson;
+
+static FrameBuffer s_frame;
+static WeatherData s_weather;
+static ForecastData s_forecast;
+
+void setUp() {}
+void tearDown() {}
+
+static void assertNoAllocations(const HeapUse& use) {
+  TEST_ASSERT_EQUAL(0, use.allocations);
+  TEST_ASSERT_EQUAL(0, use.peak);
+}
+
+// What buildApiPath() and requestGroup() in main.cpp put together
+static void test_request_paths() {
+  assertNoAllocations(measureHeap("request paths", [] {
+    FixedString<HTTP_MAX_PATH> path;
+    path.append("/data/2.5/").append("forecast");
+    path.append("?q=").appendUrlEncoded("Be'er Sheva,IL");
+    path.append("&appid=").appendUrlEncoded("0123456789abcdef0123456789abcdef");
+    path.append("&units=").append("metric");
+    TEST_ASSERT_FALSE(path.overflowed());
+
+    path.clear();
+    path.append("/data/2.5/group?id=").append("524901,703448,2643743");
+    path.append("&appid=").appendUrlEncoded("0123456789abcdef0123456789abcdef");
+
+    FixedString<HTTP_MAX_HEADERS> headers;
+    cacheValidatorHeaders(CACHE_WEATHER, headers);
+    cacheValidatorHeaders(CACHE_FORECAST, headers);
+  }));
+}
+
+static void countCity(void* ctx, size_t, LocationWeather&) {
+  ++*(size_t*)ctx;
+}
+
+static void test_parse() {
+  FixtureStream weather(s_weatherJson);
+  FixtureStream forecast(s_forecastJson);
+  FixtureStream group(s_groupJson);
+  size_t count = 0, seen = 0;
+  assertNoAllocations(measureHeap("parse weather+forecast+group", [&] {
+    TEST_ASSERT_TRUE(parseWeather(weather, s_weather));
+    TEST_ASSERT_TRUE(parseForecast(forecast, s_forecast, FIXTURE_NOW, FIXTURE_UTC_OFFSET));
+    TEST_ASSERT_TRUE(parseGroup(group, countCity, &seen, count));
+  }));
+  TEST_ASSERT_EQUAL(count, seen);
+  TEST_ASSERT_GREATER_THAN(0, count);
+}
+
+// Chrome then data, for each view, with the stale mark and history bars
+static void test_render() {
+  ViewChrome chrome;
+  assertNoAllocations(measureHeap("render detail", [&] {
+    s_frame.fillScreen(GxEPD_WHITE);
+    drawDetailChrome(s_frame, "Be'er Sheva", chrome);
+    renderWeather(s_frame, chrome, s_weather, true, true);
+  }));
+  assertNoAllocations(measureHeap("render split", [&] {
+    s_frame.fillScreen(GxEPD_WHITE);
+    drawSplitChrome(s_frame, "Be'er Sheva", chrome);
+    renderWeatherSplitScreen(s_frame, chrome, s_weather, s_forecast, true);
+  }));
+}
+
+int main(int, char**) {
+  setenv("TZ", "UTC", 1);
+  tzset();
+  s_weatherJson = loadFixture("owm_weather.json");
+  s_forecastJson = loadFixture("owm_forecast.json");
+  s_groupJson = loadFixture("owm_group.json");
+  s_frame.setRotation(1);
+  renderBegin(s_frame);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_request_paths);
+  RUN_TEST(test_parse);
+  RUN_TEST(test_render);
+  return UNITY_END();
+}
@@ -0,0 +1,106 @@
+// The boot overlap: panel init and the chrome pass in a BackgroundJob
+// while the caller blocks on a simulated WiFi connect, against the same
+// work one after the other. Waits are the wake profile's p50s
+// (test/fixtures/wake_profile.txt) scaled down 10x; the chrome is the
+// real pass into a FrameBuffer.
+#include <Arduino.h>
+#include <GxEPD2.h>
+#include <unity.h>
+
+#include <string.h>
+
+#include <chrono>
+#include <thread>
+
+#include "background_job.h"
+#include "framebuffer.h"
+#include "weather_render.h"
+
+static const uint32_t PANEL_INIT_MS = 16;   // display_init 162 ms
+static const uint32_t CONNECT_MS = 80;      // wifi 798 ms
+
+static FrameBuffer s_frame;
+static ViewChrome s_chrome;
+
+void setUp() {}
+void tearDown() {}
+
+static void blockFor(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// preparePanel() in main.cpp, with epd.init as a wait
+static void preparePanel(void*) {
+  blockFor(PANEL_INIT_MS);
+  drawDetailChrome(s_frame, "Springfield", s_chrome);
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static void test_job_runs_and_joins() {
+  BackgroundJob job;
+  job.join();   // not started: no-op
+  int ran = 0;
+  job.start("count", [](void* arg) { ++*(int*)arg; }, &ran);
+  job.join();
+  job.join();   // already joined: no-op
+  TEST_ASSERT_EQUAL(1, ran);
+}
+
+// Same chrome and cursors from the job as drawn inline
+static void test_job_chrome_matches_inline() {
+  static uint8_t inlineFrame[FRAME_BYTES];
+  s_frame.fillScreen(GxEPD_WHITE);
+  ViewChrome inlineChrome;
+  drawDetailChrome(s_frame, "Springfield", inlineChrome);
+  memcpy(inlineFrame, s_frame.getBuffer(), FRAME_BYTES);
+
+  s_frame.fillScreen(GxEPD_WHITE);
+  BackgroundJob job;
+  job.start("panelPrep", preparePanel, nullptr);
+  blockFor(CONNECT_MS);
+  job.join();
+  TEST_ASSERT_EQUAL_MEMORY(inlineFrame, s_frame.getBuffer(), FRAME_BYTES);
+  TEST_ASSERT_EQUAL(inlineChrome.minEnd.x, s_chrome.minEnd.x);
+  TEST_ASSERT_EQUAL(inlineChrome.maxEnd.y, s_chrome.maxEnd.y);
+}
+
+static void test_overlap_saving() {
+  const int runs = 5;
+  double serial = 0, overlapped = 0, jobMs = 0;
+  for (int i = 0; i < runs; i++) {
+    auto t0 = std::chrono::steady_clock::now();
+    preparePanel(nullptr);
+    blockFor(CONNECT_MS);
+    serial += elapsedMs(t0);
+
+    BackgroundJob job;
+    t0 = std::chrono::steady_clock::now();
+    job.start("panelPrep", preparePanel, nullptr);
+    blockFor(CONNECT_MS);
+    job.join();
+    overlapped += elapsedMs(t0);
+    jobMs += job.runMs();
+  }
+  serial /= runs;
+  overlapped /= runs;
+  jobMs /= runs;
+  printf("BENCH %-32s %9.1f ms\n", "init+chrome, then connect", serial);
+  printf("BENCH %-32s %9.1f ms\n", "init+chrome during connect", overlapped);
+  printf("BENCH %-32s %9.1f ms (job %.1f ms)\n", "saved", serial - overlapped, jobMs);
+  // Nearly all of the job hides behind the connect
+  TEST_ASSERT_GREATER_THAN_DOUBLE(PANEL_INIT_MS * 0.8, serial - overlapped);
+  TEST_ASSERT_LESS_THAN_DOUBLE(CONNECT_MS + PANEL_INIT_MS * 0.5, overlapped);
+}
+
+int main(int, char**) {
+  s_frame.setRotation(1);
+  renderBegin(s_frame);
+  UNITY_BEGIN();
+  RUN_TEST(test_job_runs_and_joins);
+  RUN_TEST(test_job_chrome_matches_inline);
+  RUN_TEST(test_overlap_saving);
+  return UNITY_END();
+}
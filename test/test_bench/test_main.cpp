@@ -0,0 +1,198 @@
+// Wake-cycle CPU costs on the host: the JSON parses of the fetch path and
+// the render passes, timed over recorded OpenWeather payloads. Each case
+// also checks its budget (bench.h), and the rendered views are written to
+// .pio/frames as PBM for a look at what the panel would show.
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <GxEPD2.h>
+#include <Fonts/FreeMonoBold9pt7b.h>
+#include <Fonts/FreeMonoBold12pt7b.h>
+#include <unity.h>
+
+#include "bench.h"
+#include "fixtures.h"
+#include "pbm.h"
+#include "weather.h"
+#include "weather_history.h"
+#include "weather_render.h"
+#include "glyph_atlas.h"     // generated by tools/gen_glyph_atlas.py
+
+static const char* FRAME_DIR = ".pio/frames/";
+static const time_t FIXTURE_NOW = 1760004000;   // dt of owm_weather.json
+static const int32_t FIXTURE_UTC_OFFSET = 10800;
+
+static std::string s_weatherJson;
+static std::string s_forecastJson;
+static WeatherData s_weather;
+static ForecastData s_forecast;
+static FrameBuffer s_frame;
+
+void setUp() {}
+void tearDown() {}
+
+// ---------------- Parse ----------------
+static void test_parse_weather() {
+  TEST_ASSERT_FALSE_MESSAGE(s_weatherJson.empty(), "owm_weather.json missing");
+  double us = benchMicros("parseWeather", [] {
+    FixtureStream in(s_weatherJson);
+    WeatherData w;
+    TEST_ASSERT_TRUE(parseWeather(in, w));
+  });
+  TEST_ASSERT_LESS_THAN_DOUBLE(2000.0, us);
+
+  FixtureStream in(s_weatherJson);
+  TEST_ASSERT_TRUE(parseWeather(in, s_weather));
+  s_weather.timestamp = FIXTURE_NOW;
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 27.43f, s_weather.temp);
+  TEST_ASSERT_EQUAL_STRING("Clouds", s_weather.main.c_str());
+}
+
+static void test_parse_forecast() {
+  TEST_ASSERT_FALSE_MESSAGE(s_forecastJson.empty(), "owm_forecast.json missing");
+  double us = benchMicros("parseForecast (40 slots)", [] {
+    FixtureStream in(s_forecastJson);
+    ForecastData f;
+    TEST_ASSERT_TRUE(parseForecast(in, f, FIXTURE_NOW, FIXTURE_UTC_OFFSET));
+  });
+  TEST_ASSERT_LESS_THAN_DOUBLE(10000.0, us);
+
+  FixtureStream in(s_forecastJson);
+  TEST_ASSERT_TRUE(parseForecast(in, s_forecast, FIXTURE_NOW, FIXTURE_UTC_OFFSET));
+  TEST_ASSERT_FALSE(isnan(s_forecast.tempMin));
+}
+
+// ---------------- Render ----------------
+static void test_render_weather() {
+  ViewChrome chrome;
+  double us = benchMicros("drawDetailChrome + renderWeather", [&] {
+    drawDetailChrome(s_frame, "Beer Sheva,IL", chrome);
+    renderWeather(s_frame, chrome, s_weather, false, false);
+  });
+  TEST_ASSERT_LESS_THAN_DOUBLE(2000.0, us);
+
+  drawDetailChrome(s_frame, "Beer Sheva,IL", chrome);
+  us = benchMicros("renderWeather (data pass)", [&] { renderWeather(s_frame, chrome, s_weather, false, false); });
+  TEST_ASSERT_LESS_THAN_DOUBLE(1000.0, us);
+  TEST_ASSERT_TRUE(writePbm(s_frame, std::string(FRAME_DIR) + "detail.pbm"));
+}
+
+static void test_render_split_screen() {
+  ViewChrome chrome;
+  double us = benchMicros("drawSplitChrome + renderWeatherSplitScreen", [&] {
+    drawSplitChrome(s_frame, "Beer Sheva,IL", chrome);
+    renderWeatherSplitScreen(s_frame, chrome, s_weather, s_forecast, false);
+  });
+  TEST_ASSERT_LESS_THAN_DOUBLE(2000.0, us);
+  TEST_ASSERT_TRUE(writePbm(s_frame, std::string(FRAME_DIR) + "split.pbm"));
+}
+
+// Last-good data on the home page: stale mark and two days of history bars
+static void test_render_stale_with_history() {
+  historyBegin("Beer Sheva,IL|metric");
+  WeatherData r = s_weather;
+  for (int i = 0; i < (int)HISTORY_SIZE; i++) {
+    r.timestamp = FIXTURE_NOW - (HISTORY_SIZE - i) * 3600;
+    r.temp = 22.0f + 6.0f * sinf(i * 0.26f);
+    historyAdd(r);
+  }
+  ViewChrome chrome;
+  double us = benchMicros("renderWeather (stale, history)", [&] {
+    drawDetailChrome(s_frame, "Beer Sheva,IL", chrome);
+    renderWeather(s_frame, chrome, s_weather, true, true);
+  });
+  TEST_ASSERT_LESS_THAN_DOUBLE(2000.0, us);
+  TEST_ASSERT_TRUE(writePbm(s_frame, std::string(FRAME_DIR) + "detail_stale_history.pbm"));
+}
+
+static void test_draw_weather_icon() {
+  static const char* ICONS[] = { "01n", "02n", "03n", "04n", "09n", "10n", "11n", "13n", "50n" };
+  ViewChrome chrome;
+  drawDetailChrome(s_frame, "", chrome);
+  double us = benchMicros("drawWeatherIcon x9", [] {
+    for (const char* icon : ICONS) {
+      FixedString<4> code = icon;
+      FixedString<16> main;
+      drawWeatherIcon(s_frame, s_frame.width() - 66, 42, code, -1, main);
+    }
+  });
+  TEST_ASSERT_LESS_THAN_DOUBLE(500.0, us);
+}
+
+// The layout's text through the glyph atlases and through plain Adafruit
+// GFX (a frame with no atlas registered). The fonts are `const` objects,
+// one copy per translation unit: the atlases are registered with this
+// file's, renderBegin() registers weather_render.cpp's.
+static void test_text_atlas_vs_gfx() {
+  static FrameBuffer atlased;
+  static FrameBuffer plain;
+  atlased.setRotation(1);
+  atlased.addGlyphAtlas(&FreeMonoBold9pt7b, &ATLAS_FreeMonoBold9pt7b);
+  atlased.addGlyphAtlas(&FreeMonoBold12pt7b, &ATLAS_FreeMonoBold12pt7b);
+  plain.setRotation(1);
+  auto drawText = [](FrameBuffer& f) {
+    f.setTextColor(GxEPD_BLACK);
+    f.setFont(&FreeMonoBold9pt7b);
+    f.setCursor(8, 16);
+    f.print("Today: Beer Sheva,IL");
+    f.setCursor(10, 118);
+    f.print("Min: 18.4C");
+    f.setFont(&FreeMonoBold12pt7b);
+    f.setCursor(60, 95);
+    f.print("Clouds");
+  };
+  double atlas = benchMicros("text, glyph atlas", [&] { drawText(atlased); });
+  double gfx = benchMicros("text, Adafruit GFX", [&] { drawText(plain); });
+  printf("BENCH text speedup                        %9.1fx\n", gfx / atlas);
+  TEST_ASSERT_LESS_THAN_DOUBLE(1000.0, atlas);
+  TEST_ASSERT_LESS_THAN_DOUBLE(gfx / 2, atlas);
+}
+
+// Both views as the renderer draws them: s_frame has renderBegin()'s
+// atlases, `plain` none, so its text goes through Adafruit GFX. The
+// frames must match and the atlas path must be faster.
+static void test_render_atlas_vs_gfx() {
+  static FrameBuffer plain;
+  plain.setRotation(1);
+  ViewChrome chrome;
+  auto detail = [&](FrameBuffer& f) {
+    f.fillScreen(GxEPD_WHITE);
+    drawDetailChrome(f, "Beer Sheva,IL", chrome);
+    renderWeather(f, chrome, s_weather, false, false);
+  };
+  auto split = [&](FrameBuffer& f) {
+    f.fillScreen(GxEPD_WHITE);
+    drawSplitChrome(f, "Beer Sheva,IL", chrome);
+    renderWeatherSplitScreen(f, chrome, s_weather, s_forecast, false);
+  };
+
+  double atlas = benchMicros("detail view, glyph atlas", [&] { detail(s_frame); });
+  double gfx = benchMicros("detail view, Adafruit GFX", [&] { detail(plain); });
+  TEST_ASSERT_EQUAL_MEMORY(plain.getBuffer(), s_frame.getBuffer(), FRAME_BYTES);
+  TEST_ASSERT_LESS_THAN_DOUBLE(gfx, atlas);
+
+  double atlasSplit = benchMicros("split view, glyph atlas", [&] { split(s_frame); });
+  double gfxSplit = benchMicros("split view, Adafruit GFX", [&] { split(plain); });
+  TEST_ASSERT_EQUAL_MEMORY(plain.getBuffer(), s_frame.getBuffer(), FRAME_BYTES);
+  TEST_ASSERT_LESS_THAN_DOUBLE(gfxSplit, atlasSplit);
+  printf("BENCH render speedup                      %9.1fx detail, %.1fx split\n", gfx / atlas, gfxSplit / atlasSplit);
+}
+
+int main(int, char**) {
+  setenv("TZ", "UTC", 1);
+  tzset();
+  s_weatherJson = loadFixture("owm_weather.json");
+  s_forecastJson = loadFixture("owm_forecast.json");
+  s_frame.setRotation(1);
+  renderBegin(s_frame);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_weather);
+  RUN_TEST(test_parse_forecast);
+  RUN_TEST(test_render_weather);
+  RUN_TEST(test_render_split_screen);
+  RUN_TEST(test_render_stale_with_history);
+  RUN_TEST(test_draw_weather_icon);
+  RUN_TEST(test_text_atlas_vs_gfx);
+  RUN_TEST(test_render_atlas_vs_gfx);
+  return UNITY_END();
+}
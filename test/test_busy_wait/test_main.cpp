@@ -0,0 +1,146 @@
+// The BUSY wait on a simulated panel line and a virtual clock: which wait
+// each callback takes, the guard timer splitting long refreshes, and the
+// CPU time left awake for a refresh with the radio up (as the fetch path
+// used to present) and with it off. Refresh lengths are the wake
+// profile's p50s (test/fixtures/wake_profile.txt).
+#include <unity.h>
+
+#include <stdio.h>
+
+#include "busy_wait.h"
+
+static const uint32_t PANEL_FULL_MS = 3169;
+static const uint32_t PANEL_PARTIAL_MS = 736;
+
+// BUSY stays at its busy level until busyUntil; both waits end there or
+// at the guard, whichever comes first
+class FakePanel : public BusyLine {
+public:
+  bool owner = true;
+  bool radioUp = false;
+  uint32_t now = 5000;
+  uint32_t busyUntil = 0;
+
+  int sleeps = 0;
+  int blocks = 0;
+  uint32_t awakeMs = 0;   // CPU running: blocked waits, other tasks on it
+
+  bool ownerTask() override { return owner; }
+  bool radioOff() override { return !radioUp; }
+  void lightSleep(uint32_t guardMs) override {
+    sleeps++;
+    now += waitMs(guardMs);
+  }
+  void block(uint32_t guardMs) override {
+    blocks++;
+    uint32_t ms = waitMs(guardMs);
+    now += ms;
+    awakeMs += ms;
+  }
+  uint32_t millis() override { return now; }
+
+  // GxEPD2's _waitWhileBusy(): the callback for as long as the line is busy
+  void refresh(uint32_t busyMs) {
+    busyUntil = now + busyMs;
+    while ((int32_t)(busyUntil - now) > 0) busyWaitOn(*this);
+  }
+
+private:
+  uint32_t waitMs(uint32_t guardMs) const {
+    uint32_t left = (int32_t)(busyUntil - now) > 0 ? busyUntil - now : 0;
+    return left < guardMs ? left : guardMs;
+  }
+};
+
+static FakePanel* s_panel;
+static uint32_t s_slept0, s_blocked0;
+
+void setUp() {
+  s_panel = new FakePanel();
+  s_slept0 = busyWaitSleptMs();
+  s_blocked0 = busyWaitBlockedMs();
+}
+void tearDown() { delete s_panel; }
+
+static uint32_t sleptMs() { return busyWaitSleptMs() - s_slept0; }
+static uint32_t blockedMs() { return busyWaitBlockedMs() - s_blocked0; }
+
+static void test_radio_off_light_sleeps() {
+  s_panel->refresh(PANEL_PARTIAL_MS);
+  TEST_ASSERT_EQUAL(1, s_panel->sleeps);
+  TEST_ASSERT_EQUAL(0, s_panel->blocks);
+  TEST_ASSERT_EQUAL_UINT32(PANEL_PARTIAL_MS, sleptMs());
+  TEST_ASSERT_EQUAL_UINT32(0, blockedMs());
+}
+
+static void test_radio_up_blocks() {
+  s_panel->radioUp = true;
+  s_panel->refresh(PANEL_PARTIAL_MS);
+  TEST_ASSERT_EQUAL(0, s_panel->sleeps);
+  TEST_ASSERT_EQUAL(1, s_panel->blocks);
+  TEST_ASSERT_EQUAL_UINT32(0, sleptMs());
+  TEST_ASSERT_EQUAL_UINT32(PANEL_PARTIAL_MS, blockedMs());
+}
+
+// The boot-time panel job: not the task busyWaitBegin() ran on
+static void test_other_task_blocks() {
+  s_panel->owner = false;
+  s_panel->refresh(PANEL_PARTIAL_MS);
+  TEST_ASSERT_EQUAL(0, s_panel->sleeps);
+  TEST_ASSERT_EQUAL_UINT32(PANEL_PARTIAL_MS, blockedMs());
+}
+
+// A full refresh outlasts the guard: woken each second, back to sleep
+static void test_guard_splits_long_refresh() {
+  s_panel->refresh(PANEL_FULL_MS);
+  TEST_ASSERT_EQUAL((PANEL_FULL_MS + BUSY_WAIT_GUARD_MS - 1) / BUSY_WAIT_GUARD_MS, s_panel->sleeps);
+  TEST_ASSERT_EQUAL_UINT32(PANEL_FULL_MS, sleptMs());
+}
+
+// Radio going off between two refreshes switches the wait over
+static void test_radio_off_between_refreshes() {
+  s_panel->radioUp = true;
+  s_panel->refresh(PANEL_PARTIAL_MS);
+  s_panel->radioUp = false;
+  s_panel->refresh(PANEL_PARTIAL_MS);
+  TEST_ASSERT_EQUAL(1, s_panel->blocks);
+  TEST_ASSERT_EQUAL(1, s_panel->sleeps);
+  TEST_ASSERT_EQUAL_UINT32(PANEL_PARTIAL_MS, sleptMs());
+  TEST_ASSERT_EQUAL_UINT32(PANEL_PARTIAL_MS, blockedMs());
+}
+
+static void test_millis_wrap() {
+  s_panel->now = 0xFFFFFFFFu - 300;
+  s_panel->refresh(PANEL_PARTIAL_MS);
+  TEST_ASSERT_EQUAL(1, s_panel->sleeps);
+  TEST_ASSERT_EQUAL_UINT32(PANEL_PARTIAL_MS, sleptMs());
+}
+
+// Awake CPU per fetch wake refresh, radio up through presentFrame() (the
+// DNS job still running) against off before it
+static void test_awake_cpu_per_refresh() {
+  const uint32_t refreshes[] = { PANEL_PARTIAL_MS, PANEL_FULL_MS };
+  const char* names[] = { "partial", "full" };
+  for (int i = 0; i < 2; i++) {
+    FakePanel up, off;
+    up.radioUp = true;
+    up.refresh(refreshes[i]);
+    off.refresh(refreshes[i]);
+    printf("BENCH %-32s %6lu ms awake radio up, %lu ms radio off\n", names[i],
+           (unsigned long)up.awakeMs, (unsigned long)off.awakeMs);
+    TEST_ASSERT_EQUAL_UINT32(refreshes[i], up.awakeMs);
+    TEST_ASSERT_EQUAL_UINT32(0, off.awakeMs);
+  }
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_radio_off_light_sleeps);
+  RUN_TEST(test_radio_up_blocks);
+  RUN_TEST(test_other_task_blocks);
+  RUN_TEST(test_guard_splits_long_refresh);
+  RUN_TEST(test_radio_off_between_refreshes);
+  RUN_TEST(test_millis_wrap);
+  RUN_TEST(test_awake_cpu_per_refresh);
+  return UNITY_END();
+}
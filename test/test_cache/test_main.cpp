@@ -0,0 +1,65 @@
+// Cache keys: the home records follow city + units, the other locations
+// their own ID list, so editing one does not throw away the other.
+#include <Arduino.h>
+#include <unity.h>
+
+#include "weather_cache.h"
+
+static const char* HOME = "Beer Sheva,IL|metric";
+
+void setUp() {}
+void tearDown() {}
+
+static void fillCache() {
+  WeatherData w;
+  w.temp = 27.4f;
+  w.main = "Clouds";
+  cacheStore(w, "\"w1\"", "");
+  LocationWeather loc;
+  loc.cityId = 293397;
+  loc.name = "Tel Aviv";
+  loc.weather = w;
+  cacheStoreLocation(0, loc);
+  cacheStoreGroup(1, "\"g1\"", "");
+}
+
+static void test_same_keys_keep_everything() {
+  cacheBegin(HOME, "metric|293397");
+  fillCache();
+  cacheBegin(HOME, "metric|293397");
+  WeatherData w;
+  TEST_ASSERT_TRUE(cacheLoad(w));
+  TEST_ASSERT_EQUAL(1, (int)cacheLocationCount());
+}
+
+static void test_new_id_list_drops_only_locations() {
+  cacheBegin(HOME, "metric|293397");
+  fillCache();
+  cacheBegin(HOME, "metric|293397,281184");
+  WeatherData w;
+  TEST_ASSERT_TRUE(cacheLoad(w));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 27.4f, w.temp);
+  TEST_ASSERT_TRUE(cacheFresh(CACHE_WEATHER, 600));
+  TEST_ASSERT_EQUAL(0, (int)cacheLocationCount());
+  TEST_ASSERT_FALSE(cacheFresh(CACHE_GROUP, 600));
+  FixedString<128> headers;
+  cacheValidatorHeaders(CACHE_GROUP, headers);
+  TEST_ASSERT_EQUAL_STRING("", headers.c_str());
+}
+
+static void test_new_home_drops_everything() {
+  cacheBegin(HOME, "metric|293397");
+  fillCache();
+  cacheBegin("Eilat,IL|metric", "metric|293397");
+  WeatherData w;
+  TEST_ASSERT_FALSE(cacheLoad(w));
+  TEST_ASSERT_EQUAL(0, (int)cacheLocationCount());
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_same_keys_keep_everything);
+  RUN_TEST(test_new_id_list_drops_only_locations);
+  RUN_TEST(test_new_home_drops_everything);
+  return UNITY_END();
+}
@@ -0,0 +1,179 @@
+// The RTC DNS cache against a stub resolver (WiFiUDP::server): lookups
+// and their TTLs, the CNAME-chain TTL, failures, and which entries the
+// background refresh looks up again. The clock is this file's time(),
+// stepped by the tests.
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <time.h>
+#include <unity.h>
+
+#include <map>
+#include <string>
+
+#include "dns_cache.h"
+
+static time_t s_now = 1760004000;
+
+extern "C" time_t time(time_t* t) {
+  if (t) *t = s_now;
+  return s_now;
+}
+
+struct StubRecord {
+  uint8_t addr[4];
+  uint32_t ttl;
+  uint32_t cnameTtl;   // > 0: answer through a CNAME with this TTL
+};
+
+static const IPAddress RESOLVER(192, 168, 1, 1);
+static std::map<std::string, StubRecord> s_zone;
+static std::map<std::string, int> s_queries;
+
+static void put16(std::vector<uint8_t>& out, uint32_t v) {
+  out.push_back((uint8_t)(v >> 8));
+  out.push_back((uint8_t)v);
+}
+
+static void put32(std::vector<uint8_t>& out, uint32_t v) {
+  put16(out, v >> 16);
+  put16(out, v & 0xffff);
+}
+
+// Answers an A query for a name in s_zone, NXDOMAIN otherwise
+static std::vector<uint8_t> resolver(const IPAddress& to, uint16_t port, const std::vector<uint8_t>& q) {
+  if (to != RESOLVER || port != 53 || q.size() < 17) return {};
+  std::string name;
+  size_t pos = 12;
+  while (pos < q.size() && q[pos]) {
+    if (!name.empty()) name += '.';
+    name.append((const char*)&q[pos + 1], q[pos]);
+    pos += 1 + q[pos];
+  }
+  size_t questionEnd = pos + 5;
+  s_queries[name]++;
+
+  std::vector<uint8_t> out(q.begin(), q.begin() + questionEnd);
+  out[2] = 0x81;   // response, RD
+  out[3] = 0x80;   // RA, rcode 0
+  auto it = s_zone.find(name);
+  if (it == s_zone.end()) {
+    out[3] |= 3;   // NXDOMAIN
+    return out;
+  }
+  const StubRecord& r = it->second;
+  out[7] = r.cnameTtl ? 2 : 1;
+  if (r.cnameTtl) {
+    // name CNAME "edge.<name>"; the A record's owner points at the target
+    size_t target = out.size() + 12;
+    put16(out, 0xc00c);
+    put16(out, 5);
+    put16(out, 1);
+    put32(out, r.cnameTtl);
+    put16(out, 7);
+    out.push_back(4);
+    out.insert(out.end(), { 'e', 'd', 'g', 'e' });
+    put16(out, 0xc00c);
+    put16(out, 0xc000 | (uint32_t)target);
+  } else {
+    put16(out, 0xc00c);
+  }
+  put16(out, 1);
+  put16(out, 1);
+  put32(out, r.ttl);
+  put16(out, 4);
+  out.insert(out.end(), r.addr, r.addr + 4);
+  return out;
+}
+
+void setUp() {
+  s_zone.clear();
+  s_queries.clear();
+  for (const char* host : { "api.example.org", "short.example.org", "cdn.example.org" }) dnsForget(host);
+}
+
+void tearDown() {}
+
+static void test_lookup_then_cached() {
+  s_zone["api.example.org"] = { { 10, 0, 0, 7 }, 600, 0 };
+  IPAddress ip;
+  bool cached = true;
+  TEST_ASSERT_TRUE(dnsResolve("api.example.org", ip, &cached));
+  TEST_ASSERT_FALSE(cached);
+  TEST_ASSERT_TRUE(ip == IPAddress(10, 0, 0, 7));
+
+  s_now += 599;
+  TEST_ASSERT_TRUE(dnsResolve("api.example.org", ip, &cached));
+  TEST_ASSERT_TRUE(cached);
+  TEST_ASSERT_EQUAL(1, s_queries["api.example.org"]);
+
+  s_now += 1;   // TTL over
+  TEST_ASSERT_TRUE(dnsResolve("api.example.org", ip, &cached));
+  TEST_ASSERT_FALSE(cached);
+  TEST_ASSERT_EQUAL(2, s_queries["api.example.org"]);
+}
+
+// The answer is only as durable as the shortest record leading to it
+static void test_cname_chain_ttl() {
+  s_zone["cdn.example.org"] = { { 10, 0, 0, 9 }, 3600, 30 };
+  IPAddress ip;
+  bool cached;
+  TEST_ASSERT_TRUE(dnsResolve("cdn.example.org", ip, &cached));
+  TEST_ASSERT_TRUE(ip == IPAddress(10, 0, 0, 9));
+  s_now += 31;
+  TEST_ASSERT_TRUE(dnsResolve("cdn.example.org", ip, &cached));
+  TEST_ASSERT_FALSE(cached);
+  TEST_ASSERT_EQUAL(2, s_queries["cdn.example.org"]);
+}
+
+static void test_failures_not_cached() {
+  IPAddress ip;
+  TEST_ASSERT_FALSE(dnsResolve("missing.example.org", ip));
+  TEST_ASSERT_FALSE(dnsResolve("missing.example.org", ip));
+  TEST_ASSERT_EQUAL(2, s_queries["missing.example.org"]);
+
+  int before = WiFiUDP::packetsSent;
+  TEST_ASSERT_TRUE(dnsResolve("203.0.113.5", ip));
+  TEST_ASSERT_TRUE(ip == IPAddress(203, 0, 113, 5));
+  TEST_ASSERT_EQUAL(before, WiFiUDP::packetsSent);   // literal: no query
+}
+
+// Horizon 30 min: the long-TTL entry about to run out is looked up again,
+// the one whose TTL can't cover 30 min is left to the next wake
+static void test_refresh_skips_short_ttl() {
+  s_zone["api.example.org"] = { { 10, 0, 0, 7 }, 3600, 0 };
+  s_zone["short.example.org"] = { { 10, 0, 0, 8 }, 60, 0 };
+  IPAddress ip;
+  TEST_ASSERT_TRUE(dnsResolve("api.example.org", ip));
+  TEST_ASSERT_TRUE(dnsResolve("short.example.org", ip));
+
+  s_now += 1000;   // api: 2600 s left, short: expired
+  dnsRefresh(1800);
+  TEST_ASSERT_EQUAL(1, s_queries["api.example.org"]);
+  TEST_ASSERT_EQUAL(1, s_queries["short.example.org"]);
+
+  s_now += 1000;   // api: 1600 s left
+  s_zone["api.example.org"].addr[3] = 17;
+  dnsRefresh(1800);
+  TEST_ASSERT_EQUAL(2, s_queries["api.example.org"]);
+  TEST_ASSERT_EQUAL(1, s_queries["short.example.org"]);
+
+  // The refreshed answer is what the next wake gets, from the cache
+  bool cached;
+  s_now += 1800;
+  TEST_ASSERT_TRUE(dnsResolve("api.example.org", ip, &cached));
+  TEST_ASSERT_TRUE(cached);
+  TEST_ASSERT_TRUE(ip == IPAddress(10, 0, 0, 17));
+}
+
+int main(int, char**) {
+  WiFi.setDnsIP(RESOLVER);
+  WiFiUDP::server = resolver;
+
+  UNITY_BEGIN();
+  RUN_TEST(test_lookup_then_cached);
+  RUN_TEST(test_cname_chain_ttl);
+  RUN_TEST(test_failures_not_cached);
+  RUN_TEST(test_refresh_skips_short_ttl);
+  return UNITY_END();
+}
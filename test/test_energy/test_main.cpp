@@ -0,0 +1,83 @@
+// The energy simulator on phase times measured by wake_report.py: the
+// profile loads, a month of wakes comes out at a plausible charge, and a
+// slower phase costs more. Prints the simulator's report for the profile.
+#include <unity.h>
+
+#include <string>
+
+#include "bench.h"
+#include "energy_sim.h"
+#include "fixtures.h"
+
+static std::string s_profile;
+
+void setUp() {}
+void tearDown() {}
+
+// test/fixtures/wake_profile.txt is `tools/wake_report.py --profile` over
+// test/fixtures/wake_log.txt
+static void test_profile_loads() {
+  SimConfig cfg;
+  TEST_ASSERT_EQUAL(11, simLoadProfile(cfg, s_profile.c_str()));
+  TEST_ASSERT_EQUAL_FLOAT(798, cfg.phases[SIM_WIFI].ms);
+  TEST_ASSERT_EQUAL_FLOAT(3169, cfg.phases[SIM_PANEL_FULL].ms);
+  TEST_ASSERT_EQUAL_FLOAT(736, cfg.phases[SIM_PANEL_PARTIAL].ms);
+  // Not in the trace: keeps its default
+  TEST_ASSERT_EQUAL_FLOAT(SimConfig().phases[SIM_BOOT].ms, cfg.phases[SIM_BOOT].ms);
+}
+
+static void test_unknown_phase() {
+  SimConfig cfg;
+  TEST_ASSERT_FALSE(simSetPhase(cfg, "panel", 100, false));
+  TEST_ASSERT_TRUE(simSetPhase(cfg, "panel_full", 3000, false));
+  TEST_ASSERT_EQUAL(-1, simLoadProfile(cfg, fixturePath("wake_log.txt").c_str()));
+  TEST_ASSERT_EQUAL(-1, simLoadProfile(cfg, fixturePath("no_such_profile.txt").c_str()));
+}
+
+// A wake every 30 min to 12 h at well under a second of radio: a few mAh a
+// day, not tenths and not tens
+static void test_month_on_profile() {
+  SimConfig cfg;
+  TEST_ASSERT_GREATER_THAN(0, simLoadProfile(cfg, s_profile.c_str()));
+  SimTotals tot;
+  simulate(cfg, tot);
+  simReport(cfg, tot);
+  double mah = simMahPerDay(cfg, tot);
+  TEST_ASSERT_GREATER_THAN(cfg.days * 2, tot.wakes);
+  TEST_ASSERT_LESS_THAN(cfg.days * 48 + 1, tot.wakes);
+  TEST_ASSERT_TRUE(mah > 0.5 && mah < 20);
+}
+
+static void test_slower_panel_costs_more() {
+  SimConfig cfg;
+  simLoadProfile(cfg, s_profile.c_str());
+  SimTotals base;
+  simulate(cfg, base);
+  cfg.phases[SIM_PANEL_FULL].ms *= 2;
+  SimTotals slow;
+  simulate(cfg, slow);
+  TEST_ASSERT_EQUAL(base.wakes, slow.wakes);   // same seed, same schedule
+  TEST_ASSERT_GREATER_THAN(0, (int)base.fulls);
+  TEST_ASSERT_GREATER_THAN(simMahPerDay(cfg, base), simMahPerDay(cfg, slow));
+}
+
+static void test_simulate_speed() {
+  SimConfig cfg;
+  simLoadProfile(cfg, s_profile.c_str());
+  benchMicros("simulate 30 days", [&] {
+    SimTotals tot;
+    simulate(cfg, tot);
+  }, 20);
+}
+
+int main(int, char**) {
+  s_profile = fixturePath("wake_profile.txt");
+
+  UNITY_BEGIN();
+  RUN_TEST(test_profile_loads);
+  RUN_TEST(test_unknown_phase);
+  RUN_TEST(test_month_on_profile);
+  RUN_TEST(test_slower_panel_costs_more);
+  RUN_TEST(test_simulate_speed);
+  return UNITY_END();
+}
@@ -0,0 +1,210 @@
+// The always-on mode's timer queue on a simulated clock: one-shot and
+// periodic timing, skipped periods, the millis() wrap, jobs rescheduling
+// themselves from inside runDue(), and how often nextDueIn() lets the
+// loop wake.
+#include <unity.h>
+
+#include "event_queue.h"
+
+static EventQueue* s_q;
+
+struct Log {
+  int runs = 0;
+  uint32_t lastAt = 0;
+};
+static uint32_t s_now;
+
+static void record(void* ctx) {
+  Log* log = (Log*)ctx;
+  log->runs++;
+  log->lastAt = s_now;
+}
+
+void setUp() {
+  s_q = new EventQueue();
+  s_now = 1000;
+}
+void tearDown() { delete s_q; }
+
+static int runAt(uint32_t t) {
+  s_now = t;
+  return s_q->runDue(t);
+}
+
+static void test_empty() {
+  TEST_ASSERT_EQUAL_UINT32(EventQueue::NEVER, s_q->nextDueIn(s_now));
+  TEST_ASSERT_EQUAL(0, runAt(5000));
+}
+
+static void test_one_shot() {
+  Log log;
+  s_q->schedule(s_now, 250, record, &log);
+  TEST_ASSERT_EQUAL_UINT32(250, s_q->nextDueIn(1000));
+  TEST_ASSERT_EQUAL_UINT32(1, s_q->nextDueIn(1249));
+  TEST_ASSERT_EQUAL(0, runAt(1249));
+  TEST_ASSERT_EQUAL(1, runAt(1250));
+  TEST_ASSERT_EQUAL(0, runAt(5000));   // once only
+  TEST_ASSERT_EQUAL(1, log.runs);
+  TEST_ASSERT_EQUAL_UINT32(EventQueue::NEVER, s_q->nextDueIn(s_now));
+}
+
+static void test_periodic_keeps_phase() {
+  Log log;
+  s_q->schedule(s_now, 100, record, &log, 1000);
+  TEST_ASSERT_EQUAL(1, runAt(1100));
+  TEST_ASSERT_EQUAL_UINT32(1000, s_q->nextDueIn(1100));
+  // Run late: the next is still on the original grid
+  TEST_ASSERT_EQUAL(1, runAt(2130));
+  TEST_ASSERT_EQUAL_UINT32(970, s_q->nextDueIn(2130));
+  TEST_ASSERT_EQUAL(2, log.runs);
+}
+
+static void test_missed_periods_skipped() {
+  Log log;
+  s_q->schedule(s_now, 1000, record, &log, 1000);
+  // Five periods late: runs once, next on the grid after now
+  TEST_ASSERT_EQUAL(1, runAt(6500));
+  TEST_ASSERT_EQUAL(1, log.runs);
+  TEST_ASSERT_EQUAL_UINT32(500, s_q->nextDueIn(6500));
+  // Exactly on a grid point counts as due, and the next is a period on
+  TEST_ASSERT_EQUAL(1, runAt(7000));
+  TEST_ASSERT_EQUAL_UINT32(1000, s_q->nextDueIn(7000));
+}
+
+static void test_earliest_first() {
+  static int order[3], n;
+  n = 0;
+  auto a = [](void*) { order[n++] = 'a'; };
+  auto b = [](void*) { order[n++] = 'b'; };
+  auto c = [](void*) { order[n++] = 'c'; };
+  s_q->schedule(s_now, 30, c);
+  s_q->schedule(s_now, 10, a);
+  s_q->schedule(s_now, 20, b);
+  TEST_ASSERT_EQUAL(3, runAt(2000));
+  TEST_ASSERT_EQUAL('a', order[0]);
+  TEST_ASSERT_EQUAL('b', order[1]);
+  TEST_ASSERT_EQUAL('c', order[2]);
+}
+
+// Due times either side of the wrap compare by signed distance
+static void test_across_wrap() {
+  Log log;
+  const uint32_t nearWrap = 0xFFFFFF00;
+  s_q->schedule(nearWrap, 0x200, record, &log, 0x200);   // due at 0x100
+  TEST_ASSERT_EQUAL_UINT32(0x200, s_q->nextDueIn(nearWrap));
+  TEST_ASSERT_EQUAL(0, runAt(0xFFFFFFFF));
+  TEST_ASSERT_EQUAL_UINT32(0x101, s_q->nextDueIn(0xFFFFFFFF));
+  TEST_ASSERT_EQUAL(1, runAt(0x100));
+  TEST_ASSERT_EQUAL_UINT32(0x200, s_q->nextDueIn(0x100));
+
+  // Overdue across the wrap: due before it, now after it
+  EventQueue q;
+  Log late;
+  q.schedule(0xFFFFFFF0, 8, record, &late);
+  TEST_ASSERT_EQUAL_UINT32(0, q.nextDueIn(0x10));
+  s_now = 0x10;
+  TEST_ASSERT_EQUAL(1, q.runDue(0x10));
+  TEST_ASSERT_EQUAL(1, late.runs);
+}
+
+struct SelfRescheduling {
+  EventQueue* q;
+  int id;
+  int runs;
+  uint32_t delay;
+};
+
+static void rescheduleSelf(void* ctx) {
+  SelfRescheduling* s = (SelfRescheduling*)ctx;
+  s->runs++;
+  s->q->reschedule(s->id, s_now, s->delay);
+}
+
+static void test_self_reschedule_runs_once_per_call() {
+  // Rescheduling for "now" from inside the job: not again in this call
+  SelfRescheduling now = { s_q, -1, 0, 0 };
+  now.id = s_q->schedule(s_now, 0, rescheduleSelf, &now);
+  TEST_ASSERT_EQUAL(1, runAt(1000));
+  TEST_ASSERT_EQUAL(1, now.runs);
+  TEST_ASSERT_EQUAL_UINT32(0, s_q->nextDueIn(1000));   // but due for the next call
+  TEST_ASSERT_EQUAL(1, runAt(1000));
+  TEST_ASSERT_EQUAL(2, now.runs);
+}
+
+static void test_self_reschedule_later() {
+  // A one-shot that re-arms itself is active again after running
+  SelfRescheduling later = { s_q, -1, 0, 300 };
+  later.id = s_q->schedule(s_now, 100, rescheduleSelf, &later);
+  TEST_ASSERT_EQUAL(1, runAt(1100));
+  TEST_ASSERT_EQUAL_UINT32(300, s_q->nextDueIn(1100));
+  TEST_ASSERT_EQUAL(1, runAt(1400));
+  TEST_ASSERT_EQUAL(2, later.runs);
+}
+
+static void cancelSelf(void* ctx) {
+  SelfRescheduling* s = (SelfRescheduling*)ctx;
+  s->runs++;
+  s->q->cancel(s->id);
+}
+
+static void test_periodic_cancels_itself() {
+  SelfRescheduling s = { s_q, -1, 0, 0 };
+  s.id = s_q->schedule(s_now, 100, cancelSelf, &s, 100);
+  TEST_ASSERT_EQUAL(1, runAt(1100));
+  TEST_ASSERT_EQUAL_UINT32(EventQueue::NEVER, s_q->nextDueIn(1100));
+  TEST_ASSERT_EQUAL(0, runAt(5000));
+}
+
+static void noop(void*) {}
+
+static void test_full() {
+  for (int i = 0; i < EventQueue::MAX_TIMERS; i++) TEST_ASSERT_EQUAL(i, s_q->schedule(s_now, 10, noop));
+  TEST_ASSERT_EQUAL(-1, s_q->schedule(s_now, 10, noop));
+  runAt(1010);   // one-shots done: their slots free up
+  TEST_ASSERT_EQUAL(0, s_q->schedule(s_now, 10, noop));
+}
+
+// The loop as main.cpp runs it: work, then idle for nextDueIn(). A 1 s
+// clock tick and a 60 s page rotation over an hour: the loop wakes only
+// when something is due, once for both when they coincide.
+static void test_duty_cycle() {
+  s_now = 0;
+  s_q->schedule(s_now, 1000, noop, nullptr, 1000);
+  s_q->schedule(s_now, 60000, noop, nullptr, 60000);
+
+  const uint32_t HOUR = 3600000, WORK_MS = 5;
+  int wakes = 0, runs = 0;
+  uint32_t awake = 0;
+  while (s_now < HOUR) {
+    uint32_t idle = s_q->nextDueIn(s_now);
+    TEST_ASSERT_NOT_EQUAL(EventQueue::NEVER, idle);
+    s_now += idle;
+    int ran = s_q->runDue(s_now);
+    TEST_ASSERT_GREATER_THAN(0, ran);   // never woken for nothing
+    runs += ran;
+    wakes++;
+    s_now += WORK_MS;
+    awake += WORK_MS;
+  }
+  TEST_ASSERT_EQUAL(3600, wakes);
+  TEST_ASSERT_EQUAL(3660, runs);
+  float duty = (float)awake / (float)s_now;
+  printf("duty cycle: %d wakes/h, %.2f %% awake at %u ms per wake\n", wakes, duty * 100, (unsigned)WORK_MS);
+  TEST_ASSERT_FLOAT_WITHIN(0.0005f, 0.005f, duty);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_empty);
+  RUN_TEST(test_one_shot);
+  RUN_TEST(test_periodic_keeps_phase);
+  RUN_TEST(test_missed_periods_skipped);
+  RUN_TEST(test_earliest_first);
+  RUN_TEST(test_across_wrap);
+  RUN_TEST(test_self_reschedule_runs_once_per_call);
+  RUN_TEST(test_self_reschedule_later);
+  RUN_TEST(test_periodic_cancels_itself);
+  RUN_TEST(test_full);
+  RUN_TEST(test_duty_cycle);
+  return UNITY_END();
+}
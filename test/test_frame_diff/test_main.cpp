@@ -0,0 +1,113 @@
+// Dirty rectangles between two frames: every changed pixel covered, x and
+// width on whole bytes, never more rectangles than asked for, and merges
+// that pick the pair wasting the least when rectangles overlap.
+#include <unity.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "frame_diff.h"
+#include "framebuffer.h"
+
+static uint8_t s_prev[FRAME_BYTES];
+static uint8_t s_next[FRAME_BYTES];
+
+void setUp() {
+  memset(s_prev, 0xFF, sizeof(s_prev));
+  memcpy(s_next, s_prev, sizeof(s_next));
+}
+void tearDown() {}
+
+// Flips the pixels of [x, x + w) x [y, y + h) in the next frame
+static void change(int x, int y, int w, int h) {
+  for (int row = y; row < y + h; row++) {
+    for (int col = x; col < x + w; col++) s_next[row * FRAME_STRIDE + col / 8] ^= 0x80 >> (col % 8);
+  }
+}
+
+static bool covered(const DirtyRect* rects, int count, int x, int y) {
+  for (int i = 0; i < count; i++) {
+    const DirtyRect& r = rects[i];
+    if (x >= r.x && x < r.x + r.w && y >= r.y && y < r.y + r.h) return true;
+  }
+  return false;
+}
+
+static void assertValid(const DirtyRect* rects, int count, int maxRects) {
+  TEST_ASSERT_LESS_OR_EQUAL(maxRects, count);
+  for (int i = 0; i < count; i++) {
+    TEST_ASSERT_EQUAL(0, rects[i].x % 8);
+    TEST_ASSERT_EQUAL(0, rects[i].w % 8);
+    TEST_ASSERT_LESS_OR_EQUAL(FRAME_STRIDE * 8, rects[i].x + rects[i].w);
+  }
+  for (int y = 0; y < FRAME_HEIGHT; y++) {
+    for (int x = 0; x < FRAME_WIDTH; x++) {
+      int i = y * FRAME_STRIDE + x / 8;
+      uint8_t bit = 0x80 >> (x % 8);
+      if ((s_prev[i] ^ s_next[i]) & bit) TEST_ASSERT_TRUE_MESSAGE(covered(rects, count, x, y), "pixel not covered");
+    }
+  }
+}
+
+static void test_identical() {
+  DirtyRect rects[4];
+  TEST_ASSERT_EQUAL(0, computeDirtyRects(s_prev, s_next, FRAME_WIDTH, FRAME_HEIGHT, rects, 4));
+}
+
+// The last column: whole bytes out to the padded row width
+static void test_right_edge_whole_bytes() {
+  change(FRAME_WIDTH - 1, 10, 1, 3);
+  DirtyRect rects[4];
+  int n = computeDirtyRects(s_prev, s_next, FRAME_WIDTH, FRAME_HEIGHT, rects, 4);
+  TEST_ASSERT_EQUAL(1, n);
+  TEST_ASSERT_EQUAL(120, rects[0].x);
+  TEST_ASSERT_EQUAL(8, rects[0].w);
+  assertValid(rects, n, 4);
+}
+
+// A, B, C far apart in rows; A and C narrow in the same column, B one
+// wide row between them. With two rectangles allowed, A and C merge
+// first (cheapest), and the union then overlaps B: that pair's cost must
+// count the overlap once instead of wrapping below zero
+static void test_overlapping_merge() {
+  change(0, 0, 8, 2);
+  change(0, 11, FRAME_WIDTH, 1);
+  change(0, 21, 8, 2);
+  change(64, 200, 16, 4);
+  DirtyRect rects[2];
+  int n = computeDirtyRects(s_prev, s_next, FRAME_WIDTH, FRAME_HEIGHT, rects, 2);
+  assertValid(rects, n, 2);
+  TEST_ASSERT_EQUAL(2, n);
+  // The three top bands end up in one rectangle, the far one stays alone
+  DirtyRect top = rects[0].y < rects[1].y ? rects[0] : rects[1];
+  DirtyRect bottom = rects[0].y < rects[1].y ? rects[1] : rects[0];
+  TEST_ASSERT_EQUAL(0, top.y);
+  TEST_ASSERT_EQUAL(23, top.h);
+  TEST_ASSERT_EQUAL(200, bottom.y);
+  TEST_ASSERT_EQUAL(16, bottom.w);
+}
+
+static void test_random_changes() {
+  srand(7);
+  for (int round = 0; round < 50; round++) {
+    setUp();
+    for (int k = rand() % 12; k >= 0; k--) {
+      int x = rand() % FRAME_WIDTH, y = rand() % FRAME_HEIGHT;
+      change(x, y, 1 + rand() % (FRAME_WIDTH - x), 1 + rand() % 4 % (FRAME_HEIGHT - y));
+    }
+    for (int maxRects : { 1, 2, 4 }) {
+      DirtyRect rects[4];
+      int n = computeDirtyRects(s_prev, s_next, FRAME_WIDTH, FRAME_HEIGHT, rects, maxRects);
+      assertValid(rects, n, maxRects);
+    }
+  }
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_identical);
+  RUN_TEST(test_right_edge_whole_bytes);
+  RUN_TEST(test_overlapping_merge);
+  RUN_TEST(test_random_changes);
+  return UNITY_END();
+}
@@ -0,0 +1,131 @@
+// The span rasterizer against Adafruit GFX's own per-pixel paths: every
+// shape the layouts use, in all four rotations, partly off screen, must
+// leave exactly the same bytes. Timings compare the two on a full frame.
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <GxEPD2.h>
+#include <unity.h>
+
+#include "bench.h"
+#include "framebuffer.h"
+
+// FrameBuffer with the span paths switched back to GFX's defaults, which
+// end in drawPixel() one pixel at a time
+class PixelFrame : public FrameBuffer {
+public:
+  void fillScreen(uint16_t c) override { Adafruit_GFX::fillScreen(c); }
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c) override {
+    Adafruit_GFX::fillRect(x, y, w, h, c);
+  }
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t c) override { Adafruit_GFX::drawFastHLine(x, y, w, c); }
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t c) override { Adafruit_GFX::drawFastVLine(x, y, h, c); }
+};
+
+static FrameBuffer s_spans;
+static PixelFrame s_pixels;
+
+void setUp() {}
+void tearDown() {}
+
+// Pixels only: the padding bits past native x 121 are never drawn
+static void assertSameFrame(const char* what) {
+  const uint8_t lastMask = (uint8_t)(0xFF00 >> (FRAME_WIDTH - (FRAME_STRIDE - 1) * 8));
+  for (uint32_t i = 0; i < FRAME_BYTES; i++) {
+    uint8_t mask = (i % FRAME_STRIDE == FRAME_STRIDE - 1) ? lastMask : 0xFF;
+    if ((s_spans.getBuffer()[i] ^ s_pixels.getBuffer()[i]) & mask) {
+      char msg[96];
+      snprintf(msg, sizeof(msg), "%s, rotation %u: byte %u (row %u) differs", what, s_spans.getRotation(),
+               (unsigned)i, (unsigned)(i / FRAME_STRIDE));
+      TEST_FAIL_MESSAGE(msg);
+    }
+  }
+}
+
+// Draws the same thing into both frames and compares them
+template <typename Fn>
+static void compare(const char* what, Fn&& draw) {
+  for (uint8_t r = 0; r < 4; r++) {
+    for (FrameBuffer* f : { (FrameBuffer*)&s_spans, (FrameBuffer*)&s_pixels }) {
+      f->setRotation(r);
+      f->fillScreen(GxEPD_WHITE);
+      draw(*f);
+    }
+    assertSameFrame(what);
+  }
+}
+
+static void test_fill_screen() {
+  compare("fillScreen black", [](FrameBuffer& f) { f.fillScreen(GxEPD_BLACK); });
+}
+
+// Every start bit and length around the byte and word boundaries
+static void test_rect_alignment() {
+  compare("fillRect sweep", [](FrameBuffer& f) {
+    for (int16_t x = 0; x < 40; x++) {
+      f.fillRect(x, x * 3 % 100, (x * 7) % 45 + 1, 2, GxEPD_BLACK);
+    }
+  });
+  compare("fillRect white on black", [](FrameBuffer& f) {
+    f.fillScreen(GxEPD_BLACK);
+    for (int16_t x = 0; x < 40; x++) f.fillRect(x * 2, x, 33 - x % 33, 3, GxEPD_WHITE);
+  });
+}
+
+static void test_clipping() {
+  compare("clipped shapes", [](FrameBuffer& f) {
+    f.fillRect(-10, -5, 30, 20, GxEPD_BLACK);
+    f.fillRect(f.width() - 7, f.height() - 3, 40, 40, GxEPD_BLACK);
+    f.drawFastHLine(-20, 40, f.width() + 40, GxEPD_BLACK);
+    f.drawFastVLine(30, -20, f.height() + 40, GxEPD_BLACK);
+    f.drawFastHLine(5, -1, 10, GxEPD_BLACK);
+    f.drawFastVLine(f.width(), 5, 10, GxEPD_BLACK);
+  });
+}
+
+// What the layouts draw: dividers, the stale mark, icon shapes
+static void test_gfx_shapes() {
+  compare("lines", [](FrameBuffer& f) {
+    f.drawLine(0, 38, f.width(), 38, GxEPD_BLACK);
+    f.drawLine(f.width() / 2, 28, f.width() / 2, f.height(), GxEPD_BLACK);
+    f.drawLine(3, 90, 70, 20, GxEPD_BLACK);
+    f.drawRect(10, 50, 37, 21, GxEPD_BLACK);
+  });
+  compare("circles", [](FrameBuffer& f) {
+    f.fillCircle(60, 60, 17, GxEPD_BLACK);
+    f.fillCircle(5, 5, 12, GxEPD_BLACK);
+    f.drawCircle(100, 40, 9, GxEPD_BLACK);
+    f.fillCircle(60, 60, 6, GxEPD_WHITE);
+  });
+  compare("triangles and round rects", [](FrameBuffer& f) {
+    int x = f.width() - 1;
+    f.fillTriangle(x - 13, 0, x, 0, x, 13, GxEPD_BLACK);
+    f.fillTriangle(20, 100, 45, 70, 61, 118, GxEPD_BLACK);
+    f.fillRoundRect(70, 75, 50, 30, 8, GxEPD_BLACK);
+  });
+}
+
+static void test_span_speed() {
+  auto scene = [](FrameBuffer& f) {
+    f.fillScreen(GxEPD_WHITE);
+    f.drawLine(0, 38, f.width(), 38, GxEPD_BLACK);
+    f.fillCircle(200, 70, 20, GxEPD_BLACK);
+    f.fillRoundRect(10, 80, 100, 30, 6, GxEPD_BLACK);
+    f.fillTriangle(236, 0, 249, 0, 249, 13, GxEPD_BLACK);
+  };
+  s_spans.setRotation(1);
+  s_pixels.setRotation(1);
+  double spans = benchMicros("shapes, spans", [&] { scene(s_spans); });
+  double pixels = benchMicros("shapes, per pixel", [&] { scene(s_pixels); });
+  printf("BENCH span speedup                        %9.1fx\n", pixels / spans);
+  TEST_ASSERT_LESS_THAN_DOUBLE(pixels, spans);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_fill_screen);
+  RUN_TEST(test_rect_alignment);
+  RUN_TEST(test_clipping);
+  RUN_TEST(test_gfx_shapes);
+  RUN_TEST(test_span_speed);
+  return UNITY_END();
+}
@@ -0,0 +1,152 @@
+// Text blitted from the glyph atlases against Adafruit GFX drawing the
+// same fonts bit by bit: every printable character of the three layout
+// fonts, at byte-aligned and odd positions, partly off screen, in all
+// four rotations, must leave the same bytes. measureText() must agree
+// with getTextBounds().
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <GxEPD2.h>
+#include <Fonts/FreeMonoBold9pt7b.h>
+#include <Fonts/FreeMonoBold12pt7b.h>
+#include <Fonts/FreeMonoBold18pt7b.h>
+#include <unity.h>
+
+#include "bench.h"
+#include "framebuffer.h"
+#include "glyph_atlas.h"     // generated by tools/gen_glyph_atlas.py
+
+struct AtlasFont {
+  const char* name;
+  const GFXfont* font;
+  const GlyphAtlas* atlas;
+};
+
+static const AtlasFont FONTS[] = {
+  { "FreeMonoBold9pt7b", &FreeMonoBold9pt7b, &ATLAS_FreeMonoBold9pt7b },
+  { "FreeMonoBold12pt7b", &FreeMonoBold12pt7b, &ATLAS_FreeMonoBold12pt7b },
+  { "FreeMonoBold18pt7b", &FreeMonoBold18pt7b, &ATLAS_FreeMonoBold18pt7b },
+};
+
+static FrameBuffer s_atlas;    // atlases registered (the fonts of this file)
+static FrameBuffer s_gfx;      // none: every glyph through Adafruit_GFX::write()
+
+void setUp() {}
+void tearDown() {}
+
+// Pixels only, as in test_framebuffer: padding bits are never drawn
+static void assertSameFrame(const char* what, const char* font, uint8_t c) {
+  const uint8_t lastMask = (uint8_t)(0xFF00 >> (FRAME_WIDTH - (FRAME_STRIDE - 1) * 8));
+  for (uint32_t i = 0; i < FRAME_BYTES; i++) {
+    uint8_t mask = (i % FRAME_STRIDE == FRAME_STRIDE - 1) ? lastMask : 0xFF;
+    if ((s_atlas.getBuffer()[i] ^ s_gfx.getBuffer()[i]) & mask) {
+      char msg[128];
+      snprintf(msg, sizeof(msg), "%s, %s '%c', rotation %u: byte %u (row %u) differs", what, font, c,
+               s_atlas.getRotation(), (unsigned)i, (unsigned)(i / FRAME_STRIDE));
+      TEST_FAIL_MESSAGE(msg);
+    }
+  }
+}
+
+// Draws the same thing into both frames and compares them
+template <typename Fn>
+static void compare(const char* what, const AtlasFont& f, uint8_t c, uint8_t rotation, Fn&& draw) {
+  for (FrameBuffer* fb : { &s_atlas, &s_gfx }) {
+    fb->setRotation(rotation);
+    fb->setFont(f.font);
+    fb->setTextSize(1);
+    fb->setTextWrap(false);
+    fb->fillScreen(GxEPD_WHITE);
+    fb->setTextColor(GxEPD_BLACK);
+    draw(*fb);
+  }
+  assertSameFrame(what, f.name, c);
+}
+
+// Each character alone, at x positions covering all eight bit offsets
+// along the native rows, and clipped at every edge
+static void test_every_character() {
+  for (const AtlasFont& f : FONTS) {
+    for (uint8_t r = 0; r < 4; r++) {
+      for (uint8_t c = 0x20; c < 0x7F; c++) {
+        compare("single glyph", f, c, r, [&](FrameBuffer& fb) {
+          int16_t w = fb.width(), h = fb.height();
+          const int at[][2] = {
+            { 0, 30 }, { 9, 31 }, { 18, 32 }, { 27, 45 }, { 36, 60 }, { 45, 61 }, { 54, 62 }, { 63, 63 },
+            { -6, 20 }, { w - 8, 40 }, { 20, 4 }, { 40, h + 6 },
+          };
+          for (const auto& p : at) {
+            fb.setCursor(p[0], p[1]);
+            fb.write(c);
+          }
+        });
+      }
+    }
+  }
+}
+
+// What the layouts print: runs of glyphs, white on black too
+static void test_strings() {
+  static const char* TEXT[] = { "Beer Sheva 14:05", "Min: -3.5C", "Max: 29.2C", "27.4C", "Clouds 80%" };
+  for (const AtlasFont& f : FONTS) {
+    for (uint8_t r = 0; r < 4; r++) {
+      compare("strings", f, ' ', r, [&](FrameBuffer& fb) {
+        int16_t y = 20;
+        for (const char* t : TEXT) {
+          fb.setCursor(3, y);
+          fb.print(t);
+          y += 24;
+        }
+        fb.fillRect(0, y - 18, fb.width(), 26, GxEPD_BLACK);
+        fb.setTextColor(GxEPD_WHITE);
+        fb.setCursor(5, y);
+        fb.print(TEXT[0]);
+      });
+    }
+  }
+}
+
+static void test_measure_text() {
+  static const char* TEXT[] = { "A", " ", "Beer Sheva", "-12.5C", "}{|~!", "" };
+  for (const AtlasFont& f : FONTS) {
+    s_atlas.setRotation(1);
+    s_atlas.setFont(f.font);
+    for (const char* t : TEXT) {
+      int16_t ax, ay, gx, gy;
+      uint16_t aw, ah, gw, gh;
+      s_atlas.measureText(t, 10, 60, &ax, &ay, &aw, &ah);
+      s_atlas.getTextBounds(t, 10, 60, &gx, &gy, &gw, &gh);
+      char msg[64];
+      snprintf(msg, sizeof(msg), "%s \"%s\"", f.name, t);
+      TEST_ASSERT_EQUAL_MESSAGE(gx, ax, msg);
+      TEST_ASSERT_EQUAL_MESSAGE(gy, ay, msg);
+      TEST_ASSERT_EQUAL_MESSAGE(gw, aw, msg);
+      TEST_ASSERT_EQUAL_MESSAGE(gh, ah, msg);
+    }
+  }
+}
+
+static void test_blit_speed() {
+  auto text = [](FrameBuffer& fb) {
+    fb.setRotation(1);
+    fb.setFont(&FreeMonoBold12pt7b);
+    fb.setCursor(2, 40);
+    fb.print("Beer Sheva 14:05");
+    fb.setCursor(2, 80);
+    fb.print("Min: -3.5C Max: 29.2C");
+  };
+  double blit = benchMicros("text, atlas", [&] { text(s_atlas); });
+  double bits = benchMicros("text, Adafruit GFX", [&] { text(s_gfx); });
+  printf("BENCH atlas speedup                       %9.1fx\n", bits / blit);
+  TEST_ASSERT_LESS_THAN_DOUBLE(bits, blit);
+}
+
+int main(int, char**) {
+  for (const AtlasFont& f : FONTS) s_atlas.addGlyphAtlas(f.font, f.atlas);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_every_character);
+  RUN_TEST(test_strings);
+  RUN_TEST(test_measure_text);
+  RUN_TEST(test_blit_speed);
+  return UNITY_END();
+}
@@ -0,0 +1,153 @@
+// gzip against plain over the loopback: the same forecast parsed either
+// way, with bytes on the wire and time per fetch, and the integrity
+// checks: a body cut short, a bad CRC or broken deflate data must fail
+// the fetch. The inflater is zlib standing in for the ROM's tinfl, so
+// inflate times here say nothing about the chip's.
+#include <Arduino.h>
+#include <unity.h>
+
+#include "bench.h"
+#include "fixtures.h"
+#include "gzip_stream.h"
+#include "http_session.h"
+#include "stub_http_server.h"
+#include "weather.h"
+
+static const char* HOST = "127.0.0.1";
+static const time_t FIXTURE_NOW = 1760004000;
+static const int32_t FIXTURE_UTC_OFFSET = 10800;
+
+static std::string s_forecastJson;
+static std::string s_forecastGz;   // gzip -9, mtime 0, of owm_forecast.json
+
+void setUp() {}
+void tearDown() {}
+
+static StubHttpServer::Reply gzipReply(std::string body, size_t chunk = 0) {
+  StubHttpServer::Reply r = StubHttpServer::Reply::json(std::move(body), chunk);
+  r.headers += "Content-Encoding: gzip\r\n";
+  return r;
+}
+
+// One forecast fetch the way fetchForecast() does it
+static bool fetchForecast(HttpSession& s, ForecastData& f) {
+  TEST_ASSERT_TRUE(s.send("/data/2.5/forecast?q=x"));
+  TEST_ASSERT_EQUAL(200, s.receive());
+  bool parsed = parseForecast(s.body(), f, FIXTURE_NOW, FIXTURE_UTC_OFFSET);
+  bool whole = s.skipBody();
+  return parsed && whole;
+}
+
+// ---------------- Stream level ----------------
+static void test_stream_inflates_fixture() {
+  TEST_ASSERT_FALSE_MESSAGE(s_forecastGz.empty(), "owm_forecast.json.gz missing");
+  FixtureStream in(s_forecastGz, 61);
+  GzipStream gz;
+  TEST_ASSERT_TRUE(gz.reserve());
+  gz.begin(&in);
+  std::string out;
+  for (int c; (c = gz.read()) >= 0;) out += (char)c;
+  TEST_ASSERT_TRUE(gz.complete());
+  TEST_ASSERT_EQUAL(s_forecastJson.size(), gz.produced());
+  TEST_ASSERT_TRUE(out == s_forecastJson);
+}
+
+// ---------------- Over HTTP ----------------
+static void test_gzip_matches_plain() {
+  StubHttpServer srv;
+  srv.reply(StubHttpServer::Reply::json(s_forecastJson));
+  srv.reply(gzipReply(s_forecastGz, 700));
+
+  HttpSession s(HOST, srv.port());
+  ForecastData plain, packed;
+  TEST_ASSERT_TRUE(fetchForecast(s, plain));
+  size_t plainWire = srv.bytesSent();
+  TEST_ASSERT_TRUE(fetchForecast(s, packed));
+  size_t gzipWire = srv.bytesSent() - plainWire;
+  s.close();
+
+  TEST_ASSERT_NOT_NULL(strstr(srv.requests()[0].c_str(), "Accept-Encoding: gzip"));
+  TEST_ASSERT_EQUAL(s_forecastGz.size(), s.lastStats().bodyBytes);
+  TEST_ASSERT_EQUAL(s_forecastJson.size(), s.lastStats().plainBytes);
+  TEST_ASSERT_EQUAL_FLOAT(plain.tempMin, packed.tempMin);
+  TEST_ASSERT_EQUAL_FLOAT(plain.tempMax, packed.tempMax);
+  TEST_ASSERT_EQUAL(plain.weatherId, packed.weatherId);
+  TEST_ASSERT_EQUAL(plain.tomorrowStart, packed.tomorrowStart);
+
+  printf("WIRE  forecast plain %6zu B, gzip %6zu B (%.0f%%)\n", plainWire, gzipWire,
+         100.0 * gzipWire / plainWire);
+  TEST_ASSERT_LESS_THAN(plainWire / 4, gzipWire);
+}
+
+// The trailer's last bytes never arrive; the connection closes cleanly
+static void test_truncated_fails() {
+  StubHttpServer srv;
+  StubHttpServer::Reply cut = gzipReply(s_forecastGz.substr(0, s_forecastGz.size() - 5));
+  srv.reply(cut);
+
+  HttpSession s(HOST, srv.port());
+  ForecastData f;
+  TEST_ASSERT_FALSE(fetchForecast(s, f));
+  s.close();
+}
+
+// Deflate data intact, CRC in the trailer wrong: the JSON parses fine,
+// the fetch must still fail
+static void test_bad_crc_fails() {
+  std::string body = s_forecastGz;
+  body[body.size() - 8] ^= 0x01;
+  StubHttpServer srv;
+  srv.reply(gzipReply(body));
+  srv.reply(gzipReply(s_forecastGz));
+
+  HttpSession s(HOST, srv.port());
+  ForecastData f;
+  TEST_ASSERT_FALSE(fetchForecast(s, f));
+  // Framing was fine: the connection stays usable
+  TEST_ASSERT_TRUE(fetchForecast(s, f));
+  s.close();
+  TEST_ASSERT_EQUAL(1, srv.connections());
+}
+
+static void test_corrupt_deflate_fails() {
+  std::string body = s_forecastGz;
+  for (size_t i = 100; i < 140; i++) body[i] ^= 0x5a;
+  StubHttpServer srv;
+  srv.reply(gzipReply(body));
+
+  HttpSession s(HOST, srv.port());
+  ForecastData f;
+  TEST_ASSERT_FALSE(fetchForecast(s, f));
+  s.close();
+}
+
+// Whole fetch + parse per encoding; bytes on the loopback cost nothing,
+// so this is the inflater's overhead, not what it saves on the radio
+static void test_fetch_timing() {
+  const int runs = 50;
+  StubHttpServer srv;
+  for (int i = 0; i < runs + 1; i++) srv.reply(StubHttpServer::Reply::json(s_forecastJson, 1400));
+  for (int i = 0; i < runs + 1; i++) srv.reply(gzipReply(s_forecastGz, 1400));
+
+  HttpSession s(HOST, srv.port());
+  ForecastData f;
+  double plain = benchMicros("fetch + parse forecast, plain", [&] { fetchForecast(s, f); }, runs);
+  double packed = benchMicros("fetch + parse forecast, gzip", [&] { fetchForecast(s, f); }, runs);
+  s.close();
+  printf("BENCH gzip / plain                        %9.2fx\n", packed / plain);
+  TEST_ASSERT_EQUAL(1, srv.connections());
+}
+
+int main(int, char**) {
+  s_forecastJson = loadFixture("owm_forecast.json");
+  s_forecastGz = loadFixture("owm_forecast.json.gz");
+
+  UNITY_BEGIN();
+  RUN_TEST(test_stream_inflates_fixture);
+  RUN_TEST(test_gzip_matches_plain);
+  RUN_TEST(test_truncated_fails);
+  RUN_TEST(test_bad_crc_fails);
+  RUN_TEST(test_corrupt_deflate_fails);
+  RUN_TEST(test_fetch_timing);
+  return UNITY_END();
+}
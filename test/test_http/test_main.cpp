@@ -0,0 +1,158 @@
+// HttpSession against a stand-in server on the loopback: both of a wake's
+// requests over one connection, chunked bodies, the re-send when the
+// server hangs up mid-pipeline, and the per-request stats. The host
+// TlsClient is plain TCP, so this covers the HTTP layer, not TLS.
+#include <Arduino.h>
+#include <unity.h>
+
+#include "bench.h"
+#include "fixtures.h"
+#include "http_session.h"
+#include "stub_http_server.h"
+#include "weather.h"
+
+static const char* HOST = "127.0.0.1";
+static const time_t FIXTURE_NOW = 1760004000;
+static const int32_t FIXTURE_UTC_OFFSET = 10800;
+
+static std::string s_weatherJson;
+static std::string s_forecastJson;
+
+void setUp() {}
+void tearDown() {}
+
+// What a night-mode wake does: both GETs out, then both responses parsed
+static void fetchBoth(HttpSession& s, WeatherData& w, ForecastData& f) {
+  TEST_ASSERT_TRUE(s.send("/data/2.5/weather?q=x"));
+  TEST_ASSERT_TRUE(s.send("/data/2.5/forecast?q=x"));
+  TEST_ASSERT_EQUAL(200, s.receive());
+  TEST_ASSERT_TRUE(parseWeather(s.body(), w));
+  TEST_ASSERT_EQUAL(200, s.receive());
+  TEST_ASSERT_TRUE(parseForecast(s.body(), f, FIXTURE_NOW, FIXTURE_UTC_OFFSET));
+  s.skipBody();
+}
+
+static void test_pipelined_on_one_connection() {
+  StubHttpServer srv;
+  srv.reply(StubHttpServer::Reply::json(s_weatherJson));
+  srv.reply(StubHttpServer::Reply::json(s_forecastJson));
+
+  HttpSession s(HOST, srv.port());
+  WeatherData w;
+  ForecastData f;
+  fetchBoth(s, w, f);
+  s.close();
+
+  TEST_ASSERT_EQUAL(1, srv.connections());
+  TEST_ASSERT_EQUAL(2, (int)srv.requests().size());
+  TEST_ASSERT_EQUAL(0, strncmp(srv.requests()[1].c_str(), "GET /data/2.5/forecast", 22));
+  TEST_ASSERT_NOT_NULL(strstr(srv.requests()[0].c_str(), "Connection: keep-alive"));
+  TEST_ASSERT_EQUAL(0, (int)s.lastStats().connectMs);   // paid by the first request only
+  TEST_ASSERT_EQUAL(s_weatherJson.size() + s_forecastJson.size(), s.totals().bodyBytes);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 27.43f, w.temp);
+}
+
+static void test_chunked_body() {
+  StubHttpServer srv;
+  srv.reply(StubHttpServer::Reply::json(s_weatherJson, 100));
+  srv.reply(StubHttpServer::Reply::json(s_forecastJson, 1400));
+
+  HttpSession s(HOST, srv.port());
+  WeatherData w;
+  ForecastData f;
+  fetchBoth(s, w, f);
+  TEST_ASSERT_EQUAL(s_forecastJson.size(), s.lastStats().bodyBytes);
+  // Chunk framing consumed exactly: the connection is still good for more
+  srv.reply(StubHttpServer::Reply::json(s_weatherJson));
+  TEST_ASSERT_TRUE(s.send("/data/2.5/weather?q=x"));
+  TEST_ASSERT_EQUAL(200, s.receive());
+  s.close();
+  TEST_ASSERT_EQUAL(1, srv.connections());
+}
+
+// The server answers the first request, then drops the connection with
+// the second one unanswered: it goes out again on a new connection
+static void test_resend_after_hang_up() {
+  StubHttpServer srv;
+  srv.reply(StubHttpServer::Reply::json(s_weatherJson));
+  StubHttpServer::Reply forecast = StubHttpServer::Reply::json(s_forecastJson);
+  forecast.hangUp = true;
+  srv.reply(forecast);
+
+  HttpSession s(HOST, srv.port());
+  WeatherData w;
+  ForecastData f;
+  fetchBoth(s, w, f);
+  s.close();
+
+  TEST_ASSERT_EQUAL(2, srv.connections());
+  TEST_ASSERT_EQUAL(2, (int)srv.requests().size());   // the dropped one is not counted
+  TEST_ASSERT_FALSE(isnan(f.tempMin));
+}
+
+// "Connection: close" ends reuse; the next request opens a new connection
+static void test_connection_close() {
+  StubHttpServer srv;
+  StubHttpServer::Reply first = StubHttpServer::Reply::json(s_weatherJson);
+  first.close = true;
+  srv.reply(first);
+  srv.reply(StubHttpServer::Reply::json(s_weatherJson));
+
+  HttpSession s(HOST, srv.port());
+  WeatherData w;
+  TEST_ASSERT_TRUE(s.send("/data/2.5/weather?q=x"));
+  TEST_ASSERT_EQUAL(200, s.receive());
+  TEST_ASSERT_TRUE(parseWeather(s.body(), w));
+  TEST_ASSERT_TRUE(s.send("/data/2.5/weather?q=x"));
+  TEST_ASSERT_EQUAL(200, s.receive());
+  s.close();
+  TEST_ASSERT_EQUAL(2, srv.connections());
+}
+
+static void test_latency_stats() {
+  StubHttpServer srv;
+  StubHttpServer::Reply slow = StubHttpServer::Reply::json(s_weatherJson);
+  slow.delayMs = 40;
+  srv.reply(slow);
+
+  HttpSession s(HOST, srv.port());
+  TEST_ASSERT_TRUE(s.send("/data/2.5/weather?q=x"));
+  TEST_ASSERT_EQUAL(200, s.receive());
+  s.skipBody();
+  TEST_ASSERT_GREATER_OR_EQUAL(38, (int)s.lastStats().ttfbMs);
+  TEST_ASSERT_EQUAL(s_weatherJson.size(), s.lastStats().bodyBytes);
+  s.close();
+}
+
+// Both requests of a wake, parsed as they stream in, over the loopback
+static void test_fetch_benchmark() {
+  StubHttpServer srv;
+  const int runs = 50;
+  for (int i = 0; i < runs + 1; i++) {
+    srv.reply(StubHttpServer::Reply::json(s_weatherJson));
+    srv.reply(StubHttpServer::Reply::json(s_forecastJson, 1400));
+  }
+  HttpSession s(HOST, srv.port());
+  double us = benchMicros("fetch + parse weather & forecast", [&] {
+    WeatherData w;
+    ForecastData f;
+    fetchBoth(s, w, f);
+  }, runs);
+  s.close();
+  TEST_ASSERT_EQUAL(1, srv.connections());
+  TEST_ASSERT_LESS_THAN_DOUBLE(20000.0, us);
+}
+
+int main(int, char**) {
+  s_weatherJson = loadFixture("owm_weather.json");
+  s_forecastJson = loadFixture("owm_forecast.json");
+
+  UNITY_BEGIN();
+  RUN_TEST(test_pipelined_on_one_connection);
+  RUN_TEST(test_chunked_body);
+  RUN_TEST(test_resend_after_hang_up);
+  RUN_TEST(test_connection_close);
+  RUN_TEST(test_latency_stats);
+  RUN_TEST(test_fetch_benchmark);
+  return UNITY_END();
+}
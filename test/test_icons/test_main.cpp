@@ -0,0 +1,112 @@
+// Baked icon sprites against the primitive drawing code they replaced
+// (test/support/icon_reference.h): every icon code, weather id and main
+// fallback, at the positions both views use and in all four rotations,
+// must leave the same pixels. Timings compare the two per icon.
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <GxEPD2.h>
+#include <unity.h>
+
+#include "bench.h"
+#include "framebuffer.h"
+#include "icon_reference.h"
+#include "weather_render.h"
+
+// FrameBuffer with the span paths switched back to GFX's defaults, as the
+// display drew the old icons: one drawPixel() at a time
+class PixelFrame : public FrameBuffer {
+public:
+  void fillScreen(uint16_t c) override { Adafruit_GFX::fillScreen(c); }
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c) override {
+    Adafruit_GFX::fillRect(x, y, w, h, c);
+  }
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t c) override { Adafruit_GFX::drawFastHLine(x, y, w, c); }
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t c) override { Adafruit_GFX::drawFastVLine(x, y, h, c); }
+};
+
+static FrameBuffer s_sprites;
+static PixelFrame s_pixels;
+
+static const char* const ICON_CODES[] = { "01n", "02n", "03n", "04n", "09n", "10n", "11n", "13n", "50n" };
+static const int WEATHER_IDS[] = { 211, 302, 501, 601, 741, 800, 803 };
+static const char* const MAINS[] = { "Clear", "Clouds", "Rain", "Drizzle", "Thunderstorm", "Snow", "Haze" };
+
+void setUp() {}
+void tearDown() {}
+
+// Pixels only: the padding bits past native x 121 are never drawn
+static void assertSameFrame(const char* what, int x, int y) {
+  const uint8_t lastMask = (uint8_t)(0xFF00 >> (FRAME_WIDTH - (FRAME_STRIDE - 1) * 8));
+  for (uint32_t i = 0; i < FRAME_BYTES; i++) {
+    uint8_t mask = (i % FRAME_STRIDE == FRAME_STRIDE - 1) ? lastMask : 0xFF;
+    if ((s_sprites.getBuffer()[i] ^ s_pixels.getBuffer()[i]) & mask) {
+      char msg[128];
+      snprintf(msg, sizeof(msg), "%s at (%d, %d), rotation %u: byte %u (row %u) differs", what, x, y,
+               s_sprites.getRotation(), (unsigned)i, (unsigned)(i / FRAME_STRIDE));
+      TEST_FAIL_MESSAGE(msg);
+    }
+  }
+}
+
+// One icon through both paths, at the detailed view's and both split
+// view positions plus two clipped ones, in every rotation
+static void compare(const char* what, const char* code, int id, const char* main) {
+  FixedString<16> iconCode(code), mainText(main);
+  for (uint8_t r = 0; r < 4; r++) {
+    s_sprites.setRotation(r);
+    const int W = s_sprites.width();
+    const int spots[][2] = { { W - 66, 42 }, { 8, 28 }, { W / 2 + 12, 28 }, { -20, -10 }, { W - 30, s_sprites.height() - 40 } };
+    for (const auto& s : spots) {
+      s_sprites.fillScreen(GxEPD_WHITE);
+      s_pixels.setRotation(r);
+      s_pixels.fillScreen(GxEPD_WHITE);
+      drawWeatherIcon(s_sprites, s[0], s[1], iconCode, id, mainText);
+      icon_reference::drawWeatherIcon(s_pixels, s[0], s[1], iconCode, id, mainText);
+      assertSameFrame(what, s[0], s[1]);
+    }
+  }
+}
+
+static void test_icon_codes() {
+  for (const char* code : ICON_CODES) compare(code, code, 0, "");
+}
+
+static void test_weather_ids() {
+  for (int id : WEATHER_IDS) {
+    char what[16];
+    snprintf(what, sizeof(what), "id %d", id);
+    compare(what, "", id, "");
+  }
+}
+
+static void test_main_fallback() {
+  for (const char* main : MAINS) compare(main, "", 0, main);
+}
+
+// Detailed-view position, rotation 1, as on the device
+static void test_timing() {
+  s_sprites.setRotation(1);
+  s_pixels.setRotation(1);
+  const int x = s_sprites.width() - 66, y = 42;
+  double sprites = 0, primitives = 0;
+  for (const char* code : ICON_CODES) {
+    FixedString<4> iconCode(code), none("");
+    char name[40];
+    snprintf(name, sizeof(name), "icon %s sprite", code);
+    sprites += benchMicros(name, [&] { drawWeatherIcon(s_sprites, x, y, iconCode, 0, none); });
+    snprintf(name, sizeof(name), "icon %s primitives", code);
+    primitives += benchMicros(name, [&] { icon_reference::drawWeatherIcon(s_pixels, x, y, iconCode, 0, none); });
+  }
+  printf("BENCH %-32s %9.1f us\n", "all icons, sprites", sprites);
+  printf("BENCH %-32s %9.1f us\n", "all icons, primitives", primitives);
+  TEST_ASSERT_LESS_THAN_DOUBLE(primitives / 4, sprites);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_icon_codes);
+  RUN_TEST(test_weather_ids);
+  RUN_TEST(test_main_fallback);
+  RUN_TEST(test_timing);
+  return UNITY_END();
+}
@@ -0,0 +1,215 @@
+// The JSON parsers over recorded OpenWeather payloads: what they read out,
+// and the heap they need while doing it. The fetch path hands them the
+// HTTP body as a stream; HEAP lines compare that with the old path, a
+// String copy of the body parsed into an unfiltered document.
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <unity.h>
+
+#include "alloc_counter.h"
+#include "fixtures.h"
+#include "weather.h"
+
+static const time_t FIXTURE_NOW = 1760004000;   // dt of owm_weather.json
+static const int32_t FIXTURE_UTC_OFFSET = 10800;
+
+static std::string s_weatherJson;
+static std::string s_forecastJson;
+static std::string s_groupJson;
+static std::string s_forecastPrettyJson;
+
+void setUp() {}
+void tearDown() {}
+
+// What fetchWeather did before the parsers streamed: HTTPClient::getString()
+// grew a String to the body size, and the document kept every field
+static void parseWholeBody(FixtureStream& in) {
+  std::string body;
+  for (int c; (c = in.read()) >= 0;) body += (char)c;
+  FixtureStream copy(std::move(body));
+  JsonDocument doc;
+  TEST_ASSERT_FALSE(deserializeJson(doc, copy));
+}
+
+// ---------------- Current weather ----------------
+static void test_weather_fields() {
+  TEST_ASSERT_FALSE_MESSAGE(s_weatherJson.empty(), "owm_weather.json missing");
+  FixtureStream in(s_weatherJson);
+  WeatherData w;
+  TEST_ASSERT_TRUE(parseWeather(in, w));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 27.43f, w.temp);
+  TEST_ASSERT_EQUAL(801, w.weatherId);
+  TEST_ASSERT_EQUAL_STRING("Clouds", w.main.c_str());
+  TEST_ASSERT_EQUAL_STRING("02d", w.iconCode.c_str());
+}
+
+static void test_weather_heap() {
+  FixtureStream in(s_weatherJson);
+  WeatherData w;
+  HeapUse streamed = measureHeap("parseWeather (stream)", [&] { parseWeather(in, w); });
+  in.rewind();
+  HeapUse whole = measureHeap("parseWeather (String body)", [&] { parseWholeBody(in); });
+  // A 500-byte body is smaller than the documents' first pool either way
+  TEST_ASSERT_LESS_THAN(whole.peak, streamed.peak);
+}
+
+// ---------------- Forecast ----------------
+static void test_forecast_heap() {
+  TEST_ASSERT_FALSE_MESSAGE(s_forecastJson.empty(), "owm_forecast.json missing");
+  FixtureStream in(s_forecastJson);
+  ForecastData f;
+  HeapUse streamed = measureHeap("parseForecast (stream)", [&] {
+    TEST_ASSERT_TRUE(parseForecast(in, f, FIXTURE_NOW, FIXTURE_UTC_OFFSET));
+  });
+  in.rewind();
+  HeapUse whole = measureHeap("parseForecast (String body)", [&] { parseWholeBody(in); });
+  // One slot at a time: a fraction of the 16 KB body
+  TEST_ASSERT_LESS_THAN(s_forecastJson.size() / 2, streamed.peak);
+  TEST_ASSERT_LESS_THAN(whole.peak / 2, streamed.peak);
+}
+
+// Tomorrow in Beer Sheva (UTC+3) is 2025-10-10: 8 slots, 5 of them clear.
+// Expected values worked out from the fixture by hand.
+static void test_forecast_tomorrow() {
+  FixtureStream in(s_forecastJson);
+  ForecastData f;
+  TEST_ASSERT_TRUE(parseForecast(in, f, FIXTURE_NOW, FIXTURE_UTC_OFFSET));
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 15.03f, f.tempMin);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 29.19f, f.tempMax);
+  TEST_ASSERT_EQUAL(800, f.weatherId);
+  TEST_ASSERT_EQUAL_STRING("Clear", f.main.c_str());
+  TEST_ASSERT_EQUAL_STRING("01n", f.iconCode.c_str());
+  TEST_ASSERT_EQUAL(1760043600, (int)f.tomorrowStart);   // local midnight
+  // Next 12 h: 26.60 -> 29.17 -> 26.13 -> 22.17, clear then clouds
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.96f, f.maxStepC);
+  TEST_ASSERT_TRUE(f.conditionChange);
+}
+
+// Slots are bucketed by local day: west of UTC tomorrow starts later
+static void test_forecast_timezones() {
+  FixtureStream utc(s_forecastJson);
+  ForecastData f;
+  TEST_ASSERT_TRUE(parseForecast(utc, f, FIXTURE_NOW, 0));
+  TEST_ASSERT_EQUAL(1760054400, (int)f.tomorrowStart);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 15.03f, f.tempMin);
+  TEST_ASSERT_EQUAL_STRING("01d", f.iconCode.c_str());
+
+  FixtureStream west(s_forecastJson);
+  TEST_ASSERT_TRUE(parseForecast(west, f, FIXTURE_NOW, -18000));
+  TEST_ASSERT_EQUAL(1760072400, (int)f.tomorrowStart);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 14.02f, f.tempMin);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 29.19f, f.tempMax);
+}
+
+// The same payload pretty-printed ("list": [ with whitespace and newlines)
+static void test_forecast_pretty_printed() {
+  TEST_ASSERT_FALSE_MESSAGE(s_forecastPrettyJson.empty(), "owm_forecast_pretty.json missing");
+  FixtureStream compact(s_forecastJson);
+  FixtureStream pretty(s_forecastPrettyJson, 61);
+  ForecastData a, b;
+  TEST_ASSERT_TRUE(parseForecast(compact, a, FIXTURE_NOW, FIXTURE_UTC_OFFSET));
+  TEST_ASSERT_TRUE(parseForecast(pretty, b, FIXTURE_NOW, FIXTURE_UTC_OFFSET));
+  TEST_ASSERT_EQUAL_FLOAT(a.tempMin, b.tempMin);
+  TEST_ASSERT_EQUAL_FLOAT(a.tempMax, b.tempMax);
+  TEST_ASSERT_EQUAL_FLOAT(a.maxStepC, b.maxStepC);
+  TEST_ASSERT_EQUAL(a.weatherId, b.weatherId);
+  TEST_ASSERT_EQUAL(a.tomorrowStart, b.tomorrowStart);
+}
+
+static void test_forecast_empty_list() {
+  FixtureStream empty("{\"cod\":\"200\",\"cnt\":0,\"list\" : [ ]}");
+  ForecastData f;
+  TEST_ASSERT_FALSE(parseForecast(empty, f, FIXTURE_NOW, FIXTURE_UTC_OFFSET));
+  FixtureStream missing("{\"cod\":\"404\",\"message\":\"list\"}");
+  TEST_ASSERT_FALSE(parseForecast(missing, f, FIXTURE_NOW, FIXTURE_UTC_OFFSET));
+}
+
+// Bodies arrive in TLS-record-sized pieces
+static void test_forecast_short_reads() {
+  FixtureStream whole(s_forecastJson);
+  FixtureStream chunked(s_forecastJson, 61);
+  ForecastData a, b;
+  TEST_ASSERT_TRUE(parseForecast(whole, a, FIXTURE_NOW, FIXTURE_UTC_OFFSET));
+  TEST_ASSERT_TRUE(parseForecast(chunked, b, FIXTURE_NOW, FIXTURE_UTC_OFFSET));
+  TEST_ASSERT_EQUAL_FLOAT(a.tempMin, b.tempMin);
+  TEST_ASSERT_EQUAL_FLOAT(a.tempMax, b.tempMax);
+  TEST_ASSERT_EQUAL(a.weatherId, b.weatherId);
+}
+
+// ---------------- Group (other locations) ----------------
+static LocationWeather s_cities[MAX_LOCATIONS];
+
+static void collectCity(void*, size_t index, LocationWeather& loc) {
+  if (index < MAX_LOCATIONS) s_cities[index] = loc;
+}
+
+static void countCity(void* ctx, size_t, LocationWeather&) {
+  (*(size_t*)ctx)++;
+}
+
+// A group response for `n` cities shaped like the recorded one
+static std::string syntheticGroup(size_t n) {
+  static const char* CITY =
+      "{\"coord\":{\"lon\":34.78,\"lat\":32.08},\"sys\":{\"country\":\"IL\",\"timezone\":10800,"
+      "\"sunrise\":1759979400,\"sunset\":1760021300},\"weather\":[{\"id\":800,\"main\":\"Clear\","
+      "\"description\":\"clear sky\",\"icon\":\"01d\"}],\"main\":{\"temp\":%.2f,\"feels_like\":25.1,"
+      "\"temp_min\":23.6,\"temp_max\":26.2,\"pressure\":1013,\"humidity\":55},\"visibility\":10000,"
+      "\"wind\":{\"speed\":3.6,\"deg\":270},\"clouds\":{\"all\":10},\"dt\":1760004000,"
+      "\"id\":%u,\"name\":\"City %u\"}";
+  std::string out = "{\"cnt\":" + std::to_string(n) + ",\"list\":[";
+  char city[512];
+  for (size_t i = 0; i < n; i++) {
+    snprintf(city, sizeof(city), CITY, 20.0 + i * 0.25, (unsigned)(281000 + i), (unsigned)i);
+    if (i) out += ',';
+    out += city;
+  }
+  return out + "]}";
+}
+
+static void test_group_fields() {
+  TEST_ASSERT_FALSE_MESSAGE(s_groupJson.empty(), "owm_group.json missing");
+  FixtureStream in(s_groupJson, 61);
+  size_t count = 0;
+  TEST_ASSERT_TRUE(parseGroup(in, collectCity, nullptr, count));
+  TEST_ASSERT_EQUAL(3, (int)count);
+  TEST_ASSERT_EQUAL(293397, (int)s_cities[0].cityId);
+  TEST_ASSERT_EQUAL_STRING("Tel Aviv", s_cities[0].name.c_str());
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 24.8f, s_cities[0].weather.temp);
+  TEST_ASSERT_EQUAL_STRING("01d", s_cities[0].weather.iconCode.c_str());
+}
+
+// One city at a time: the peak must not grow with the number of cities
+static void test_group_heap_flat() {
+  size_t peakOne = 0;
+  for (size_t n : { 1, 5, 10, 20 }) {
+    FixtureStream in(syntheticGroup(n));
+    size_t count = 0, seen = 0;
+    char name[40];
+    snprintf(name, sizeof(name), "parseGroup (%u cities, %u B)", (unsigned)n, (unsigned)in.available());
+    HeapUse use = measureHeap(name, [&] { TEST_ASSERT_TRUE(parseGroup(in, countCity, &seen, count)); });
+    TEST_ASSERT_EQUAL(n, count);
+    TEST_ASSERT_EQUAL(n, seen);
+    if (n == 1) peakOne = use.peak;
+    TEST_ASSERT_LESS_OR_EQUAL(peakOne + 256, use.peak);
+  }
+}
+
+int main(int, char**) {
+  s_weatherJson = loadFixture("owm_weather.json");
+  s_forecastJson = loadFixture("owm_forecast.json");
+  s_groupJson = loadFixture("owm_group.json");
+  s_forecastPrettyJson = loadFixture("owm_forecast_pretty.json");
+
+  UNITY_BEGIN();
+  RUN_TEST(test_weather_fields);
+  RUN_TEST(test_weather_heap);
+  RUN_TEST(test_forecast_heap);
+  RUN_TEST(test_forecast_tomorrow);
+  RUN_TEST(test_forecast_timezones);
+  RUN_TEST(test_forecast_pretty_printed);
+  RUN_TEST(test_forecast_empty_list);
+  RUN_TEST(test_forecast_short_reads);
+  RUN_TEST(test_group_fields);
+  RUN_TEST(test_group_heap_flat);
+  return UNITY_END();
+}
@@ -0,0 +1,201 @@
+// The settings blob over the Preferences stand-in: defaults on an empty
+// partition, the blob round trip, a corrupt blob rejected, per-value keys
+// of older firmware migrated, an older shorter blob loaded over the
+// defaults, and warm wakes served from the RTC mirror without NVS.
+// Timings compare boot-to-settings-ready for each path.
+#include <Arduino.h>
+#include <Preferences.h>
+#include <unity.h>
+
+#include <stddef.h>
+
+#include "bench.h"
+#include "settings_store.h"
+
+// Layout of the stored blob (settings_store.cpp)
+struct BlobHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;
+  uint32_t crc;
+};
+static const uint32_t SETTINGS_MAGIC = 0x53544731;
+
+static uint32_t crc32(const uint8_t* data, size_t len) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (int b = 0; b < 8; b++) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+  }
+  return ~crc;
+}
+
+static std::vector<uint8_t>& storedBlob() {
+  return Preferences::store()["weather"]["cfg"];
+}
+
+// Power-on: NVS kept, RTC memory lost
+static void coldBoot() {
+  settingsForgetMirror();
+}
+
+static Settings custom() {
+  Settings s;
+  settingsDefaults(s);
+  strlcpy(s.apiKey, "0123456789abcdef", sizeof(s.apiKey));
+  strlcpy(s.city, "Haifa,IL", sizeof(s.city));
+  s.intervalHours = 6;
+  s.refreshDeltaC = 1.5f;
+  s.rotateMin = 5;
+  return s;
+}
+
+void setUp() {
+  Preferences::store().clear();
+  coldBoot();
+}
+void tearDown() {}
+
+static void test_defaults_written_once() {
+  Settings s;
+  TEST_ASSERT_EQUAL(SETTINGS_DEFAULTS, settingsLoad(s));
+  TEST_ASSERT_EQUAL_STRING("Beer Sheva,IL", s.city);
+  TEST_ASSERT_EQUAL(12, s.intervalHours);
+  TEST_ASSERT_EQUAL(sizeof(BlobHeader) + sizeof(Settings), storedBlob().size());
+
+  coldBoot();
+  TEST_ASSERT_EQUAL(SETTINGS_NVS, settingsLoad(s));
+}
+
+static void test_blob_round_trip() {
+  Settings saved = custom();
+  TEST_ASSERT_TRUE(settingsSave(saved));
+  coldBoot();
+  Settings s;
+  TEST_ASSERT_EQUAL(SETTINGS_NVS, settingsLoad(s));
+  TEST_ASSERT_EQUAL_MEMORY(&saved, &s, sizeof(s));
+}
+
+// Warm wake: the mirror answers even with NVS gone
+static void test_rtc_mirror_short_circuit() {
+  Settings saved = custom();
+  settingsSave(saved);
+  Preferences::store().clear();
+  Settings s;
+  TEST_ASSERT_EQUAL(SETTINGS_RTC, settingsLoad(s));
+  TEST_ASSERT_EQUAL_MEMORY(&saved, &s, sizeof(s));
+  TEST_ASSERT_TRUE(Preferences::store().empty());   // NVS not even opened for writing
+}
+
+static void test_corrupt_blob_rejected() {
+  settingsSave(custom());
+  storedBlob()[sizeof(BlobHeader) + 3] ^= 0x40;   // inside apiKey
+  coldBoot();
+  Settings s;
+  TEST_ASSERT_EQUAL(SETTINGS_DEFAULTS, settingsLoad(s));
+  TEST_ASSERT_EQUAL_STRING("", s.apiKey);
+  TEST_ASSERT_EQUAL_STRING("Beer Sheva,IL", s.city);
+
+  // Rewritten whole: the next cold boot reads a good blob
+  coldBoot();
+  TEST_ASSERT_EQUAL(SETTINGS_NVS, settingsLoad(s));
+}
+
+// A blob from newer firmware is not read as this layout
+static void test_newer_blob_rejected() {
+  settingsSave(custom());
+  storedBlob()[offsetof(BlobHeader, version)] = SETTINGS_VERSION + 1;
+  coldBoot();
+  Settings s;
+  TEST_ASSERT_EQUAL(SETTINGS_DEFAULTS, settingsLoad(s));
+}
+
+static void test_keys_migrated() {
+  Preferences p;
+  p.begin("weather");
+  p.putString("apiKey", "fedcba9876543210");
+  p.putString("city", "Eilat,IL");
+  p.putUInt("interval", 3);
+  p.putUChar("nightStart", 22);
+  p.putShort("tzOffset", -5);
+  p.putBool("deepSleep", true);
+  p.putFloat("refDelta", 2.0f);
+  p.end();
+
+  Settings s;
+  TEST_ASSERT_EQUAL(SETTINGS_MIGRATED, settingsLoad(s));
+  TEST_ASSERT_EQUAL_STRING("fedcba9876543210", s.apiKey);
+  TEST_ASSERT_EQUAL_STRING("Eilat,IL", s.city);
+  TEST_ASSERT_EQUAL(3, s.intervalHours);
+  TEST_ASSERT_EQUAL(22, s.nightStartHour);
+  TEST_ASSERT_EQUAL(-5, s.tzOffsetHours);
+  TEST_ASSERT_TRUE(s.deepSleep);
+  TEST_ASSERT_EQUAL_FLOAT(2.0f, s.refreshDeltaC);
+  TEST_ASSERT_EQUAL(7, s.nightEndHour);     // not stored: default
+  TEST_ASSERT_EQUAL(15, s.rotateMin);
+
+  // Saved as a blob: the next cold boot takes the single read
+  coldBoot();
+  Settings again;
+  TEST_ASSERT_EQUAL(SETTINGS_NVS, settingsLoad(again));
+  TEST_ASSERT_EQUAL_MEMORY(&s, &again, sizeof(s));
+}
+
+// An older layout ended before refreshDeltaC: the tail comes from the defaults
+static void test_older_shorter_blob() {
+  Settings old = custom();
+  const uint16_t oldSize = offsetof(Settings, refreshDeltaC);
+  BlobHeader h = { SETTINGS_MAGIC, (uint16_t)(SETTINGS_VERSION - 1), oldSize, crc32((const uint8_t*)&old, oldSize) };
+  std::vector<uint8_t>& blob = storedBlob();
+  blob.assign((const uint8_t*)&h, (const uint8_t*)&h + sizeof(h));
+  blob.insert(blob.end(), (const uint8_t*)&old, (const uint8_t*)&old + oldSize);
+
+  Settings s;
+  TEST_ASSERT_EQUAL(SETTINGS_NVS, settingsLoad(s));
+  TEST_ASSERT_EQUAL_STRING("Haifa,IL", s.city);
+  TEST_ASSERT_EQUAL(6, s.intervalHours);
+  TEST_ASSERT_EQUAL_FLOAT(0.5f, s.refreshDeltaC);   // defaults, not the saved 1.5 / 5
+  TEST_ASSERT_EQUAL(15, s.rotateMin);
+
+  // A size that doesn't match the bytes stored is corrupt
+  blob.pop_back();
+  coldBoot();
+  TEST_ASSERT_EQUAL(SETTINGS_DEFAULTS, settingsLoad(s));
+}
+
+// Boot to settings ready, per path. NVS is process memory here, so the
+// numbers show the work around it (CRC, copies), not flash reads.
+static void test_boot_to_settings_ready() {
+  Settings s;
+  settingsSave(custom());
+  double rtc = benchMicros("settings ready: RTC mirror", [&] { settingsLoad(s); });
+  double nvs = benchMicros("settings ready: NVS blob", [&] {
+    coldBoot();
+    settingsLoad(s);
+  });
+  Preferences::store().clear();
+  Preferences p;
+  p.begin("weather");
+  p.putString("apiKey", "fedcba9876543210");
+  p.putString("city", "Eilat,IL");
+  p.end();
+  benchMicros("settings ready: key migration", [&] {
+    Preferences::store()["weather"].erase("cfg");
+    coldBoot();
+    TEST_ASSERT_EQUAL(SETTINGS_MIGRATED, settingsLoad(s));
+  });
+  TEST_ASSERT_LESS_THAN_DOUBLE(nvs, rtc);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_defaults_written_once);
+  RUN_TEST(test_blob_round_trip);
+  RUN_TEST(test_rtc_mirror_short_circuit);
+  RUN_TEST(test_corrupt_blob_rejected);
+  RUN_TEST(test_newer_blob_rejected);
+  RUN_TEST(test_keys_migrated);
+  RUN_TEST(test_older_shorter_blob);
+  RUN_TEST(test_boot_to_settings_ready);
+  return UNITY_END();
+}
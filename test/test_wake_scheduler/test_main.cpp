@@ -0,0 +1,126 @@
+// Adaptive wake scheduling: sleep length against volatility and its
+// clamping, wakes pulled in to the night-mode boundaries (including the
+// window wrapping past midnight), and the retry backoff's growth, cap and
+// jitter.
+#include <unity.h>
+
+#include "wake_scheduler.h"
+
+static const ScheduleConfig CFG = { 600, 3600, 22, 6 };
+static const uint32_t NOON = 12 * 3600;
+
+void setUp() {}
+void tearDown() {}
+
+static WeatherTrend forecastStep(float stepC) {
+  WeatherTrend t;
+  t.haveForecast = true;
+  t.forecastStepC = stepC;
+  return t;
+}
+
+static void test_volatility() {
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, trendVolatility(WeatherTrend()));
+  TEST_ASSERT_EQUAL_FLOAT(0.5f, trendVolatility(forecastStep(-2.0f)));
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, trendVolatility(forecastStep(12.0f)));   // clamped
+
+  WeatherTrend t = forecastStep(1.0f);
+  t.forecastConditionChange = true;
+  TEST_ASSERT_EQUAL_FLOAT(TREND_CONDITION_CHANGE, trendVolatility(t));
+
+  // An observed rate counts only when flagged, and the larger term wins
+  t = WeatherTrend();
+  t.observedRateCPerHour = 2.0f;
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, trendVolatility(t));
+  t.haveObserved = true;
+  t.observedRateCPerHour = -1.5f;
+  TEST_ASSERT_EQUAL_FLOAT(0.75f, trendVolatility(t));
+}
+
+static void test_interval_scales_and_clamps() {
+  TEST_ASSERT_EQUAL_UINT32(3600, nextWakeSeconds(CFG, WeatherTrend(), NOON));
+  TEST_ASSERT_EQUAL_UINT32(2100, nextWakeSeconds(CFG, forecastStep(2.0f), NOON));
+  TEST_ASSERT_EQUAL_UINT32(600, nextWakeSeconds(CFG, forecastStep(4.0f), NOON));
+  TEST_ASSERT_EQUAL_UINT32(600, nextWakeSeconds(CFG, forecastStep(40.0f), NOON));
+
+  // A minimum above the maximum: the maximum, whatever the weather
+  ScheduleConfig inverted = { 7200, 3600, 22, 6 };
+  TEST_ASSERT_EQUAL_UINT32(3600, nextWakeSeconds(inverted, WeatherTrend(), NOON));
+  TEST_ASSERT_EQUAL_UINT32(3600, nextWakeSeconds(inverted, forecastStep(40.0f), NOON));
+}
+
+static void test_pulled_in_to_boundaries() {
+  // 21:30: night starts in 30 min
+  TEST_ASSERT_EQUAL_UINT32(1800 + SCHEDULE_BOUNDARY_SLACK_S, nextWakeSeconds(CFG, WeatherTrend(), 21 * 3600 + 1800));
+  // 05:50: night ends in 10 min
+  TEST_ASSERT_EQUAL_UINT32(600 + SCHEDULE_BOUNDARY_SLACK_S, nextWakeSeconds(CFG, WeatherTrend(), 5 * 3600 + 3000));
+  // A boundary further off than the interval changes nothing
+  TEST_ASSERT_EQUAL_UINT32(3600, nextWakeSeconds(CFG, WeatherTrend(), 20 * 3600));
+}
+
+static void test_night_window_wraps_midnight() {
+  ScheduleConfig lazy = { 600, 12 * 3600, 22, 6 };
+  // 23:00: the end at 06:00 is tomorrow, 7 h away
+  TEST_ASSERT_EQUAL_UINT32(7 * 3600 + SCHEDULE_BOUNDARY_SLACK_S, nextWakeSeconds(lazy, WeatherTrend(), 23 * 3600));
+  // 00:30, the other side of midnight, same window
+  TEST_ASSERT_EQUAL_UINT32(5 * 3600 + 1800 + SCHEDULE_BOUNDARY_SLACK_S, nextWakeSeconds(lazy, WeatherTrend(), 1800));
+  // Exactly on 22:00: this wake already sees the night, so the next
+  // boundary is 06:00
+  TEST_ASSERT_EQUAL_UINT32(8 * 3600 + SCHEDULE_BOUNDARY_SLACK_S, nextWakeSeconds(lazy, WeatherTrend(), 22 * 3600));
+
+  // A daytime window (start < end) the same way round
+  ScheduleConfig day = { 600, 12 * 3600, 9, 17 };
+  TEST_ASSERT_EQUAL_UINT32(9 * 3600 + SCHEDULE_BOUNDARY_SLACK_S, nextWakeSeconds(day, WeatherTrend(), 0));
+}
+
+static void test_no_pull_in_without_clock_or_window() {
+  ScheduleConfig lazy = { 600, 12 * 3600, 22, 6 };
+  TEST_ASSERT_EQUAL_UINT32(12 * 3600, nextWakeSeconds(lazy, WeatherTrend(), UINT32_MAX));
+  ScheduleConfig noNight = { 600, 12 * 3600, 3, 3 };
+  TEST_ASSERT_EQUAL_UINT32(12 * 3600, nextWakeSeconds(noNight, WeatherTrend(), 2 * 3600 + 3599));
+}
+
+// random = span / 2 is the nominal value
+static uint32_t nominal(uint8_t failures, uint32_t maxSec) {
+  uint32_t n = maxSec;
+  if (failures >= 1 && failures <= 16 && ((uint64_t)RETRY_FIRST_S << (failures - 1)) < maxSec) {
+    n = RETRY_FIRST_S << (failures - 1);
+  }
+  return retryBackoffSeconds(failures, maxSec, n * RETRY_JITTER_PERCENT * 2 / 100 / 2);
+}
+
+static void test_backoff_grows_and_caps() {
+  TEST_ASSERT_EQUAL_UINT32(60, nominal(1, 3600));
+  TEST_ASSERT_EQUAL_UINT32(120, nominal(2, 3600));
+  TEST_ASSERT_EQUAL_UINT32(240, nominal(3, 3600));
+  TEST_ASSERT_EQUAL_UINT32(1920, nominal(6, 3600));
+  TEST_ASSERT_EQUAL_UINT32(3600, nominal(7, 3600));     // 3840 capped
+  TEST_ASSERT_EQUAL_UINT32(3600, nominal(16, 3600));
+  TEST_ASSERT_EQUAL_UINT32(3600, nominal(255, 3600));   // no shift overflow
+  TEST_ASSERT_EQUAL_UINT32(3600, nominal(0, 3600));
+}
+
+static void test_backoff_jitter() {
+  // +/-25 % of 240 s
+  TEST_ASSERT_EQUAL_UINT32(180, retryBackoffSeconds(3, 3600, 0));
+  TEST_ASSERT_EQUAL_UINT32(300, retryBackoffSeconds(3, 3600, 120));
+  for (uint32_t r = 0; r < 100000; r += 7919) {
+    uint32_t s = retryBackoffSeconds(3, 3600, r * 2654435761u);
+    TEST_ASSERT_TRUE(s >= 180 && s <= 300);
+  }
+  // Never past the longest sleep, even jittered up
+  for (uint32_t r = 0; r < 2000; r++) TEST_ASSERT_LESS_OR_EQUAL(3600, retryBackoffSeconds(9, 3600, r));
+  TEST_ASSERT_EQUAL_UINT32(2700, retryBackoffSeconds(9, 3600, 0));
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_volatility);
+  RUN_TEST(test_interval_scales_and_clamps);
+  RUN_TEST(test_pulled_in_to_boundaries);
+  RUN_TEST(test_night_window_wraps_midnight);
+  RUN_TEST(test_no_pull_in_without_clock_or_window);
+  RUN_TEST(test_backoff_grows_and_caps);
+  RUN_TEST(test_backoff_jitter);
+  return UNITY_END();
+}
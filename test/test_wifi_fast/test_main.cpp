@@ -0,0 +1,136 @@
+// Fast reconnect against a scripted radio on a virtual clock: connect,
+// failure and timeout, the record cleared whenever the join fails, and
+// the cached lease used as a static address only when there is one.
+#include <unity.h>
+
+#include <string.h>
+
+#include "wifi_fast.h"
+
+// Connects (or fails) a fixed time after begin(); never, if neither is set
+class FakeRadio : public WifiRadio {
+public:
+  uint32_t connectAfterMs = 0;
+  uint32_t failAfterMs = 0;
+  bool never = false;
+
+  int begins = 0;
+  int stops = 0;
+  bool lastStaticIp = false;
+  uint32_t now = 1000;
+
+  void begin(const WifiCache&, bool staticIp) override {
+    begins++;
+    lastStaticIp = staticIp;
+    _begunAt = now;
+  }
+  RadioStatus status() override {
+    if (never) return RADIO_CONNECTING;
+    if (failAfterMs && now - _begunAt >= failAfterMs) return RADIO_FAILED;
+    if (!failAfterMs && now - _begunAt >= connectAfterMs) return RADIO_CONNECTED;
+    return RADIO_CONNECTING;
+  }
+  void stop() override { stops++; }
+  uint32_t millis() override { return now; }
+  void sleep(uint32_t ms) override { now += ms; }
+
+private:
+  uint32_t _begunAt = 0;
+};
+
+static const uint8_t BSSID[6] = { 0x10, 0x20, 0x30, 0x40, 0x50, 0x60 };
+static const uint32_t IP = 0x2A01A8C0, GATEWAY = 0x0101A8C0, SUBNET = 0x00FFFFFF;
+
+static WifiCache s_cache;
+static FakeRadio* s_radio;
+
+void setUp() {
+  wifiCacheStore(s_cache, "home", "secret", BSSID, 6, IP, GATEWAY, SUBNET, 0);
+  s_radio = new FakeRadio();
+}
+void tearDown() { delete s_radio; }
+
+static void test_store() {
+  TEST_ASSERT_TRUE(wifiCacheValid(s_cache));
+  TEST_ASSERT_EQUAL_STRING("home", s_cache.ssid);
+  TEST_ASSERT_EQUAL_MEMORY(BSSID, s_cache.bssid, 6);
+  TEST_ASSERT_EQUAL(6, s_cache.channel);
+  TEST_ASSERT_TRUE(s_cache.haveLease);
+  TEST_ASSERT_EQUAL_HEX32(GATEWAY, s_cache.dns);   // no DNS given: the gateway
+
+  // No BSSID: found by scanning, so no channel either
+  wifiCacheStore(s_cache, "home", "secret", nullptr, 6, IP, GATEWAY, SUBNET, 0);
+  TEST_ASSERT_EQUAL(0, s_cache.channel);
+
+  // A partial lease is no lease
+  wifiCacheStore(s_cache, "home", "secret", BSSID, 6, IP, 0, SUBNET, 0);
+  TEST_ASSERT_TRUE(wifiCacheValid(s_cache));
+  TEST_ASSERT_FALSE(s_cache.haveLease);
+
+  char longSsid[40];
+  memset(longSsid, 'a', sizeof(longSsid) - 1);
+  longSsid[sizeof(longSsid) - 1] = '\0';
+  wifiCacheStore(s_cache, longSsid, "secret", BSSID, 6, IP, GATEWAY, SUBNET, 0);
+  TEST_ASSERT_FALSE(wifiCacheValid(s_cache));
+}
+
+static void test_connect() {
+  s_radio->connectAfterMs = 120;
+  TEST_ASSERT_TRUE(wifiFastConnect(*s_radio, s_cache, true, 3000));
+  TEST_ASSERT_EQUAL(1, s_radio->begins);
+  TEST_ASSERT_EQUAL(0, s_radio->stops);
+  TEST_ASSERT_TRUE(s_radio->lastStaticIp);
+  TEST_ASSERT_TRUE(wifiCacheValid(s_cache));
+  // Polled every 10 ms: done on the first poll past the connect
+  TEST_ASSERT_EQUAL(1120, s_radio->now);
+}
+
+static void test_static_ip_needs_lease() {
+  s_radio->connectAfterMs = 50;
+  TEST_ASSERT_TRUE(wifiFastConnect(*s_radio, s_cache, false, 3000));
+  TEST_ASSERT_FALSE(s_radio->lastStaticIp);   // reuse off
+
+  wifiCacheStore(s_cache, "home", "secret", BSSID, 6, 0, 0, 0, 0);
+  TEST_ASSERT_TRUE(wifiFastConnect(*s_radio, s_cache, true, 3000));
+  TEST_ASSERT_FALSE(s_radio->lastStaticIp);   // no lease to reuse
+}
+
+static void test_failure_clears_cache() {
+  s_radio->failAfterMs = 300;
+  TEST_ASSERT_FALSE(wifiFastConnect(*s_radio, s_cache, true, 3000));
+  TEST_ASSERT_EQUAL(1, s_radio->stops);
+  TEST_ASSERT_EQUAL(1300, s_radio->now);   // gave up on the failure, not the timeout
+  TEST_ASSERT_FALSE(wifiCacheValid(s_cache));
+  TEST_ASSERT_FALSE(s_cache.haveLease);
+
+  // The next attempt goes the slow way without touching the radio
+  TEST_ASSERT_FALSE(wifiFastConnect(*s_radio, s_cache, true, 3000));
+  TEST_ASSERT_EQUAL(1, s_radio->begins);
+}
+
+static void test_timeout_clears_cache() {
+  s_radio->never = true;
+  TEST_ASSERT_FALSE(wifiFastConnect(*s_radio, s_cache, true, 2000));
+  TEST_ASSERT_EQUAL(3000, s_radio->now);
+  TEST_ASSERT_EQUAL(1, s_radio->stops);
+  TEST_ASSERT_FALSE(wifiCacheValid(s_cache));
+}
+
+// The clock wraps during the attempt: still times out, not at once or never
+static void test_timeout_across_wrap() {
+  s_radio->never = true;
+  s_radio->now = 0xFFFFFF00;
+  TEST_ASSERT_FALSE(wifiFastConnect(*s_radio, s_cache, true, 2000));
+  TEST_ASSERT_EQUAL_UINT32(0xFFFFFF00 + 2000, s_radio->now);
+}
+
+int main(int, char**) {
+  UNITY_BEGIN();
+  RUN_TEST(test_store);
+  RUN_TEST(test_connect);
+  RUN_TEST(test_static_ip_needs_lease);
+  RUN_TEST(test_failure_clears_cache);
+  RUN_TEST(test_timeout_clears_cache);
+  RUN_TEST(test_timeout_across_wrap);
+  return UNITY_END();
+}
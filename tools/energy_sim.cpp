@@ -0,0 +1,86 @@
+// Command line for the host-side energy simulator (lib/energy_sim):
+// replays days of wakes through the firmware's scheduling code and
+// projects battery life.
+//
+//   g++ -O2 -std=c++17 -Iinclude -Ilib/energy_sim -o energy_sim
+//       tools/energy_sim.cpp lib/energy_sim/energy_sim.cpp src/wake_scheduler.cpp
+//   tools/wake_report.py --profile wake_profile.txt monitor.log
+//   ./energy_sim --profile wake_profile.txt --days 30 --battery 1200
+//   ./energy_sim --interval 6 --wifi-fail 0.05 --ms panel_full=3000 --current wifi=95
+//
+// Options apply in order, so --ms after --profile overrides a measured p50.
+// `pio test -e native -f test_energy -v` runs the same model against the
+// checked-in profile.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "energy_sim.h"
+
+// ---------------- Command line ----------------
+static void usage() {
+  fprintf(stderr,
+          "usage: energy_sim [--days N] [--battery MAH] [--usable PCT] [--sleep-ua UA]\n"
+          "                  [--interval H] [--min-intvl MIN] [--night START-END]\n"
+          "                  [--ttl-now MIN] [--ttl-fcst MIN] [--partial-max N] [--ref-delta C]\n"
+          "                  [--wifi-fail P] [--fetch-fail P] [--seed N]\n"
+          "                  [--profile FILE] [--ms PHASE=MS]... [--current PHASE=MA]...\n"
+          "phases:");
+  SimConfig defaults;
+  for (int i = 0; i < SIM_PHASES; i++) fprintf(stderr, " %s", defaults.phases[i].name);
+  fprintf(stderr, "\n");
+  exit(2);
+}
+
+// "name=value" onto a phase's time or current
+static void setPhase(SimConfig& cfg, const char* arg, bool current) {
+  const char* eq = strchr(arg, '=');
+  if (!eq || eq - arg >= 32) usage();
+  char name[32];
+  memcpy(name, arg, eq - arg);
+  name[eq - arg] = '\0';
+  if (!simSetPhase(cfg, name, strtof(eq + 1, nullptr), current)) {
+    fprintf(stderr, "unknown phase in '%s'\n", arg);
+    usage();
+  }
+}
+
+int main(int argc, char** argv) {
+  SimConfig cfg;
+  for (int i = 1; i < argc; i++) {
+    const char* opt = argv[i];
+    if (i + 1 >= argc) usage();
+    const char* val = argv[++i];
+    if      (!strcmp(opt, "--days"))        cfg.days = strtoul(val, nullptr, 10);
+    else if (!strcmp(opt, "--battery"))     cfg.batteryMah = strtof(val, nullptr);
+    else if (!strcmp(opt, "--usable"))      cfg.usablePercent = strtof(val, nullptr);
+    else if (!strcmp(opt, "--sleep-ua"))    cfg.sleepUa = strtof(val, nullptr);
+    else if (!strcmp(opt, "--interval"))    cfg.schedule.maxSec = strtoul(val, nullptr, 10) * 3600;
+    else if (!strcmp(opt, "--min-intvl"))   cfg.schedule.minSec = strtoul(val, nullptr, 10) * 60;
+    else if (!strcmp(opt, "--ttl-now"))     cfg.weatherTtlSec = strtoul(val, nullptr, 10) * 60;
+    else if (!strcmp(opt, "--ttl-fcst"))    cfg.forecastTtlSec = strtoul(val, nullptr, 10) * 60;
+    else if (!strcmp(opt, "--partial-max")) cfg.partialMax = (uint8_t)strtoul(val, nullptr, 10);
+    else if (!strcmp(opt, "--ref-delta"))   cfg.refreshDeltaC = strtof(val, nullptr);
+    else if (!strcmp(opt, "--wifi-fail"))   cfg.wifiFailRate = strtof(val, nullptr);
+    else if (!strcmp(opt, "--fetch-fail"))  cfg.fetchFailRate = strtof(val, nullptr);
+    else if (!strcmp(opt, "--seed"))        cfg.seed = strtoul(val, nullptr, 10);
+    else if (!strcmp(opt, "--profile"))     { if (simLoadProfile(cfg, val) < 0) usage(); }
+    else if (!strcmp(opt, "--ms"))          setPhase(cfg, val, false);
+    else if (!strcmp(opt, "--current"))     setPhase(cfg, val, true);
+    else if (!strcmp(opt, "--night")) {
+      unsigned start, endHour;
+      if (sscanf(val, "%u-%u", &start, &endHour) != 2 || start > 23 || endHour > 23) usage();
+      cfg.schedule.nightStartHour = start;
+      cfg.schedule.nightEndHour = endHour;
+    } else {
+      usage();
+    }
+  }
+  if (cfg.days == 0 || cfg.schedule.maxSec == 0) usage();
+
+  SimTotals tot;
+  simulate(cfg, tot);
+  simReport(cfg, tot);
+  return 0;
+}
@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""Generate the glyph atlas (glyph_atlas.h) from Adafruit GFX font headers.
+
+Runs as a PlatformIO pre-build script (see platformio.ini): it finds the
+fonts in the Adafruit GFX library pulled in by GxEPD2, writes
+glyph_atlas.h into the build directory and adds that to the include path.
+The header is only rewritten when its content changes.
+
+By hand, e.g. to inspect the output:
+
+    tools/gen_glyph_atlas.py path/to/Adafruit_GFX/Fonts out/glyph_atlas.h
+
+Every glyph becomes a Sprite in the layout FrameBuffer::drawSprite() blits
+(include/framebuffer.h): pre-rotated for setRotation(1), one row per
+landscape column, bits along native x with the glyph's bottom row first.
+Metrics are Adafruit GFX's, so atlas text is pixel-identical to print().
+"""
+
+import glob
+import os
+import re
+import sys
+
+PRINTABLE = "".join(chr(c) for c in range(0x20, 0x7F))
+
+# Font -> characters to bake. The big font only ever shows the temperature.
+FONTS = {
+    "FreeMonoBold9pt7b": PRINTABLE,
+    "FreeMonoBold12pt7b": PRINTABLE,
+    "FreeMonoBold18pt7b": "0123456789.-C",
+}
+
+BITMAP_RE = re.compile(r"Bitmaps\[\]\s*(?:PROGMEM)?\s*=\s*\{(.*?)\};", re.S)
+GLYPHS_RE = re.compile(r"Glyphs\[\]\s*(?:PROGMEM)?\s*=\s*\{(.*?)\};", re.S)
+GLYPH_RE = re.compile(r"\{\s*(-?\w+)\s*,\s*(-?\w+)\s*,\s*(-?\w+)\s*,\s*(-?\w+)\s*,\s*(-?\w+)\s*,\s*(-?\w+)\s*\}")
+FONT_RE = re.compile(r"GFXfont\s+\w+\s*(?:PROGMEM)?\s*=\s*\{(.*?)\};", re.S)
+
+
+def parse_font(path):
+    text = re.sub(r"//[^\n]*", "", open(path).read())
+    bitmaps = [int(v, 0) for v in re.findall(r"0x[0-9A-Fa-f]+|\b\d+\b", BITMAP_RE.search(text).group(1))]
+    glyphs = [tuple(int(v, 0) for v in g) for g in GLYPH_RE.findall(GLYPHS_RE.search(text).group(1))]
+    fields = [f.strip() for f in FONT_RE.search(text).group(1).split(",")]
+    first = int(fields[2], 0)
+    return bitmaps, glyphs, first
+
+
+def bake_glyph(bitmaps, glyph):
+    """Glyph bits (row-major, MSB first, rows not byte-aligned) -> sprite rows."""
+    offset, w, h = glyph[0], glyph[1], glyph[2]
+    stride = (h + 7) // 8
+    rows = []
+    for col in range(w):
+        row = [0] * stride
+        for yy in range(h):
+            bit = yy * w + col
+            if bitmaps[offset + bit // 8] & (0x80 >> (bit % 8)):
+                k = h - 1 - yy                  # bottom row is bit 0
+                row[k // 8] |= 0x80 >> (k % 8)
+        rows.extend(row)
+    return stride, rows
+
+
+def generate(font_dir):
+    out = [
+        "// Generated by tools/gen_glyph_atlas.py from the Adafruit GFX fonts - do not edit",
+        "#pragma once",
+        "",
+        '#include "framebuffer.h"',
+    ]
+    for name, chars in FONTS.items():
+        bitmaps, glyphs, first_cp = parse_font(os.path.join(font_dir, name + ".h"))
+        codes = sorted({ord(c) for c in chars})
+        lo, hi = codes[0], codes[-1]
+
+        bits = []
+        entries = []
+        for cp in range(lo, hi + 1):
+            if cp not in codes:
+                entries.append("  { { 0, 0, 0, 0, 0, nullptr }, 0 },")
+                continue
+            g = glyphs[cp - first_cp]
+            _, w, h, x_adv, x_off, y_off = g
+            stride, rows = bake_glyph(bitmaps, g)
+            ptr = "ATLAS_BITS_%s + %d" % (name, len(bits)) if rows else "nullptr"
+            entries.append("  { { %d, %d, %d, %d, %d, %s }, %d },  // %r"
+                           % (x_off, y_off, w, h, stride, ptr, x_adv, chr(cp)))
+            bits.extend(rows)
+
+        out.append("")
+        out.append("static const uint8_t ATLAS_BITS_%s[] = {" % name)
+        for i in range(0, len(bits), 16):
+            out.append("  " + ", ".join("0x%02x" % b for b in bits[i:i + 16]) + ",")
+        out.append("};")
+        out.append("static const AtlasGlyph ATLAS_GLYPHS_%s[] = {" % name)
+        out.extend(entries)
+        out.append("};")
+        out.append("static const GlyphAtlas ATLAS_%s = { 0x%02x, 0x%02x, ATLAS_GLYPHS_%s };" % (name, lo, hi, name))
+    return "\n".join(out) + "\n"
+
+
+def write_if_changed(path, content):
+    os.makedirs(os.path.dirname(path) or ".", exist_ok=True)
+    if os.path.exists(path) and open(path).read() == content:
+        return False
+    with open(path, "w") as f:
+        f.write(content)
+    return True
+
+
+def find_font_dir(search_root):
+    probe = next(iter(FONTS)) + ".h"
+    hits = glob.glob(os.path.join(search_root, "**", "Fonts", probe), recursive=True)
+    return os.path.dirname(hits[0]) if hits else None
+
+
+def pio_main(env):
+    libdeps = os.path.join(env.subst("$PROJECT_LIBDEPS_DIR"), env.subst("$PIOENV"))
+    font_dir = find_font_dir(libdeps)
+    if not font_dir:
+        sys.stderr.write("gen_glyph_atlas: Adafruit GFX fonts not found under %s\n" % libdeps)
+        env.Exit(1)
+    out_dir = os.path.join(env.subst("$BUILD_DIR"), "generated")
+    if write_if_changed(os.path.join(out_dir, "glyph_atlas.h"), generate(font_dir)):
+        print("gen_glyph_atlas: glyph_atlas.h regenerated from " + font_dir)
+    env.Append(CPPPATH=[out_dir])
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        sys.exit("usage: gen_glyph_atlas.py FONT_DIR OUTPUT_H")
+    write_if_changed(sys.argv[2], generate(sys.argv[1]))
+else:
+    Import("env")  # noqa: F821 - provided by PlatformIO (SCons)
+    pio_main(env)  # noqa: F821
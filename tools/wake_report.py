@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+"""Aggregate wake-cycle traces captured from the serial console.
+
+The firmware prints one "#WT1 <hex>" line per wake (see include/wake_trace.h).
+Feed it any number of serial logs, e.g. from `pio device monitor | tee`:
+
+    tools/wake_report.py monitor-*.log
+    tools/wake_report.py --current wifi=95 --current panel=12 < monitor.log
+    tools/wake_report.py --profile wake_profile.txt monitor.log
+
+--profile also writes the p50s as phase times for the energy simulator
+(lib/energy_sim, tools/energy_sim.cpp --profile).
+
+Prints p50 / p95 / max milliseconds per phase, and an estimated charge per
+phase in milliamp-seconds. The board has no current sensor, so charge is
+ms x an assumed average current per phase (override with --current).
+
+"panel" is the time the CPU was awake for the panel (records without a
+panel_busy phase count it all); "panel_busy" the part of the refresh it
+light-slept through, waiting on the BUSY line. Waits blocked on the BUSY
+interrupt with the radio still on keep the CPU running and stay in
+"panel".
+"""
+
+import argparse
+import re
+import sys
+
+PHASES = [
+    "display_init",
+    "settings",
+    "wifi",
+    "time_sync",
+    "tls",
+    "http_wait",
+    "json",
+    "render",
+    "panel",
+    "sleep_entry",
+    "panel_busy",
+]
+
+# Rough averages for an ESP32-C6 module plus the 2.13" panel, in mA.
+# Radio phases are dominated by WiFi RX/TX, the rest by the CPU at 160 MHz.
+DEFAULT_CURRENT_MA = {
+    "display_init": 25,
+    "settings": 25,
+    "wifi": 90,
+    "time_sync": 80,
+    "tls": 85,
+    "http_wait": 80,
+    "json": 75,
+    "render": 25,
+    "panel": 30,
+    "sleep_entry": 40,
+    "panel_busy": 6,   # panel driving the ink, chip in light sleep
+}
+
+FLAGS = [
+    (0x01, "cold"),
+    (0x02, "no-wifi"),
+    (0x04, "full"),
+    (0x08, "partial"),
+    (0x10, "failed"),
+]
+
+# Simulator phase <- (trace phase, flag the wake must carry). A phase is
+# timed over the wakes that ran it, since the simulator charges it only
+# when it happens; the panel is split by refresh kind.
+PROFILE_PHASES = [
+    ("display_init", "display_init", None),
+    ("settings", "settings", None),
+    ("wifi", "wifi", None),
+    ("time_sync", "time_sync", None),
+    ("tls", "tls", None),
+    ("http_wait", "http_wait", None),     # per wake; the simulator charges it per request
+    ("json_weather", "json", None),       # weather and forecast parses are one trace phase
+    ("render", "render", None),
+    ("panel_partial", "panel", 0x08),
+    ("panel_full", "panel", 0x04),
+    ("sleep_entry", "sleep_entry", None),
+]
+
+LINE_RE = re.compile(r"#WT1 ([0-9a-fA-F]+)")
+
+
+def parse_record(hexdata):
+    try:
+        raw = bytes.fromhex(hexdata)
+    except ValueError:
+        return None
+    if len(raw) < 15 or (sum(raw[:-1]) & 0xFF) != raw[-1]:
+        return None
+    count = raw[13]
+    if len(raw) != 15 + 2 * count:
+        return None
+
+    u32 = lambda off: int.from_bytes(raw[off:off + 4], "little")
+    phases = [int.from_bytes(raw[14 + 2 * i:16 + 2 * i], "little") for i in range(count)]
+    return {
+        "session": u32(0),
+        "wake": u32(4),
+        "total": u32(8),
+        "flags": raw[12],
+        "phases": phases,
+    }
+
+
+def percentile(values, p):
+    if not values:
+        return 0
+    s = sorted(values)
+    k = (len(s) - 1) * p / 100.0
+    lo = int(k)
+    hi = min(lo + 1, len(s) - 1)
+    return s[lo] + (s[hi] - s[lo]) * (k - lo)
+
+
+def write_profile(path, recs):
+    with open(path, "w") as out:
+        out.write("# energy_sim phase times: p50 ms over %d wakes (tools/wake_report.py --profile)\n"
+                  % len(recs))
+        out.write("# phase p50_ms wakes\n")
+        written = 0
+        for sim_name, phase, flag in PROFILE_PHASES:
+            i = PHASES.index(phase)
+            values = [r["phases"][i] for r in recs
+                      if i < len(r["phases"]) and r["phases"][i] > 0
+                      and (flag is None or r["flags"] & flag)]
+            if values:
+                out.write("%-14s %6.0f %5d\n" % (sim_name, percentile(values, 50), len(values)))
+                written += 1
+    return written
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    ap.add_argument("logs", nargs="*", help="serial logs (default: stdin)")
+    ap.add_argument("--current", action="append", default=[], metavar="PHASE=MA",
+                    help="assumed average current of a phase in mA")
+    ap.add_argument("--only", choices=[name for _, name in FLAGS],
+                    help="only wakes carrying this flag")
+    ap.add_argument("--profile", metavar="FILE",
+                    help="also write p50 phase times for tools/energy_sim --profile")
+    args = ap.parse_args()
+
+    current = dict(DEFAULT_CURRENT_MA)
+    for item in args.current:
+        name, _, value = item.partition("=")
+        if name not in current:
+            ap.error("unknown phase '%s' (one of %s)" % (name, ", ".join(PHASES)))
+        current[name] = float(value)
+
+    records = {}
+    bad = 0
+    streams = [open(path, errors="replace") for path in args.logs] or [sys.stdin]
+    for stream in streams:
+        for line in stream:
+            m = LINE_RE.search(line)
+            if not m:
+                continue
+            rec = parse_record(m.group(1))
+            if rec is None:
+                bad += 1
+                continue
+            # The ring is re-dumped after gaps in the capture; keep one copy
+            records[(rec["session"], rec["wake"])] = rec
+
+    wanted = dict((name, bit) for bit, name in FLAGS)
+    recs = [r for r in records.values()
+            if not args.only or r["flags"] & wanted[args.only]]
+    if not recs:
+        print("no wake records found" + (" (%d corrupt lines)" % bad if bad else ""))
+        return 1
+
+    print("%d wakes, %d sessions%s" % (len(recs), len(set(r["session"] for r in recs)),
+                                       ", %d corrupt lines skipped" % bad if bad else ""))
+    for bit, name in FLAGS:
+        n = sum(1 for r in recs if r["flags"] & bit)
+        if n:
+            print("  %-8s %d" % (name, n))
+    print()
+
+    if args.profile:
+        n = write_profile(args.profile, recs)
+        print("%d phase times written to %s\n" % (n, args.profile))
+
+    header = "%-13s %8s %8s %8s %10s %9s" % ("phase", "p50 ms", "p95 ms", "max ms", "mean mAs", "share")
+    print(header)
+    print("-" * len(header))
+
+    # The firmware's panel phase includes the BUSY wait; split it
+    busy = PHASES.index("panel_busy")
+    for r in recs:
+        if busy < len(r["phases"]):
+            r["phases"][PHASES.index("panel")] -= r["phases"][busy]
+
+    charge_total = 0.0
+    rows = []
+    for i, name in enumerate(PHASES):
+        values = [r["phases"][i] for r in recs if i < len(r["phases"])]
+        mean_ms = sum(values) / len(values) if values else 0
+        mas = mean_ms / 1000.0 * current[name]
+        charge_total += mas
+        rows.append((name, values, mas))
+
+    for name, values, mas in rows:
+        share = 100.0 * mas / charge_total if charge_total else 0
+        print("%-13s %8.0f %8.0f %8d %10.2f %8.1f%%" % (
+            name, percentile(values, 50), percentile(values, 95),
+            max(values) if values else 0, mas, share))
+
+    totals = [r["total"] for r in recs]
+    print("-" * len(header))
+    print("%-13s %8.0f %8.0f %8d %10.2f" % ("wake total", percentile(totals, 50),
+                                            percentile(totals, 95), max(totals), charge_total))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())